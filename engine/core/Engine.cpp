@@ -13,7 +13,13 @@
 #include "pool/TexturePool.h"
 #include "pool/TextureDataPool.h"
 #include "pool/ShaderPool.h"
+#include "pool/PipelinePool.h"
 #include "pool/FontPool.h"
+#include "pool/BufferPool.h"
+#include "pool/ModelPool.h"
+#include "util/JobSystem.h"
+#include "util/AssetLoader.h"
+#include "util/Profiler.h"
 
 #include "sokol_time.h"
 
@@ -40,6 +46,10 @@ bool Engine::callMouseInTouchEvent = false;
 bool Engine::callTouchInMouseEvent = false;
 bool Engine::useDegrees = true;
 bool Engine::automaticTransparency = true;
+bool Engine::automaticInstancing = true;
+bool Engine::asyncLoading = false;
+std::string Engine::pipelineManifest = "";
+unsigned int Engine::maxRenderBuffers = 1024;
 bool Engine::allowEventsOutCanvas = false;
 bool Engine::ignoreEventsHandledByUI = true;
 bool Engine::fixedTimeSceneUpdate = true;
@@ -286,6 +296,40 @@ bool Engine::isAutomaticTransparency(){
     return automaticTransparency;
 }
 
+void Engine::setAutomaticInstancing(bool automaticInstancing){
+    Engine::automaticInstancing = automaticInstancing;
+}
+
+bool Engine::isAutomaticInstancing(){
+    return automaticInstancing;
+}
+
+void Engine::setAsyncLoading(bool asyncLoading){
+    Engine::asyncLoading = asyncLoading;
+}
+
+bool Engine::isAsyncLoading(){
+    return asyncLoading;
+}
+
+void Engine::setPipelineManifest(std::string pipelineManifest){
+    Engine::pipelineManifest = pipelineManifest;
+
+    PipelinePool::setRecording(!pipelineManifest.empty());
+}
+
+std::string Engine::getPipelineManifest(){
+    return pipelineManifest;
+}
+
+void Engine::setMaxRenderBuffers(unsigned int maxRenderBuffers){
+    Engine::maxRenderBuffers = maxRenderBuffers;
+}
+
+unsigned int Engine::getMaxRenderBuffers(){
+    return maxRenderBuffers;
+}
+
 void Engine::setAllowEventsOutCanvas(bool allowEventsOutCanvas){
     Engine::allowEventsOutCanvas = allowEventsOutCanvas;
 }
@@ -388,6 +432,8 @@ GraphicBackend Engine::getGraphicBackend(){
     return GraphicBackend::METAL;
 #elif defined(SOKOL_WGPU)
     return GraphicBackend::WGPU;
+#elif defined(SOKOL_DUMMY_BACKEND)
+    return GraphicBackend::DUMMY;
 #elif defined(SUPERNOVA_APPLE) //Xcode template
     return GraphicBackend::METAL;
 #endif
@@ -469,10 +515,14 @@ void Engine::systemInit(int argc, char* argv[]){
     drawSemaphore.release();
 
     stm_setup();
+    Profiler::setThreadName("Main");
     
     std::vector<std::string> args(argv, argv + argc);
     System::instance().args = args;
 
+    JobSystem::init();
+    AssetLoader::init();
+
     LuaBinding::createLuaState();
 
     #ifndef NO_LUA_INIT
@@ -486,6 +536,10 @@ void Engine::systemInit(int argc, char* argv[]){
 void Engine::systemViewLoaded(){
     SystemRender::setup();
 
+    if (!pipelineManifest.empty()){
+        PipelinePool::loadManifest(pipelineManifest);
+    }
+
     if (mouseCursorType != CursorType::ARROW){
         System::instance().setMouseCursor(mouseCursorType);
     }
@@ -563,13 +617,22 @@ void Engine::systemViewChanged(){
 
 void Engine::systemDraw(){
     //Deltatime in seconds
-    deltatime = stm_sec(stm_laptime(&lastTime));
+    systemDraw(stm_sec(stm_laptime(&lastTime)));
+}
+
+// used directly by platforms that control frame time (ex: headless benchmark)
+void Engine::systemDraw(double frameTime){
+    deltatime = frameTime;
     framerate = 1 / deltatime;
 
+    Profiler::beginFrame();
+
     drawSemaphore.acquire();
 
     SystemRender::executeQueue();
 
+    AssetLoader::update();
+
     // avoid increment updateTimeCount after resume
     if (!paused) {
         int updateLoops = 0;
@@ -578,7 +641,10 @@ void Engine::systemDraw(){
             updateLoops++;
             updateTimeCount -= updateTime;
 
-            Engine::onUpdate.call();
+            {
+                PROFILE_ZONE("Engine::onUpdate");
+                Engine::onUpdate.call();
+            }
 
             if (isFixedTimeSceneUpdate()) {
                 for (int i = 0; i < numScenes; i++) {
@@ -605,11 +671,16 @@ void Engine::systemDraw(){
         scenes[i]->draw();
     }
 
-    SystemRender::commit();
+    {
+        PROFILE_ZONE("SystemRender::commit");
+        SystemRender::commit();
+    }
 
     drawSemaphore.release();
 
     AudioSystem::checkActive();
+
+    Profiler::endFrame();
 }
 
 void Engine::systemViewDestroyed(){
@@ -623,12 +694,19 @@ void Engine::systemViewDestroyed(){
         scenes[i]->destroy();
     }
 
+    if (!pipelineManifest.empty()){
+        PipelinePool::saveManifest(pipelineManifest);
+    }
+    PipelinePool::clear();
+
     SystemRender::shutdown();
 
     TexturePool::clear();
     TextureDataPool::clear();
     ShaderPool::clear();
     FontPool::clear();
+    BufferPool::clear();
+    ModelPool::clear();
 
     drawSemaphore.release();
 }
@@ -639,6 +717,9 @@ void Engine::systemShutdown(){
     LuaBinding::cleanup();
 
     removeAllSceneLayers();
+
+    AssetLoader::shutdown();
+    JobSystem::shutdown();
 }
 
 void Engine::systemPause(){
@@ -21,6 +21,10 @@
 #define MAX_SHADOWSCUBEMAP 1
 #endif
 
+#ifndef MAX_SHADOWCUBEFACES_UPDATE
+#define MAX_SHADOWCUBEFACES_UPDATE 2
+#endif
+
 #ifndef MAX_SHADOWCASCADES
 #define MAX_SHADOWCASCADES 4
 #endif
@@ -49,8 +53,8 @@
 #define MAX_MORPHTARGETS 8
 #endif
 
-#ifndef MAX_EXTERNAL_BUFFERS
-#define MAX_EXTERNAL_BUFFERS 30
+#ifndef MIN_AUTO_INSTANCING_MESHES
+#define MIN_AUTO_INSTANCING_MESHES 4
 #endif
 
 #ifndef MAX_BROADPHASELAYER_3D
@@ -101,7 +105,8 @@ namespace Supernova {
         GLES3,
         D3D11,
         METAL,
-        WGPU
+        WGPU,
+        DUMMY
     };
 
     enum class BodyType{
@@ -134,6 +139,10 @@ namespace Supernova {
         static bool callTouchInMouseEvent;
         static bool useDegrees;
         static bool automaticTransparency;
+        static bool automaticInstancing;
+        static bool asyncLoading;
+        static std::string pipelineManifest;
+        static unsigned int maxRenderBuffers;
 
         static bool allowEventsOutCanvas;
 
@@ -207,6 +216,21 @@ namespace Supernova {
         static void setAutomaticTransparency(bool automaticTransparency);
         static bool isAutomaticTransparency();
 
+        static void setAutomaticInstancing(bool automaticInstancing);
+        static bool isAutomaticInstancing();
+
+        // textures and audio files are decoded by AssetLoader threads instead of blocking the frame
+        static void setAsyncLoading(bool asyncLoading);
+        static bool isAsyncLoading();
+
+        // file with pipeline variants used in previous runs, they are created before first frame (ex: "data://pipelines.txt")
+        static void setPipelineManifest(std::string pipelineManifest);
+        static std::string getPipelineManifest();
+
+        // size of GPU buffer pool, each mesh without shared buffers uses up to two (set before view is loaded)
+        static void setMaxRenderBuffers(unsigned int maxRenderBuffers);
+        static unsigned int getMaxRenderBuffers();
+
         static void setAllowEventsOutCanvas(bool allowEventsOutCanvas);
         static bool isAllowEventsOutCanvas();
 
@@ -247,6 +271,7 @@ namespace Supernova {
         static void systemViewLoaded();
         static void systemViewChanged();
         static void systemDraw();
+        static void systemDraw(double frameTime);
         static void systemViewDestroyed();
         static void systemShutdown();
 
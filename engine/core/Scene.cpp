@@ -16,22 +16,31 @@
 #include "subsystem/AudioSystem.h"
 #include "subsystem/PhysicsSystem.h"
 #include "util/Color.h"
+#include "util/Profiler.h"
+#include "util/JobSystem.h"
+#include "sokol_time.h"
 
 using namespace Supernova;
 
 Scene::Scene(){
+	// Transform array order is the hierarchy and siblings order, it cannot be rebuilt and keeps order on remove.
+	// Cameras and lights are ordered by creation (render to texture and light slots), arrays are small.
+	// Others use swap-and-pop removal, sortComponentsByTransform restores Transform order when needed.
 	registerComponent<MeshComponent>();
 	registerComponent<ModelComponent>();
 	registerComponent<BoneComponent>();
+	registerComponent<SkinningComponent>();
+	registerComponent<MorphTargetComponent>();
+	registerComponent<SkeletalAnimationComponent>();
 	registerComponent<SkyComponent>();
 	registerComponent<FogComponent>();
 	registerComponent<UIContainerComponent>();
 	registerComponent<UILayoutComponent>();
 	registerComponent<SpriteComponent>();
 	registerComponent<SpriteAnimationComponent>();
-    registerComponent<Transform>();
-	registerComponent<CameraComponent>();
-	registerComponent<LightComponent>();
+	registerComponent<Transform>(true);
+	registerComponent<CameraComponent>(true);
+	registerComponent<LightComponent>(true);
 	registerComponent<ActionComponent>();
 	registerComponent<TimedActionComponent>();
 	registerComponent<PositionActionComponent>();
@@ -78,12 +87,15 @@ Scene::Scene(){
 
 	backgroundColor = Vector4(0.0, 0.0, 0.0, 1.0); //sRGB
 	shadowsPCF = true;
+	shadowsCache = true;
 
 	hasSceneAmbientLight = false;
 	ambientLight = Vector3(1.0, 1.0, 1.0);
 	ambientFactor = 0.2;
 
 	enableUIEvents = true;
+
+	componentsRemoved = false;
 }
 
 Scene::~Scene(){
@@ -91,8 +103,12 @@ Scene::~Scene(){
 
 	std::vector<Entity> entityList = entityManager.getEntityList();
 	while(entityList.size() > 0){
-		destroyEntity(entityList.front());
-		// some entities can destroy other entities (ex: models)
+		for (Entity entity : entityList){
+			// some entities can destroy other entities (ex: models)
+			if (entityManager.isAlive(entity)){
+				destroyEntity(entity);
+			}
+		}
 		entityList = entityManager.getEntityList();
 	}
 
@@ -154,6 +170,14 @@ bool Scene::isShadowsPCF() const{
 	return this->shadowsPCF;
 }
 
+void Scene::setShadowsCache(bool shadowsCache){
+	this->shadowsCache = shadowsCache;
+}
+
+bool Scene::isShadowsCache() const{
+	return this->shadowsCache;
+}
+
 void Scene::setAmbientLight(float ambientFactor, Vector3 ambientLight){
 	this->ambientFactor = ambientFactor;
 	this->ambientLight = ambientLight;
@@ -205,6 +229,8 @@ void Scene::load(){
 	if (camera == NULL_ENTITY){
 		camera = createDefaultCamera();
 	}
+
+	applyHierarchyChanges();
 	
 	for (auto const &pair: systems) {
 		if (Engine::isViewLoaded()){
@@ -220,18 +246,85 @@ void Scene::destroy(){
 }
 
 void Scene::draw(){
+	PROFILE_ZONE("Scene::draw");
+
+	applyHierarchyChanges();
+
 	for (auto const& pair : systems){
+		PROFILE_ZONE(pair.second->getDrawZoneName());
+		uint64_t start = stm_now();
 		pair.second->draw();
+		pair.second->addDrawTime(stm_sec(stm_since(start)));
 	}
 }
 
 
 void Scene::update(double dt){
-	for (auto const& pair : systems){
-		pair.second->update(dt);
+	PROFILE_ZONE("Scene::update");
+
+	size_t first = 0;
+	while (first < systems.size()){
+		// systems can change hierarchy while updating (ex: UI objects)
+		applyHierarchyChanges();
+
+		if (!systems[first].second->isConcurrentUpdate()){
+			updateSystem(systems[first].second.get(), dt);
+			first++;
+			continue;
+		}
+
+		// sequence of concurrent systems, each one waits only for previous systems with conflicting access
+		size_t last = first + 1;
+		while (last < systems.size() && systems[last].second->isConcurrentUpdate()){
+			last++;
+		}
+
+		updateStages.resize(last - first);
+		size_t numStages = 0;
+		for (size_t i = first; i < last; i++){
+			size_t stage = 0;
+			for (size_t j = first; j < i; j++){
+				if (systems[i].second->hasUpdateConflict(*systems[j].second)){
+					stage = std::max(stage, updateStages[j - first] + 1);
+				}
+			}
+			updateStages[i - first] = stage;
+			numStages = std::max(numStages, stage + 1);
+		}
+
+		for (size_t stage = 0; stage < numStages; stage++){
+			if (stage > 0){
+				applyHierarchyChanges();
+			}
+
+			JobCounter counter;
+			SubSystem* mainSystem = nullptr;
+			for (size_t i = first; i < last; i++){
+				if (updateStages[i - first] != stage){
+					continue;
+				}
+				SubSystem* system = systems[i].second.get();
+				if (!mainSystem){
+					mainSystem = system;
+				}else{
+					JobSystem::execute(counter, [this, system, dt](){ updateSystem(system, dt); });
+				}
+			}
+			updateSystem(mainSystem, dt);
+			JobSystem::wait(counter);
+		}
+
+		first = last;
 	}
 }
 
+void Scene::updateSystem(SubSystem* system, double dt){
+	PROFILE_ZONE(system->getUpdateZoneName());
+	uint64_t start = stm_now();
+	system->update(dt);
+	system->addUpdateTime(stm_sec(stm_since(start)));
+}
+
 void Scene::updateSizeFromCamera(){
 	getSystem<RenderSystem>()->updateCameraSize(getCamera());
 }
@@ -241,21 +334,27 @@ Entity Scene::createEntity(){
 }
 
 void Scene::destroyEntity(Entity entity){
+	if (!entityManager.isAlive(entity)){
+		return;
+	}
 
 	for (auto const& pair : systems){
 		pair.second->entityDestroyed(entity);
 	}
 
 	componentManager.entityDestroyed(entity);
+	componentsRemoved = true;
 	
 	entityManager.destroy(entity);
 }
 
 int32_t Scene::findBranchLastIndex(Entity entity){
+	applyHierarchyChanges();
+
 	auto transforms = componentManager.getComponentArray<Transform>();
 
-	size_t index = transforms->getIndex(entity);
-	if (index < 0)
+	size_t index = transforms->findIndex(entity);
+	if (index == ComponentArray<Transform>::NULL_INDEX)
 		return -1;
 
 	size_t currentIndex = index + 1;
@@ -292,181 +391,211 @@ void Scene::addEntityChild(Entity parent, Entity child){
 
 	if ( ((parentSignature & signature) == signature) && ((childSignature & signature) == signature) ){
 		Transform& transformChild = componentManager.getComponent<Transform>(child);
-		Transform& transformParent = componentManager.getComponent<Transform>(parent);
-
-		auto transforms = componentManager.getComponentArray<Transform>();
 
 		if (transformChild.parent != parent) {
 			transformChild.parent = parent;
+			transformChild.needUpdate = true;
 
-			//----------DEBUG
-			//Log::debug("Add child - BEFORE");
-			//for (int i = 0; i < transforms->size(); i++){
-			//	auto transform = transforms->getComponentFromIndex(i);
-			//	Log::debug("Transform %i - Entity: %i - Parent: %i: %s", i, transforms->getEntity(i), transform.parent, transform.name.c_str());
-			//}
-			//----------DEBUG
-
-			//size_t parentIndex = transforms->getIndex(parent);
-			size_t childIndex = transforms->getIndex(child);
+			markTransformDirty(child);
 
-			//find children of parent and child family
-			size_t newIndex = findBranchLastIndex(parent) + 1;
-			size_t lastChild = findBranchLastIndex(child);
-
-			int length = lastChild - childIndex + 1;
+			hierarchyChanges.push_back({HierarchyChange::ADD_CHILD, child});
+		}
+	}
+}
 
-			if (newIndex > childIndex) {
-				newIndex = newIndex - length;
-			}
+void Scene::markTransformDirty(Entity entity){
+	dirtyTransforms.push_back(entity);
+}
 
-			if (childIndex != newIndex) {
-				if (length == 1) {
-					transforms->moveEntityToIndex(child, newIndex);
-				} else {
-					transforms->moveEntityRangeToIndex(child, transforms->getEntity(lastChild), newIndex);
-				}
-			}
+std::vector<Entity>& Scene::getDirtyTransforms(){
+	return dirtyTransforms;
+}
 
-			//----------DEBUG
-			//Log::debug("Add child - AFTER");
-			//for (int i = 0; i < transforms->size(); i++){
-			//	auto transform = transforms->getComponentFromIndex(i);
-			//	Log::debug("Transform %i - Entity: %i - Parent: %i: %s", i, transforms->getEntity(i), transform.parent, transform.name.c_str());
-			//}
-			//Log::debug("\n");
-			//----------DEBUG
+void Scene::applyHierarchyChanges(){
+	if (hierarchyChanges.empty()){
+		// swap-and-pop removals only move the last component, one sort for all of them
+		if (componentsRemoved){
+			sortComponentsByTransform();
 		}
+		return;
 	}
 
-	sortComponentsByTransform(childSignature);
-}
+	auto transforms = componentManager.getComponentArray<Transform>();
 
-void Scene::sortComponentsByTransform(Signature entitySignature){
-	// Mesh component
-	if (entitySignature.test(getComponentType<MeshComponent>())){
-		auto meshes = componentManager.getComponentArray<MeshComponent>();
-		meshes->sortByComponent<Transform>(componentManager.getComponentArray<Transform>());
-	}
+	const size_t none = ComponentArray<Transform>::NULL_INDEX;
+	const size_t size = transforms->size();
+	const size_t root = size; // virtual parent of top level entities
+
+	// sibling lists by dense index, built in current array order
+	std::vector<size_t> parentOf(size + 1, none);
+	std::vector<size_t> firstChild(size + 1, none);
+	std::vector<size_t> lastChild(size + 1, none);
+	std::vector<size_t> nextSibling(size + 1, none);
+	std::vector<size_t> prevSibling(size + 1, none);
+
+	auto unlink = [&](size_t node){
+		size_t parent = parentOf[node];
+		if (prevSibling[node] != none) nextSibling[prevSibling[node]] = nextSibling[node]; else firstChild[parent] = nextSibling[node];
+		if (nextSibling[node] != none) prevSibling[nextSibling[node]] = prevSibling[node]; else lastChild[parent] = prevSibling[node];
+		prevSibling[node] = none;
+		nextSibling[node] = none;
+	};
+
+	auto insertAfter = [&](size_t ref, size_t node){
+		size_t parent = parentOf[ref];
+		parentOf[node] = parent;
+		prevSibling[node] = ref;
+		nextSibling[node] = nextSibling[ref];
+		if (nextSibling[ref] != none) prevSibling[nextSibling[ref]] = node; else lastChild[parent] = node;
+		nextSibling[ref] = node;
+	};
+
+	auto insertBefore = [&](size_t ref, size_t node){
+		size_t parent = parentOf[ref];
+		parentOf[node] = parent;
+		nextSibling[node] = ref;
+		prevSibling[node] = prevSibling[ref];
+		if (prevSibling[ref] != none) nextSibling[prevSibling[ref]] = node; else firstChild[parent] = node;
+		prevSibling[ref] = node;
+	};
+
+	auto append = [&](size_t parent, size_t node){
+		if (lastChild[parent] != none){
+			insertAfter(lastChild[parent], node);
+		}else{
+			parentOf[node] = parent;
+			firstChild[parent] = node;
+			lastChild[parent] = node;
+		}
+	};
 
-	// InstancedMesh component
-	if (entitySignature.test(getComponentType<InstancedMeshComponent>())){
-		auto instmeshes = componentManager.getComponentArray<InstancedMeshComponent>();
-		instmeshes->sortByComponent<Transform>(componentManager.getComponentArray<Transform>());
+	for (size_t i = 0; i < size; i++){
+		Entity parent = transforms->getComponentFromIndex(i).parent;
+		size_t parentIndex = (parent != NULL_ENTITY) ? transforms->findIndex(parent) : none;
+		if (parentIndex == none || parentIndex == i){
+			parentIndex = root;
+		}
+		append(parentIndex, i);
 	}
 
-	// Model component
-	if (entitySignature.test(getComponentType<ModelComponent>())){
-		auto models = componentManager.getComponentArray<ModelComponent>();
-		models->sortByComponent<Transform>(componentManager.getComponentArray<Transform>());
+	for (auto const& change : hierarchyChanges){
+		size_t node = transforms->findIndex(change.second);
+		if (node == none)
+			continue; // entity destroyed after change
+
+		size_t parent = parentOf[node];
+
+		switch (change.first){
+			case HierarchyChange::ADD_CHILD:
+				unlink(node);
+				append(parent, node);
+				break;
+			case HierarchyChange::MOVE_TO_TOP:
+				if (lastChild[parent] != node){
+					unlink(node);
+					append(parent, node);
+				}
+				break;
+			case HierarchyChange::MOVE_UP:
+				if (nextSibling[node] != none){
+					size_t next = nextSibling[node];
+					unlink(node);
+					insertAfter(next, node);
+				}
+				break;
+			case HierarchyChange::MOVE_DOWN:
+				if (prevSibling[node] != none){
+					size_t prev = prevSibling[node];
+					unlink(node);
+					insertBefore(prev, node);
+				}
+				break;
+			case HierarchyChange::MOVE_TO_BOTTOM:
+				if (firstChild[parent] != node){
+					size_t first = firstChild[parent];
+					unlink(node);
+					insertBefore(first, node);
+				}
+				break;
+		}
 	}
 
-	// Bone component
-	if (entitySignature.test(getComponentType<BoneComponent>())){
-		auto bones = componentManager.getComponentArray<BoneComponent>();
-		bones->sortByComponent<Transform>(componentManager.getComponentArray<Transform>());
-	}
+	hierarchyChanges.clear();
 
-	// Polygon component
-	if (entitySignature.test(getComponentType<PolygonComponent>())){
-		auto polygons = componentManager.getComponentArray<PolygonComponent>();
-		polygons->sortByComponent<Transform>(componentManager.getComponentArray<Transform>());
-	}
+	// depth-first walk gives parent before children and keeps sibling order
+	std::vector<size_t> order;
+	order.reserve(size);
+	std::vector<bool> visited(size, false);
 
-	// UI layout component
-	if (entitySignature.test(getComponentType<UILayoutComponent>())){
-		auto layout = componentManager.getComponentArray<UILayoutComponent>();
-		layout->sortByComponent<Transform>(componentManager.getComponentArray<Transform>());
-	}
+	size_t node = firstChild[root];
+	while (node != none){
+		order.push_back(node);
+		visited[node] = true;
 
-	// UI component
-	if (entitySignature.test(getComponentType<UIComponent>())){
-		auto ui = componentManager.getComponentArray<UIComponent>();
-		ui->sortByComponent<Transform>(componentManager.getComponentArray<Transform>());
+		if (firstChild[node] != none){
+			node = firstChild[node];
+		}else{
+			while (node != root && nextSibling[node] == none){
+				node = parentOf[node];
+			}
+			node = (node == root) ? none : nextSibling[node];
+		}
 	}
 
-	// Points component
-	if (entitySignature.test(getComponentType<PointsComponent>())){
-		auto points = componentManager.getComponentArray<PointsComponent>();
-		points->sortByComponent<Transform>(componentManager.getComponentArray<Transform>());
+	// entities inside a parent cycle are not reachable from root
+	if (order.size() < size){
+		for (size_t i = 0; i < size; i++){
+			if (!visited[i]){
+				order.push_back(i);
+			}
+		}
 	}
 
-	// Lines component
-	if (entitySignature.test(getComponentType<PointsComponent>())){
-		auto points = componentManager.getComponentArray<PointsComponent>();
-		points->sortByComponent<Transform>(componentManager.getComponentArray<Transform>());
+	bool changed = false;
+	for (size_t i = 0; i < size; i++){
+		if (order[i] != i){
+			changed = true;
+			break;
+		}
 	}
 
-	// Audio component
-	if (entitySignature.test(getComponentType<AudioComponent>())){
-		auto audios = componentManager.getComponentArray<AudioComponent>();
-		audios->sortByComponent<Transform>(componentManager.getComponentArray<Transform>());
+	if (changed){
+		transforms->reorder(order);
+	}
+	if (changed || componentsRemoved){
+		sortComponentsByTransform();
 	}
 }
 
-void Scene::moveChildAux(Entity entity, bool increase, bool stopIfFound){
-	Signature entitySignature = entityManager.getSignature(entity);
-	
-	Signature signature;
-	signature.set(componentManager.getComponentType<Transform>(), true);
-
-	if ((entitySignature & signature) == signature){
-		auto transforms = componentManager.getComponentArray<Transform>();
-
-		size_t entityIndex = transforms->getIndex(entity);
-		//auto teste = transforms->getComponent(entity);
-		Entity entityParent = transforms->getComponent(entity).parent;
-
-		size_t nextIndex = entityIndex;
-		if (increase){
-			for (int i = (entityIndex+1); i < transforms->size(); i++){
-				Transform& next = transforms->getComponentFromIndex(i);
-				if (next.parent == entityParent){
-					nextIndex = i;
-					if (stopIfFound)
-						break;
-				}
-			}
-			nextIndex = findBranchLastIndex(transforms->getEntity(nextIndex));
-		}else{
-			for (int i = (entityIndex-1); i >= 0; i--){
-				Transform& next = transforms->getComponentFromIndex(i);
-				if (next.parent == entityParent){
-					nextIndex = i;
-					if (stopIfFound)
-						break;
-				}
-			}
-		}
-
-		if (nextIndex != entityIndex){
-			size_t lastChildIndex = findBranchLastIndex(entity);
-			size_t length = lastChildIndex - entityIndex + 1;
+void Scene::sortComponentsByTransform(){
+	auto transforms = componentManager.getComponentArray<Transform>();
 
-			if (length == 1){
-				transforms->moveEntityToIndex(entity, nextIndex);
-			}else{
-				nextIndex = nextIndex - length + 1;
-				transforms->moveEntityRangeToIndex(entity, transforms->getEntity(lastChildIndex), nextIndex);
-			}
-		}
-	}
+	componentManager.getComponentArray<MeshComponent>()->sortByComponent<Transform>(transforms);
+	componentManager.getComponentArray<InstancedMeshComponent>()->sortByComponent<Transform>(transforms);
+	componentManager.getComponentArray<ModelComponent>()->sortByComponent<Transform>(transforms);
+	componentManager.getComponentArray<BoneComponent>()->sortByComponent<Transform>(transforms);
+	componentManager.getComponentArray<PolygonComponent>()->sortByComponent<Transform>(transforms);
+	componentManager.getComponentArray<UILayoutComponent>()->sortByComponent<Transform>(transforms);
+	componentManager.getComponentArray<UIComponent>()->sortByComponent<Transform>(transforms);
+	componentManager.getComponentArray<PointsComponent>()->sortByComponent<Transform>(transforms);
+	componentManager.getComponentArray<LinesComponent>()->sortByComponent<Transform>(transforms);
+	componentManager.getComponentArray<AudioComponent>()->sortByComponent<Transform>(transforms);
 
-	sortComponentsByTransform(entitySignature);
+	componentsRemoved = false;
 }
 
 void Scene::moveChildToTop(Entity entity){
-	moveChildAux(entity, true, false);
+	hierarchyChanges.push_back({HierarchyChange::MOVE_TO_TOP, entity});
 }
 
 void Scene::moveChildUp(Entity entity){
-	moveChildAux(entity, true, true);
+	hierarchyChanges.push_back({HierarchyChange::MOVE_UP, entity});
 }
 
 void Scene::moveChildDown(Entity entity){
-	moveChildAux(entity, false, true);
+	hierarchyChanges.push_back({HierarchyChange::MOVE_DOWN, entity});
 }
 
 void Scene::moveChildToBottom(Entity entity){
-	moveChildAux(entity, false, false);
-}
\ No newline at end of file
+	hierarchyChanges.push_back({HierarchyChange::MOVE_TO_BOTTOM, entity});
+}
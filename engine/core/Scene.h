@@ -9,12 +9,18 @@
 #include "SubSystem.h"
 #include "EntityManager.h"
 #include "ComponentManager.h"
+#include "View.h"
+#include "util/Profiler.h"
 #include <vector>
 #include <unordered_map>
+#include <type_traits>
 
 #include "component/MeshComponent.h"
 #include "component/ModelComponent.h"
 #include "component/BoneComponent.h"
+#include "component/SkinningComponent.h"
+#include "component/MorphTargetComponent.h"
+#include "component/SkeletalAnimationComponent.h"
 #include "component/SkyComponent.h"
 #include "component/FogComponent.h"
 #include "component/ImageComponent.h"
@@ -64,11 +70,20 @@ namespace Supernova{
 	class Scene{
 	private:
 
+		enum class HierarchyChange{
+			ADD_CHILD,
+			MOVE_TO_TOP,
+			MOVE_UP,
+			MOVE_DOWN,
+			MOVE_TO_BOTTOM
+		};
+
 		Entity camera;
 		Entity defaultCamera;
 
 		Vector4 backgroundColor;
 		bool shadowsPCF;
+		bool shadowsCache;
 
 		bool hasSceneAmbientLight;
 		Vector3 ambientLight;
@@ -79,10 +94,15 @@ namespace Supernova{
 	    EntityManager entityManager;
 	    ComponentManager componentManager;
 		std::vector<std::pair<const char*, std::shared_ptr<SubSystem>>> systems;
+		std::vector<size_t> updateStages;
+
+		std::vector<std::pair<HierarchyChange, Entity>> hierarchyChanges;
+		std::vector<Entity> dirtyTransforms;
+		bool componentsRemoved;
 
 		Entity createDefaultCamera();
-		void sortComponentsByTransform(Signature entitySignature);
-		void moveChildAux(Entity entity, bool increase, bool stopIfFound);
+		void sortComponentsByTransform();
+		void updateSystem(SubSystem* system, double dt);
 		
 	public:
 	
@@ -108,6 +128,10 @@ namespace Supernova{
 		void setShadowsPCF(bool shadowsPCF);
 		bool isShadowsPCF() const;
 
+		// shadow maps are only redrawn when casters or lights change, casters without changes are cached
+		void setShadowsCache(bool shadowsCache);
+		bool isShadowsCache() const;
+
 		void setAmbientLight(float ambientFactor, Vector3 ambientLight);
 		void setAmbientLight(float ambientFactor);
 		void setAmbientLight(Vector3 ambientLight);
@@ -137,20 +161,32 @@ namespace Supernova{
 		void moveChildUp(Entity entity);
 		void moveChildDown(Entity entity);
 		void moveChildToBottom(Entity entity);
+
+		// hierarchy changes are queued and applied in one pass before systems update and draw
+		void applyHierarchyChanges();
+
+		// queues a transform for RenderSystem, call it after setting Transform needUpdate
+		// or needUpdateChildVisibility (only queued transforms are updated)
+		void markTransformDirty(Entity entity);
+		std::vector<Entity>& getDirtyTransforms();
 	
 	    // Component methods
 
 	    template<typename T>
-	    void registerComponent(){
-		    componentManager.registerComponent<T>();
+	    void registerComponent(bool ordered = false){
+		    componentManager.registerComponent<T>(ordered);
 	    }
 	
 	    template<typename T>
 	    void addComponent(Entity entity, T component){
-		    componentManager.addComponent<T>(entity, component);
+		    componentManager.addComponent<T>(entity, std::move(component));
 		    auto signature = entityManager.getSignature(entity);
 		    signature.set(componentManager.getComponentType<T>(), true);
 		    entityManager.setSignature(entity, signature);
+
+		    if constexpr (std::is_same<T, Transform>::value){
+			    markTransformDirty(entity);
+		    }
 	    }
 	
 	    template<typename T>
@@ -159,6 +195,8 @@ namespace Supernova{
 		    auto signature = entityManager.getSignature(entity);
 		    signature.set(componentManager.getComponentType<T>(), false);
 		    entityManager.setSignature(entity, signature); 
+
+		    componentsRemoved = true;
 	    }
 
 		Signature getSignature(Entity entity){
@@ -194,6 +232,12 @@ namespace Supernova{
 		std::shared_ptr<ComponentArray<T>> getComponentArray() {
 			return componentManager.getComponentArray<T>();
 		}
+
+		// entities with all components, iterated from the smallest array
+		template<typename... T>
+		View<T...> view() {
+			return View<T...>(componentManager.getComponentArray<T>()...);
+		}
 	
 		// System methods
 	
@@ -206,6 +250,8 @@ namespace Supernova{
 			assert(it == systems.end() && "Registering system more than once");
 	
 			auto system = std::make_shared<T>(this);
+			std::string zoneName = Profiler::getTypeName(typeName);
+			system->setZoneNames(Profiler::getName(zoneName + "::update"), Profiler::getName(zoneName + "::draw"));
 			systems.push_back(std::make_pair(typeName, system));
 			return system;
 		}
@@ -220,6 +266,11 @@ namespace Supernova{
 
 			return std::dynamic_pointer_cast<T>(it->second);
 		}
+
+		// pairs of system type name and system, in update order
+		const std::vector<std::pair<const char*, std::shared_ptr<SubSystem>>>& getSystems() const{
+			return systems;
+		}
 	};
 
 }
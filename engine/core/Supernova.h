@@ -40,6 +40,9 @@
 #include "component/Body2DComponent.h"
 #include "component/Body3DComponent.h"
 #include "component/BoneComponent.h"
+#include "component/SkinningComponent.h"
+#include "component/MorphTargetComponent.h"
+#include "component/SkeletalAnimationComponent.h"
 #include "component/ButtonComponent.h"
 #include "component/CameraComponent.h"
 #include "component/ColorActionComponent.h"
@@ -79,6 +82,7 @@
 #include "component/UILayoutComponent.h"
 
 #include "ecs/ComponentArray.h"
+#include "ecs/View.h"
 #include "ecs/ComponentManager.h"
 #include "ecs/Entity.h"
 #include "ecs/EntityManager.h"
@@ -31,11 +31,18 @@ using namespace Supernova;
 #ifdef  SUPERNOVA_APPLE
 #include "SupernovaApple.h"
 #endif
+#ifdef  SUPERNOVA_HEADLESS
+#include "SupernovaHeadless.h"
+#endif
 
 System& System::instance(){
 
     static System* instance = nullptr;
 
+    // created once, state like args must persist between calls
+    if (instance)
+        return *instance;
+
 #ifdef SUPERNOVA_ANDROID
     instance = new SupernovaAndroid();
 #endif
@@ -54,6 +61,9 @@ System& System::instance(){
 #ifdef  SUPERNOVA_APPLE
     instance = new SupernovaApple();
 #endif
+#ifdef  SUPERNOVA_HEADLESS
+    instance = new SupernovaHeadless();
+#endif
 
     return *instance;
 }
@@ -3,6 +3,7 @@
 //
 
 #include "ExternalBuffer.h"
+#include "pool/BufferPool.h"
 
 using namespace Supernova;
 
@@ -16,12 +17,18 @@ ExternalBuffer::~ExternalBuffer(){
 
 ExternalBuffer::ExternalBuffer(const ExternalBuffer& rhs): Buffer(rhs){
     name = rhs.name;
+    sharedId = rhs.sharedId;
+    sharedRenderId = rhs.sharedRenderId;
+    sharedRender = rhs.sharedRender;
 }
 
 ExternalBuffer& ExternalBuffer::operator=(const ExternalBuffer& rhs){
     Buffer::operator =(rhs);
 
     name = rhs.name;
+    sharedId = rhs.sharedId;
+    sharedRenderId = rhs.sharedRenderId;
+    sharedRender = rhs.sharedRender;
 
     return *this;
 }
@@ -37,4 +44,42 @@ void ExternalBuffer::setName(std::string name){
 
 std::string ExternalBuffer::getName() const{
     return this->name;
+}
+
+void ExternalBuffer::setSharedId(std::string sharedId){
+    this->sharedId = sharedId;
+}
+
+std::string ExternalBuffer::getSharedId() const{
+    return this->sharedId;
+}
+
+bool ExternalBuffer::createSharedRender(){
+    releaseSharedRender();
+
+    if (sharedId.empty() || usage != BufferUsage::IMMUTABLE || size == 0)
+        return false;
+
+    sharedRender = BufferPool::get(sharedId, type, size, data);
+    sharedRenderId = sharedId;
+    // render is a copy of GPU buffer handle, destroyed by BufferPool
+    render = *sharedRender;
+
+    return true;
+}
+
+bool ExternalBuffer::releaseSharedRender(){
+    if (!sharedRender)
+        return false;
+
+    sharedRender.reset();
+    BufferPool::remove(sharedRenderId);
+    sharedRenderId.clear();
+    render = BufferRender();
+
+    return true;
+}
+
+bool ExternalBuffer::hasSharedRender() const{
+    return (sharedRender != nullptr);
 }
\ No newline at end of file
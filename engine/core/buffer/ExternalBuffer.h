@@ -7,6 +7,7 @@
 
 #include "buffer/Buffer.h"
 #include <string>
+#include <memory>
 
 namespace Supernova {
 
@@ -15,6 +16,11 @@ namespace Supernova {
     protected:
         std::string name;
 
+        // immutable data with same id uses one GPU buffer from BufferPool
+        std::string sharedId;
+        std::string sharedRenderId;
+        std::shared_ptr<BufferRender> sharedRender;
+
     public:
         ExternalBuffer();
         virtual ~ExternalBuffer();
@@ -26,6 +32,13 @@ namespace Supernova {
 
         void setName(std::string name);
         std::string getName() const;
+
+        void setSharedId(std::string sharedId);
+        std::string getSharedId() const;
+
+        bool createSharedRender();
+        bool releaseSharedRender();
+        bool hasSharedRender() const;
     };
 
 }
@@ -6,6 +6,7 @@
 #define AUDIO_COMPONENT_H
 
 #include "Engine.h"
+#include "util/AssetLoader.h"
 
 namespace SoLoud{
     class Wav;
@@ -35,6 +36,11 @@ namespace Supernova{
         std::string filename;
         bool loaded = false;
 
+        // file decoded by AssetLoader when Engine::isAsyncLoading()
+        AssetLoadState loadState = AssetLoadState::NONE;
+        AssetTaskId loadTask = 0;
+        FunctionSubscribe<void(bool)> onLoad;
+
         bool enableClocked = false;
         bool enable3D = false;
         Vector3 lastPosition = Vector3(0, 0, 0);
@@ -27,6 +27,10 @@ namespace Supernova{
         Plane frustumPlanes[6];
         // for point light all cameras are same calculated value that is used by distanceToDepthValue in shader
         Vector2 nearFar = Vector2(0.0, 0.0);
+        // state of last drawn shadow map, it is drawn again only when changed
+        Matrix4 drawnViewProjectionMatrix;
+        uint64_t drawnStaticVersion = 0;
+        bool drawnDynamicCasters = false;
     };
 
     struct LightComponent{
@@ -51,6 +55,8 @@ namespace Supernova{
 
         LightCamera cameras[6];
         FramebufferRender framebuffer[MAX_SHADOWCASCADES];
+        FramebufferRender staticFramebuffer[MAX_SHADOWCASCADES]; // only casters without changes
+        unsigned int nextShadowFace = 0;
         int shadowMapIndex;
     };
     
@@ -30,9 +30,11 @@ namespace Supernova{
 
         ObjectRender render;
         std::shared_ptr<ShaderRender> shader;
-        std::string shaderProperties;
+        uint32_t shaderProperties = 0;
         int slotVSParams = -1;
 
+        bool transparent = false;
+
         bool needUpdateBuffer = false;
         bool needReload = false;
     };
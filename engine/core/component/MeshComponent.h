@@ -20,6 +20,7 @@
 #include "math/Rect.h"
 #include <map>
 #include <memory>
+#include <vector>
 
 namespace Supernova{
 
@@ -33,8 +34,8 @@ namespace Supernova{
         std::shared_ptr<ShaderRender> shader;
         std::shared_ptr<ShaderRender> depthShader;
 
-        std::string shaderProperties;
-        std::string depthShaderProperties;
+        uint32_t shaderProperties = 0;
+        uint32_t depthShaderProperties = 0;
 
         int slotVSParams = -1;
         int slotFSParams = -1;
@@ -73,26 +74,22 @@ namespace Supernova{
         bool needUpdateTexture = false;
     };
 
+    // Skinning and morph target state are in SkinningComponent and MorphTargetComponent.
+    // Submeshes and external buffers are heap allocated, so moving this component is cheap
     struct MeshComponent{
         bool loaded = false;
         bool loadCalled = false;
 
         InterleavedBuffer buffer;
         IndexBuffer indices;
-        ExternalBuffer eBuffers[MAX_EXTERNAL_BUFFERS];
+        std::vector<ExternalBuffer> eBuffers; // can be bigger than numExternalBuffers, keeps previous model buffers until reload
         unsigned int numExternalBuffers = 0;
 
         unsigned int vertexCount = 0;
 
-        Submesh submeshes[MAX_SUBMESHES];
+        std::vector<Submesh> submeshes = std::vector<Submesh>(1); // at least numSubmeshes, never shrinks
         unsigned int numSubmeshes = 0;
 
-        Matrix4 bonesMatrix[MAX_BONES];
-        float normAdjustJoint = 1;
-        float normAdjustWeight = 1;
-
-        float morphWeights[MAX_MORPHTARGETS];
-
         AABB aabb = AABB::ZERO;
         AABB verticesAABB = AABB::ZERO; // is not influenced by instances
         AABB worldAABB; // initially NULL
@@ -101,10 +98,13 @@ namespace Supernova{
         bool receiveShadows = true;
         bool transparent = false;
         bool enableShadowsBillboard = true;
+        uint64_t shadowChangedFrame = 0; // unchanged casters are drawn only in cached shadow maps
 
         CullingMode cullingMode = CullingMode::BACK;
         WindingOrder windingOrder = WindingOrder::CCW;
 
+        uint64_t instancingKey = 0; // same geometry and shaders, 0 if cannot be automatically instanced
+
         bool needUpdateBuffer = false;
         bool needReload = false;
     };
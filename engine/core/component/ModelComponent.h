@@ -5,24 +5,63 @@
 #ifndef MODEL_COMPONENT_H
 #define MODEL_COMPONENT_H
 
+#include "ecs/Entity.h"
 #include "buffer/ExternalBuffer.h"
+#include "util/AssetLoader.h"
+#include "util/FunctionSubscribe.h"
+#include "math/Vector3.h"
+#include "math/Quaternion.h"
+#include "math/Matrix4.h"
 #include <vector>
 #include <map>
+#include <memory>
 
 namespace tinygltf {class Model;}
 
 namespace Supernova{
 
+    struct OBJModel;
+
+    // joints in parent first order, shared by models of same file
+    struct SkeletonData{
+        std::vector<std::string> jointName;
+        std::vector<int> jointNode; // GLTF node
+        std::vector<int> jointParent; // -1 is child of model
+        std::vector<int> jointBone; // index in bonesMatrix, -1 if not skin joint
+        std::vector<Vector3> bindPosition;
+        std::vector<Quaternion> bindRotation;
+        std::vector<Vector3> bindScale;
+        std::vector<Matrix4> offsetMatrix; // inverse bind matrix
+    };
+
     struct ModelComponent{
-        tinygltf::Model* gltfModel = NULL;
+        // parsed file is shared with other entities by ModelPool
+        std::string filename;
+        std::shared_ptr<tinygltf::Model> gltfModel;
+        std::shared_ptr<OBJModel> objModel;
+
+        // file being parsed by AssetLoader (loadModelAsync)
+        AssetLoadState loadState = AssetLoadState::NONE;
+        std::string loadingFilename;
+        FunctionSubscribe<void(bool)> onLoad;
 
         Matrix4 inverseDerivedTransform;
         
-        Entity skeleton;
+        Entity skeleton = NULL_ENTITY;
 
         std::map<std::string, Entity> bonesNameMapping;
         std::map<int, Entity> bonesIdMapping;
 
+        // without bone entities, skinning is computed from joint arrays and
+        // entities are only created by getBone to attach objects, need to be set before loading
+        bool flatSkeleton = false;
+        std::shared_ptr<SkeletonData> skeletonData;
+        std::vector<Vector3> jointPosition;
+        std::vector<Quaternion> jointRotation;
+        std::vector<Vector3> jointScale;
+        std::vector<Matrix4> jointMatrix; // relative to model
+        std::vector<Entity> jointEntities; // NULL_ENTITY if bone entity was not created
+
         std::map<std::string, int> morphNameMapping;
 
         std::vector<Entity> animations;
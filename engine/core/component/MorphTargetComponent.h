@@ -0,0 +1,21 @@
+//
+// (c) 2024 Eduardo Doria.
+//
+
+#ifndef MORPHTARGET_COMPONENT_H
+#define MORPHTARGET_COMPONENT_H
+
+#include "Engine.h"
+
+namespace Supernova{
+
+    // added by MeshSystem to meshes with morph targets
+    struct MorphTargetComponent{
+        //-----u_vs_morphtarget
+        float morphWeights[MAX_MORPHTARGETS] = {};
+        //-----
+    };
+
+}
+
+#endif //MORPHTARGET_COMPONENT_H
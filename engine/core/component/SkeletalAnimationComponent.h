@@ -0,0 +1,85 @@
+//
+// (c) 2024 Eduardo Doria.
+//
+
+#ifndef SKELETALANIMATION_COMPONENT_H
+#define SKELETALANIMATION_COMPONENT_H
+
+#include "Engine.h"
+#include "math/Vector3.h"
+#include "math/Quaternion.h"
+#include <vector>
+#include <memory>
+#include <string>
+
+namespace Supernova{
+
+    enum class SkeletalTrackPath : uint8_t{
+        TRANSLATION,
+        ROTATION,
+        SCALE,
+        WEIGHTS
+    };
+
+    // all tracks of a clip, keys of all tracks are in same arrays
+    struct SkeletalClip{
+        std::string name;
+        float duration = 0;
+
+        std::vector<int> trackJoint; // joint of model skeleton, -1 for morph weights of model
+        std::vector<SkeletalTrackPath> trackPath;
+        std::vector<uint32_t> trackKeysOffset;
+        std::vector<uint32_t> trackKeysCount;
+        std::vector<uint32_t> trackValuesOffset;
+        std::vector<uint32_t> trackValuesSize; // floats by key
+
+        std::vector<float> times;
+        std::vector<float> values;
+    };
+
+    // shared by all models of same file
+    struct SkeletalAnimationData{
+        std::vector<SkeletalClip> clips;
+    };
+
+    struct SkeletalAnimationLayer{
+        int id = 0;
+        int clip = -1;
+        float time = 0;
+        float speed = 1;
+        float weight = 1;
+        float targetWeight = 1;
+        float fadeSpeed = 0; // weight by second, 0 is not fading
+        bool loop = true;
+        bool additive = false; // added to other layers as difference from bind pose
+        bool removeOnFadeOut = false;
+        std::vector<uint32_t> cursors; // key of each track in last sample
+    };
+
+    // added by MeshSystem to skinned models with animations
+    // clips are sampled and blended to joints of ModelComponent without bone entities, writing directly to SkinningComponent
+    struct SkeletalAnimationComponent{
+        std::shared_ptr<SkeletalAnimationData> data;
+
+        std::vector<SkeletalAnimationLayer> layers;
+        int nextLayerId = 1;
+
+        float poseWeights[MAX_MORPHTARGETS] = {};
+
+        // by layer before blending
+        std::vector<Vector3> layerPosition;
+        std::vector<Quaternion> layerRotation;
+        std::vector<Vector3> layerScale;
+        float layerWeights[MAX_MORPHTARGETS] = {};
+
+        // update rate by model height in screen: every frame if bigger than first, by 2 frames if bigger than second and by 4 frames if smaller
+        float lodScreenSizes[2] = {0.15f, 0.05f};
+        unsigned int updateInterval = 1;
+        float elapsedTime = 0;
+
+        bool updateBones = false; // also moves bone entities, necessary for objects attached to bones
+    };
+
+}
+
+#endif //SKELETALANIMATION_COMPONENT_H
@@ -0,0 +1,25 @@
+//
+// (c) 2024 Eduardo Doria.
+//
+
+#ifndef SKINNING_COMPONENT_H
+#define SKINNING_COMPONENT_H
+
+#include "Engine.h"
+#include "math/Matrix4.h"
+
+namespace Supernova{
+
+    // added by MeshSystem to meshes with skinning attributes
+    struct SkinningComponent{
+        //-----u_vs_skinning
+        Matrix4 bonesMatrix[MAX_BONES];
+        float normAdjustJoint = 1;
+        float normAdjustWeight = 1;
+        float _pad_normAdjust[2];
+        //-----
+    };
+
+}
+
+#endif //SKINNING_COMPONENT_H
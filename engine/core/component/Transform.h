@@ -42,7 +42,7 @@ namespace Supernova{
         bool cylindricalBillboard = false;
 
         bool needUpdateChildVisibility = false;
-        bool needUpdate = true;
+        bool needUpdate = true; // also call Scene::markTransformDirty when changed
     };
 
 }
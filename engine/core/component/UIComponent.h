@@ -26,7 +26,7 @@ namespace Supernova{
 
         ObjectRender render;
         std::shared_ptr<ShaderRender> shader;
-        std::string shaderProperties;
+        uint32_t shaderProperties = 0;
         int slotVSParams = -1;
         int slotFSParams = -1;
 
@@ -35,6 +35,7 @@ namespace Supernova{
 
         Texture texture;
         Vector4 color = Vector4(1.0, 1.0, 1.0, 1.0); //linear color
+        bool transparent = false;
 
         FunctionSubscribe<void()> onGetFocus;
         FunctionSubscribe<void()> onLostFocus;
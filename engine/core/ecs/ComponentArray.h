@@ -4,18 +4,21 @@
 
 #ifndef COMPONENTARRAY_H
 #define COMPONENTARRAY_H
-    
+
 #include <array>
 #include <cassert>
-#include <unordered_map>
 #include <vector>
 #include <algorithm>
 #include <functional>
 #include <stdexcept>
 #include <memory>
+#include <limits>
 #include "Entity.h"
 #include "Log.h"
 
+#define COMPONENTARRAY_PAGE_SHIFT 12
+#define COMPONENTARRAY_PAGE_SIZE (1 << COMPONENTARRAY_PAGE_SHIFT)
+
 namespace Supernova {
 
 	class ComponentArrayBase{
@@ -25,37 +28,92 @@ namespace Supernova {
 	};
 
 
+	// Sparse set: paged sparse index by entity pointing to dense entity and component vectors.
+	// Ordered arrays keep dense order on remove (used when order cannot be rebuilt),
+	// unordered arrays remove by swap-and-pop.
 	template<typename T>
 	class ComponentArray : public ComponentArrayBase{
 	private:
+		using SparsePage = std::array<size_t, COMPONENTARRAY_PAGE_SIZE>;
+
 		std::vector<T> componentArray{};
-		std::unordered_map<Entity, size_t> entityToIndexMap{};
-		std::unordered_map<size_t, Entity> indexToEntityMap{};
+		std::vector<Entity> denseEntities{};
+		std::vector<std::unique_ptr<SparsePage>> sparsePages{};
+
+		bool ordered;
+
+		size_t rawSparseIndex(Entity entity) const{
+			unsigned index = getEntityIndex(entity);
+			size_t page = index >> COMPONENTARRAY_PAGE_SHIFT;
+			if (page >= sparsePages.size() || !sparsePages[page]){
+				return NULL_INDEX;
+			}
+			return (*sparsePages[page])[index & (COMPONENTARRAY_PAGE_SIZE - 1)];
+		}
+
+		// also rejects handles of a destroyed entity whose index was recycled
+		size_t sparseIndex(Entity entity) const{
+			size_t dense = rawSparseIndex(entity);
+			if (dense == NULL_INDEX || denseEntities[dense] != entity){
+				return NULL_INDEX;
+			}
+			return dense;
+		}
+
+		void setSparseIndex(Entity entity, size_t index){
+			unsigned entityIndex = getEntityIndex(entity);
+			size_t page = entityIndex >> COMPONENTARRAY_PAGE_SHIFT;
+			if (page >= sparsePages.size()){
+				sparsePages.resize(page + 1);
+			}
+			if (!sparsePages[page]){
+				sparsePages[page] = std::make_unique<SparsePage>();
+				sparsePages[page]->fill(NULL_INDEX);
+			}
+			(*sparsePages[page])[entityIndex & (COMPONENTARRAY_PAGE_SIZE - 1)] = index;
+		}
+
+		void updateSparseRange(size_t first, size_t last){
+			for (size_t i = first; i < last; i++){
+				setSparseIndex(denseEntities[i], i);
+			}
+		}
 
 		void moveRange(size_t start, size_t length, size_t dst){
-    		typename std::vector<T>::iterator first, middle, last;
-    		if (start < dst){
-        		first  = componentArray.begin() + start;
-        		middle = first + length;
-        		last   = componentArray.begin() + dst + length;
-    		}else{
-        		first  = componentArray.begin() + dst;
-        		middle = componentArray.begin() + start;
-        		last   = middle + length;
-    		}
-    		std::rotate(first, middle, last);
+			size_t first, middle, last;
+			if (start < dst){
+				first  = start;
+				middle = first + length;
+				last   = dst + length;
+			}else{
+				first  = dst;
+				middle = start;
+				last   = middle + length;
+			}
+			std::rotate(componentArray.begin() + first, componentArray.begin() + middle, componentArray.begin() + last);
+			std::rotate(denseEntities.begin() + first, denseEntities.begin() + middle, denseEntities.begin() + last);
+
+			updateSparseRange(first, last);
 		}
 
 	public:
-		void insert(Entity entity, T component) {
-			if (entityToIndexMap.find(entity) == entityToIndexMap.end()){
+		static constexpr size_t NULL_INDEX = std::numeric_limits<size_t>::max();
+
+		ComponentArray(bool ordered = false){
+			this->ordered = ordered;
+		}
+
+		bool isOrdered() const{
+			return ordered;
+		}
 
-				size_t newIndex = componentArray.size();
+		void insert(Entity entity, T component) {
+			if (rawSparseIndex(entity) == NULL_INDEX){
 
-				entityToIndexMap[entity] = newIndex;
-				indexToEntityMap[newIndex] = entity;
+				setSparseIndex(entity, componentArray.size());
 
-				componentArray.push_back(component);
+				denseEntities.push_back(entity);
+				componentArray.push_back(std::move(component));
 
 			} else {
 				Log::error("Component added to same entity more than once");
@@ -63,23 +121,29 @@ namespace Supernova {
 		}
 
 		void remove(Entity entity) {
+			size_t indexOfRemovedEntity = sparseIndex(entity);
+
+			if (indexOfRemovedEntity != NULL_INDEX){
+
+				size_t lastIndex = componentArray.size() - 1;
+
+				if (ordered){
+					componentArray.erase(componentArray.begin() + indexOfRemovedEntity);
+					denseEntities.erase(denseEntities.begin() + indexOfRemovedEntity);
+
+					updateSparseRange(indexOfRemovedEntity, lastIndex);
+				}else{
+					if (indexOfRemovedEntity != lastIndex){
+						componentArray[indexOfRemovedEntity] = std::move(componentArray[lastIndex]);
+						denseEntities[indexOfRemovedEntity] = denseEntities[lastIndex];
 
-			if (entityToIndexMap.find(entity) != entityToIndexMap.end()){
-
-				// Remove component
-				size_t indexOfRemovedEntity = entityToIndexMap[entity];
-				componentArray.erase(componentArray. begin() + indexOfRemovedEntity);
-				size_t componentSize = componentArray.size();
-                
-                // Update maps
-                for (size_t i = indexOfRemovedEntity; i < componentSize; i++){
-                    Entity temp = indexToEntityMap[i+1];
-                    entityToIndexMap[temp] = i;
-                    indexToEntityMap[i] = temp;
-                }
-                
-                entityToIndexMap.erase(entity);
-                indexToEntityMap.erase(componentSize);
+						setSparseIndex(denseEntities[indexOfRemovedEntity], indexOfRemovedEntity);
+					}
+					componentArray.pop_back();
+					denseEntities.pop_back();
+				}
+
+				setSparseIndex(entity, NULL_INDEX);
 
 			} else {
 				Log::error("Removing non-existent component");
@@ -88,110 +152,111 @@ namespace Supernova {
 
 		void moveEntityRangeToIndex(Entity start, Entity end, size_t newIndex){
 
-			size_t startIndex = entityToIndexMap[start];
-			size_t endIndex = entityToIndexMap[end];
+			size_t startIndex = getIndex(start);
+			size_t endIndex = getIndex(end);
 			size_t length = endIndex - startIndex + 1;
-			size_t oldIndex = startIndex;
 
-			if (newIndex < 0 || (newIndex + length) > componentArray.size()){
+			if ((newIndex + length) > componentArray.size()){
 				Log::error("Cannot move entity range out of array");
 				return;
 			}
 
-			std::vector<Entity> tmp(length);
-			for (int i = 0; i < length; i++){
-				tmp[i] = indexToEntityMap[oldIndex+i];
-			}
-
-			if (oldIndex > newIndex){
-				for (size_t i = oldIndex+length-1; i > newIndex+length-1; i--){
-					Entity moved = indexToEntityMap[i-length];
-					entityToIndexMap[moved] = i;
-					indexToEntityMap[i] = moved;
-				}
-			}else{
-				for (size_t i = oldIndex; i < newIndex; i++){
-					Entity moved = indexToEntityMap[i+length];
-					entityToIndexMap[moved] = i;
-					indexToEntityMap[i] = moved;
-				}
-			}
-
-			for (int i = 0; i < tmp.size(); i++){
-				entityToIndexMap[tmp[i]] = newIndex+i;
-				indexToEntityMap[newIndex+i] = tmp[i];
-			}
-
-			moveRange(oldIndex, length, newIndex);
+			moveRange(startIndex, length, newIndex);
 		}
 
 		void moveEntityToIndex(Entity entity, size_t newIndex){
 
-			size_t oldIndex = entityToIndexMap[entity];
+			size_t oldIndex = getIndex(entity);
 
-			if (oldIndex > newIndex){
-				for (size_t i = oldIndex; i >= newIndex+1; i--){
-					Entity moved = indexToEntityMap[i-1];
-					entityToIndexMap[moved] = i;
-					indexToEntityMap[i] = moved;
-				}
-			}else{
-				for (size_t i = oldIndex; i <= newIndex-1; i++){
-					Entity moved = indexToEntityMap[i+1];
-					entityToIndexMap[moved] = i;
-					indexToEntityMap[i] = moved;
-				}
+			if (newIndex >= componentArray.size()){
+				Log::error("Cannot move entity out of array");
+				return;
 			}
 
-			entityToIndexMap[entity] = newIndex;
-			indexToEntityMap[newIndex] = entity;
-
 			moveRange(oldIndex, 1, newIndex);
 		}
 
+		// Stable sort of this array using the index of the same entity in another array.
+		// Entities missing in the other array go to the end.
 		template<typename C>
 		void sortByComponent(std::shared_ptr<ComponentArray<C>> otherComponent){
-			if (size() > 1){
-				for (int i = 1; i < size(); i++){
-					Entity entity1 = indexToEntityMap[i];
-					size_t indexC1 = otherComponent->getIndex(entity1);
-
-					for (int j = 0; j < i; j++){
-						Entity entity2 = indexToEntityMap[j];
-						size_t indexC2 = otherComponent->getIndex(entity2);
-
-						if (indexC1 < indexC2){
-							moveEntityToIndex(entity1, j);
-							break;
-						}
+			size_t count = size();
+			if (count > 1){
+				std::vector<size_t> keys(count);
+				bool sorted = true;
+				for (size_t i = 0; i < count; i++){
+					keys[i] = otherComponent->findIndex(denseEntities[i]);
+					if (i > 0 && keys[i] < keys[i-1]){
+						sorted = false;
+					}
+				}
+
+				if (!sorted){
+					std::vector<size_t> order(count);
+					for (size_t i = 0; i < count; i++){
+						order[i] = i;
 					}
+					std::stable_sort(order.begin(), order.end(), [&keys](size_t a, size_t b){ return keys[a] < keys[b]; });
+
+					reorder(order);
 				}
 			}
 		}
 
+		// Rearrange dense arrays so that new position i holds the element at old position order[i]
+		void reorder(const std::vector<size_t>& order){
+			if (order.size() != componentArray.size()){
+				Log::error("Cannot reorder component array with different size");
+				return;
+			}
+
+			std::vector<T> components;
+			std::vector<Entity> entities;
+			components.reserve(order.size());
+			entities.reserve(order.size());
+
+			for (size_t i = 0; i < order.size(); i++){
+				components.push_back(std::move(componentArray[order[i]]));
+				entities.push_back(denseEntities[order[i]]);
+			}
+
+			componentArray.swap(components);
+			denseEntities.swap(entities);
+
+			updateSparseRange(0, denseEntities.size());
+		}
+
+		bool hasEntity(Entity entity) const{
+			return sparseIndex(entity) != NULL_INDEX;
+		}
+
+		size_t findIndex(Entity entity) const{
+			return sparseIndex(entity);
+		}
+
 		T* findComponent(Entity entity) {
-			auto it = entityToIndexMap.find(entity);
+			size_t index = sparseIndex(entity);
 
-			if (it == entityToIndexMap.end()) {
+			if (index == NULL_INDEX) {
 				 return NULL;
 			}
 
-			return &componentArray[it->second];
+			return &componentArray[index];
 		}
 
 		T& getComponent(Entity entity) {
-			try{
-
-				return componentArray[entityToIndexMap.at(entity)];
+			size_t index = sparseIndex(entity);
 
-			}catch (const std::out_of_range& e){
-				Log::error("Retrieving non-existent component: %s", e.what());
-				throw;
+			if (index == NULL_INDEX) {
+				Log::error("Retrieving non-existent component: entity %u", entity);
+				throw std::out_of_range("ComponentArray::getComponent");
 			}
+
+			return componentArray[index];
 		}
 
 		T* findComponentFromIndex(size_t index) {
-			if (index < 0 || index >= componentArray.size()){
+			if (index >= componentArray.size()){
 				return NULL;
 			}
 
@@ -210,31 +275,35 @@ namespace Supernova {
 		}
 
 		size_t getIndex(Entity entity){
-			try{
-
-				return entityToIndexMap.at(entity);
+			size_t index = sparseIndex(entity);
 
-			}catch (const std::out_of_range& e){
-				Log::error("Retrieving non-existent component: %s", e.what());
-				throw;
+			if (index == NULL_INDEX) {
+				Log::error("Retrieving non-existent component: entity %u", entity);
+				throw std::out_of_range("ComponentArray::getIndex");
 			}
+
+			return index;
 		}
 
 		Entity getEntity(size_t index){
-			if (indexToEntityMap.find(index) == indexToEntityMap.end()){
+			if (index >= denseEntities.size()){
 				Log::error("Entity not found");
 				return NULL_ENTITY;
 			}
 
-			return indexToEntityMap[index];
+			return denseEntities[index];
 		}
 
 		size_t size(){
 			return componentArray.size();
 		}
 
+		const std::vector<Entity>& getEntities() const{
+			return denseEntities;
+		}
+
 		void entityDestroyed(Entity entity) override {
-			if (entityToIndexMap.find(entity) != entityToIndexMap.end()) {
+			if (sparseIndex(entity) != NULL_INDEX) {
 				remove(entity);
 			}
 		}
@@ -5,10 +5,11 @@
 #ifndef COMPONENTMANAGER_H
 #define COMPONENTMANAGER_H
 
-#include <any>
+#include <atomic>
 #include <memory>
-#include <unordered_map>
+#include <vector>
 #include "ComponentArray.h"
+#include "Signature.h"
 #include "Log.h"
 
 namespace Supernova {
@@ -18,21 +19,46 @@ namespace Supernova {
 
 	class ComponentManager {
 	private:
-		std::unordered_map<const char*, ComponentType> componentTypeIds{};
-		std::unordered_map<const char*, std::shared_ptr<ComponentArrayBase>> componentArrays{};
-		ComponentType nextComponentTypeId{};
+		// ids are assigned once per type for the whole process and index componentArrays
+		inline static std::atomic<ComponentType> nextComponentTypeId{0};
+
+		std::vector<std::shared_ptr<ComponentArrayBase>> componentArrays{};
+
+		template<typename T>
+		static ComponentType typeId() {
+			static const ComponentType id = nextComponentTypeId++;
+			return id;
+		}
+
+		template<typename T>
+		ComponentArray<T>* getArray() {
+			ComponentType id = typeId<T>();
+
+			if (id >= componentArrays.size() || !componentArrays[id]){
+				Log::error("Component not registered before use");
+				return nullptr;
+			}
+
+			return static_cast<ComponentArray<T>*>(componentArrays[id].get());
+		}
 
 	public:
 		template<typename T>
-		void registerComponent() {
-			const char* typeName = typeid(T).name();
+		void registerComponent(bool ordered = false) {
+			ComponentType id = typeId<T>();
 
-			if (componentTypeIds.find(typeName) == componentTypeIds.end()){
+			if (id >= Signature().size()){
+				Log::error("Component type id is bigger than signature size");
+				return;
+			}
 
-				componentTypeIds.insert({typeName, nextComponentTypeId});
-				componentArrays.insert({typeName, std::make_shared<ComponentArray<T>>()});
+			if (id >= componentArrays.size()){
+				componentArrays.resize(id + 1);
+			}
+
+			if (!componentArrays[id]){
 
-				++nextComponentTypeId;
+				componentArrays[id] = std::make_shared<ComponentArray<T>>(ordered);
 
 			} else {
 				Log::error("Registering component type more than once");
@@ -42,57 +68,61 @@ namespace Supernova {
 
 		template<typename T>
 		ComponentType getComponentType() {
-			const char* typeName = typeid(T).name();
+			ComponentType id = typeId<T>();
 
-			if (componentTypeIds.find(typeName) == componentTypeIds.end())
+			if (id >= componentArrays.size() || !componentArrays[id])
 				Log::error("Component not registered before use");
 
-			return componentTypeIds[typeName];
+			return id;
 		}
 
 		template<typename T>
 		std::shared_ptr<ComponentArray<T>> getComponentArray() {
-			const char* typeName = typeid(T).name();
+			ComponentType id = typeId<T>();
 
-			if (componentTypeIds.find(typeName) == componentTypeIds.end())
+			if (id >= componentArrays.size() || !componentArrays[id]){
 				Log::error("Component not registered before use");
+				return nullptr;
+			}
 
-			return std::static_pointer_cast<ComponentArray<T>>(componentArrays[typeName]);
+			return std::static_pointer_cast<ComponentArray<T>>(componentArrays[id]);
 		}
 
 		template<typename T>
 		void addComponent(Entity entity, T component) {
-			getComponentArray<T>()->insert(entity, component);
+			getArray<T>()->insert(entity, std::move(component));
 		}
 
 		template<typename T>
 		void removeComponent(Entity entity) {
-			getComponentArray<T>()->remove(entity);
+			getArray<T>()->remove(entity);
 		}
 
 		template<typename T>
 		T* findComponent(Entity entity) {
-			return getComponentArray<T>()->findComponent(entity);
+			return getArray<T>()->findComponent(entity);
 		}
 
 		template<typename T>
 		T& getComponent(Entity entity) {
-			return getComponentArray<T>()->getComponent(entity);
+			return getArray<T>()->getComponent(entity);
 		}
 
 		template<typename T>
 	    T* findComponentFromIndex(size_t index) {
-		    return getComponentArray<T>()->findComponentFromIndex(index);
+		    return getArray<T>()->findComponentFromIndex(index);
 	    }
 
 		template<typename T>
 	    T& getComponentFromIndex(size_t index) {
-		    return getComponentArray<T>()->getComponentFromIndex(index);
+		    return getArray<T>()->getComponentFromIndex(index);
 	    }
 
 		void entityDestroyed(Entity entity) {
-			for (auto const& pair : componentArrays) {
-				pair.second->entityDestroyed(entity);
+			for (auto const& array : componentArrays) {
+				if (array){
+					array->entityDestroyed(entity);
+				}
 			}
 		}
 	};
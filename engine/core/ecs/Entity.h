@@ -7,10 +7,23 @@
 
 #define NULL_ENTITY 0
 
+// low bits are the entity index, high bits are the generation of a recycled index
+#define ENTITY_INDEX_BITS 24
+#define ENTITY_INDEX_MASK ((1u << ENTITY_INDEX_BITS) - 1)
+#define ENTITY_GENERATION_MASK ((1u << (32 - ENTITY_INDEX_BITS)) - 1)
+
 namespace Supernova{
 
     using Entity = unsigned;
 
+    inline unsigned getEntityIndex(Entity entity){
+        return entity & ENTITY_INDEX_MASK;
+    }
+
+    inline unsigned getEntityGeneration(Entity entity){
+        return entity >> ENTITY_INDEX_BITS;
+    }
+
 }
 
-#endif //ENTITY_H
\ No newline at end of file
+#endif //ENTITY_H
@@ -5,58 +5,105 @@
 #ifndef ENTITYMANAGER_H
 #define ENTITYMANAGER_H
 
-#include <map>
+#include <deque>
 #include <vector>
 #include "Entity.h"
 #include "Signature.h"
 #include "Log.h"
 
+// destroyed indices are reused only after this many are waiting, so old handles stay invalid longer
+#define MIN_FREE_ENTITY_INDICES 1024
+
 namespace Supernova{
 
     class EntityManager {
     private:
-        unsigned lastEntity = 0;
-        std::map<Entity, Signature> signatures;
+        // indexed by entity index, index 0 is NULL_ENTITY
+        std::vector<Signature> signatures{Signature()};
+        std::vector<Entity> entities{NULL_ENTITY};
+        std::vector<bool> alive{false};
+        std::deque<unsigned> freeIndices;
+
+        bool isValid(Entity entity) const{
+            unsigned index = getEntityIndex(entity);
+            return (index < entities.size() && alive[index] && entities[index] == entity);
+        }
 
     public:
 
         Entity createEntity() {
-            lastEntity++;
-            signatures[lastEntity];
+            unsigned index;
+            unsigned generation = 0;
+
+            if (freeIndices.size() > MIN_FREE_ENTITY_INDICES){
+                index = freeIndices.front();
+                freeIndices.pop_front();
+
+                generation = (getEntityGeneration(entities[index]) + 1) & ENTITY_GENERATION_MASK;
+            }else{
+                index = entities.size();
+                if (index > ENTITY_INDEX_MASK){
+                    Log::error("Maximum number of entities reached");
+                    return NULL_ENTITY;
+                }
+
+                signatures.emplace_back();
+                entities.push_back(NULL_ENTITY);
+                alive.push_back(false);
+            }
 
-            return lastEntity;
+            Entity entity = (generation << ENTITY_INDEX_BITS) | index;
+
+            entities[index] = entity;
+            alive[index] = true;
+            signatures[index].reset();
+
+            return entity;
         }
 
         void destroy(Entity entity) {
-            signatures.erase(entity);
+            if (isValid(entity)){
+                unsigned index = getEntityIndex(entity);
+
+                alive[index] = false;
+                signatures[index].reset();
+                freeIndices.push_back(index);
+            }
+        }
+
+        bool isAlive(Entity entity) const{
+            return isValid(entity);
         }
 
         std::vector<Entity> getEntityList(){
             std::vector<Entity> list;
-            for (auto const& [key, val] : signatures){
-                list.push_back(key);
+            for (size_t i = 0; i < entities.size(); i++){
+                if (alive[i]){
+                    list.push_back(entities[i]);
+                }
             }
             return list;
         }
 
         void setSignature(Entity entity, Signature signature) {
-        	if (signatures.count(entity)==0){
+            if (!isValid(entity)){
                 Log::error("Entity does not exist to set signature");
+                return;
             }
 
-        	signatures[entity] = signature;
+            signatures[getEntityIndex(entity)] = signature;
         }
 
         Signature getSignature(Entity entity) const{
-        	if (signatures.count(entity)==0){
+            if (!isValid(entity)){
                  Log::error("Entity does not exist to get signature");
                  return Signature();
             }
 
-        	return signatures.at(entity);
+            return signatures[getEntityIndex(entity)];
         }
     };
 
 }
 
-#endif //ENTITYMANAGER_H
\ No newline at end of file
+#endif //ENTITYMANAGER_H
@@ -18,6 +18,22 @@ namespace Supernova{
 	protected:
 		Signature signature;
 		Scene* scene;
+
+		// cpu time in seconds spent in update and draw, accumulated by Scene until reset
+		double updateTime = 0;
+		double drawTime = 0;
+
+		// profiler zone names, set by Scene
+		const char* updateZoneName = "SubSystem::update";
+		const char* drawZoneName = "SubSystem::draw";
+
+		// components accessed in update, used by Scene to run concurrent systems together
+		Signature readComponents;
+		Signature writeComponents;
+		// Transform bit is for local values, world values are only written by RenderSystem
+		// so reading them does not conflict with systems writing local values
+		bool readWorldTransform = false;
+		bool writeWorldTransform = false;
 	
 	public:
 
@@ -25,6 +41,28 @@ namespace Supernova{
 			this->scene = scene;
 		}
 
+		double getUpdateTime() const { return updateTime; }
+		double getDrawTime() const { return drawTime; }
+		void addUpdateTime(double time) { updateTime += time; }
+		void addDrawTime(double time) { drawTime += time; }
+		void resetTimes() { updateTime = 0; drawTime = 0; }
+
+		const char* getUpdateZoneName() const { return updateZoneName; }
+		const char* getDrawZoneName() const { return drawZoneName; }
+		void setZoneNames(const char* update, const char* draw) { updateZoneName = update; drawZoneName = draw; }
+
+		// true if update can run in a worker thread, only accessing declared components
+		// (no scripts, entity creation or render calls)
+		virtual bool isConcurrentUpdate() { return false; }
+
+		bool hasUpdateConflict(const SubSystem& other) const {
+			if ((writeComponents & (other.readComponents | other.writeComponents)).any())
+				return true;
+			if ((other.writeComponents & readComponents).any())
+				return true;
+			return (writeWorldTransform && (other.readWorldTransform || other.writeWorldTransform)) || (other.writeWorldTransform && readWorldTransform);
+		}
+
 		virtual void load() = 0;
 
 		virtual void draw() = 0;
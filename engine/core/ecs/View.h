@@ -0,0 +1,119 @@
+//
+// (c) 2024 Eduardo Doria.
+//
+
+#ifndef VIEW_H
+#define VIEW_H
+
+#include <tuple>
+#include <memory>
+#include <vector>
+#include <utility>
+#include "Entity.h"
+#include "ComponentArray.h"
+
+namespace Supernova {
+
+	// Iterates entities that have all Components, driven by the smallest component array.
+	// Arrays sorted by Transform keep their relative order when driving the iteration.
+	template<typename... Components>
+	class View{
+	private:
+		std::tuple<std::shared_ptr<ComponentArray<Components>>...> arrays;
+		const std::vector<Entity>* driver;
+
+		template<size_t... I>
+		void findDriver(std::index_sequence<I...>){
+			driver = nullptr;
+			((driver = (!driver || std::get<I>(arrays)->getEntities().size() < driver->size()) ? &std::get<I>(arrays)->getEntities() : driver), ...);
+		}
+
+		template<size_t... I>
+		bool hasAll(Entity entity, std::index_sequence<I...>) const{
+			return (std::get<I>(arrays)->hasEntity(entity) && ...);
+		}
+
+		template<typename Func, size_t... I>
+		void callIfAll(Func& func, Entity entity, std::index_sequence<I...>){
+			std::tuple<Components*...> components{std::get<I>(arrays)->findComponent(entity)...};
+
+			if ((std::get<I>(components) && ...)){
+				func(entity, *std::get<I>(components)...);
+			}
+		}
+
+	public:
+
+		class Iterator{
+		private:
+			const View* view;
+			size_t index;
+
+			void skipInvalid(){
+				while (index < view->driver->size() && !view->contains((*view->driver)[index])){
+					index++;
+				}
+			}
+
+		public:
+			Iterator(const View* view, size_t index): view(view), index(index){
+				skipInvalid();
+			}
+
+			Entity operator*() const{
+				return (*view->driver)[index];
+			}
+
+			Iterator& operator++(){
+				index++;
+				skipInvalid();
+				return *this;
+			}
+
+			bool operator!=(const Iterator& other) const{
+				return index != other.index;
+			}
+
+			bool operator==(const Iterator& other) const{
+				return index == other.index;
+			}
+		};
+
+		View(std::shared_ptr<ComponentArray<Components>>... arrays): arrays(arrays...){
+			findDriver(std::index_sequence_for<Components...>{});
+		}
+
+		bool contains(Entity entity) const{
+			return hasAll(entity, std::index_sequence_for<Components...>{});
+		}
+
+		template<typename T>
+		T& get(Entity entity){
+			return std::get<std::shared_ptr<ComponentArray<T>>>(arrays)->getComponent(entity);
+		}
+
+		// upper bound of entities visited (size of smallest array)
+		size_t sizeHint() const{
+			return driver->size();
+		}
+
+		Iterator begin() const{
+			return Iterator(this, 0);
+		}
+
+		Iterator end() const{
+			return Iterator(this, driver->size());
+		}
+
+		// func(Entity, Components&...)
+		template<typename Func>
+		void each(Func func){
+			for (size_t i = 0; i < driver->size(); i++){
+				callIfAll(func, (*driver)[i], std::index_sequence_for<Components...>{});
+			}
+		}
+	};
+
+}
+
+#endif //VIEW_H
@@ -12,9 +12,15 @@
 
 #include <string.h>
 
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+#define DATA_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 using namespace Supernova;
 
-Data::Data(): dataPtr(NULL), dataLength(0), offset(0), dataOwned(false) {
+Data::Data(): dataPtr(NULL), dataLength(0), offset(0), dataOwned(false), dataMapped(false) {
 
 }
 
@@ -29,16 +35,23 @@ Data::Data(const char *aFilename): Data(){
 Data::Data(const Data& d){
     this->dataLength = d.dataLength;
     this->offset = d.offset;
-    this->dataOwned = d.dataOwned;
+    this->dataOwned = true;
+    this->dataMapped = false;
 
     this->dataPtr = new unsigned char[this->dataLength];
     memcpy(this->dataPtr, d.dataPtr, this->dataLength);
 }
 
 Data& Data::operator = (const Data& d){
+    if (this == &d)
+        return *this;
+
+    release();
+
     this->dataLength = d.dataLength;
     this->offset = d.offset;
-    this->dataOwned = d.dataOwned;
+    this->dataOwned = true;
+    this->dataMapped = false;
 
     this->dataPtr = new unsigned char[this->dataLength];
     memcpy(this->dataPtr, d.dataPtr, this->dataLength);
@@ -47,8 +60,49 @@ Data& Data::operator = (const Data& d){
 }
 
 Data::~Data() {
+    release();
+}
+
+void Data::release(){
+#ifdef DATA_MMAP
+    if (dataMapped)
+        munmap(dataPtr, dataLength);
+#endif
     if (dataOwned)
         delete[] dataPtr;
+
+    dataPtr = NULL;
+    dataOwned = false;
+    dataMapped = false;
+}
+
+bool Data::map(File *aFile){
+#ifdef DATA_MMAP
+    if (dataLength < DATA_MAP_MIN_SIZE)
+        return false;
+
+    // platform streams without descriptor (ex: Android assets) are read to memory
+    int fd = fileno(aFile->getFilePtr());
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+        return false;
+
+    void* ptr = mmap(NULL, dataLength, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (ptr == MAP_FAILED)
+        return false;
+
+    // mapping is kept after file is closed
+    dataPtr = (unsigned char*)ptr;
+    dataOwned = false;
+    dataMapped = true;
+
+    return true;
+#else
+    return false;
+#endif
 }
 
 unsigned int Data::read(unsigned char *aDst, unsigned int aBytes) {
@@ -94,13 +148,15 @@ unsigned char * Data::getMemPtr() {
     return dataPtr;
 }
 
+bool Data::isMapped() const{
+    return dataMapped;
+}
+
 unsigned int Data::open(unsigned char *aData, unsigned int aDataLength, bool aCopy, bool aTakeOwnership) {
     if (aData == NULL || aDataLength == 0)
         return FileErrors::INVALID_PARAMETER;
 
-    if (dataOwned)
-        delete[] dataPtr;
-    dataPtr = 0;
+    release();
     offset = 0;
 
     dataLength = aDataLength;
@@ -123,7 +179,8 @@ unsigned int Data::open(unsigned char *aData, unsigned int aDataLength, bool aCo
 unsigned int Data::open(const char *aFilename) {
     if (!aFilename)
         return FileErrors::INVALID_PARAMETER;
-    dataPtr = 0;
+
+    release();
     offset = 0;
 
     File df;
@@ -131,22 +188,17 @@ unsigned int Data::open(const char *aFilename) {
     if (res != 0)
         return res;
 
-    dataLength = df.length();
-    dataPtr = new unsigned char[dataLength];
-    if (dataPtr == NULL)
-        return FileErrors::OUT_OF_MEMORY;
-    df.read(dataPtr, dataLength);
-    dataOwned = true;
-    return FileErrors::FILEDATA_OK;
+    return open(&df);
 }
 
 unsigned int Data::open(File *aFile) {
-    if (dataOwned)
-        delete[] dataPtr;
-    dataPtr = 0;
+    release();
     offset = 0;
 
     dataLength = aFile->length();
+    if (map(aFile))
+        return FileErrors::FILEDATA_OK;
+
     dataPtr = new unsigned char[dataLength];
     if (dataPtr == NULL)
         return FileErrors::OUT_OF_MEMORY;
@@ -14,6 +14,9 @@
 #include "FileData.h"
 #include "File.h"
 
+// smaller files are read to memory, larger ones are memory mapped when possible
+#define DATA_MAP_MIN_SIZE 65536
+
 namespace Supernova {
 
     class Data: public FileData {
@@ -23,6 +26,10 @@ namespace Supernova {
         unsigned int dataLength;
         unsigned int offset;
         bool dataOwned;
+        bool dataMapped;
+
+        bool map(File *aFile);
+        void release();
 
     public:
         Data();
@@ -41,6 +48,7 @@ namespace Supernova {
         virtual void seek(int aOffset);
         virtual unsigned int pos();
         virtual unsigned char * getMemPtr();
+        bool isMapped() const;
 
         unsigned int open(unsigned char *aData, unsigned int aDataLength, bool aCopy=false, bool aTakeOwnership=true);
         unsigned int open(const char *aFilename);
@@ -9,6 +9,14 @@
 #include "math/Quaternion.h"
 #include "math/AABB.h"
 
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+    #define MATRIX4_SSE
+    #include <xmmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #define MATRIX4_NEON
+    #include <arm_neon.h>
+#endif
+
 using namespace Supernova;
 
 Matrix4::Matrix4(){
@@ -55,6 +63,34 @@ Matrix4& Matrix4::operator=(const Matrix4 &m){
 Matrix4 Matrix4::operator *(const Matrix4 &m) const{
     Matrix4 prod;
 
+    // each result column is a linear combination of this matrix columns
+#if defined(MATRIX4_SSE)
+    __m128 c0 = _mm_loadu_ps(matrix[0]);
+    __m128 c1 = _mm_loadu_ps(matrix[1]);
+    __m128 c2 = _mm_loadu_ps(matrix[2]);
+    __m128 c3 = _mm_loadu_ps(matrix[3]);
+
+    for (int c=0;c<4;c++){
+        __m128 col = _mm_mul_ps(c0, _mm_set1_ps(m.matrix[c][0]));
+        col = _mm_add_ps(col, _mm_mul_ps(c1, _mm_set1_ps(m.matrix[c][1])));
+        col = _mm_add_ps(col, _mm_mul_ps(c2, _mm_set1_ps(m.matrix[c][2])));
+        col = _mm_add_ps(col, _mm_mul_ps(c3, _mm_set1_ps(m.matrix[c][3])));
+        _mm_storeu_ps(prod.matrix[c], col);
+    }
+#elif defined(MATRIX4_NEON)
+    float32x4_t c0 = vld1q_f32(matrix[0]);
+    float32x4_t c1 = vld1q_f32(matrix[1]);
+    float32x4_t c2 = vld1q_f32(matrix[2]);
+    float32x4_t c3 = vld1q_f32(matrix[3]);
+
+    for (int c=0;c<4;c++){
+        float32x4_t col = vmulq_n_f32(c0, m.matrix[c][0]);
+        col = vmlaq_n_f32(col, c1, m.matrix[c][1]);
+        col = vmlaq_n_f32(col, c2, m.matrix[c][2]);
+        col = vmlaq_n_f32(col, c3, m.matrix[c][3]);
+        vst1q_f32(prod.matrix[c], col);
+    }
+#else
     for (int c=0;c<4;c++)
         for (int r=0;r<4;r++)
             prod.set(c,r,
@@ -62,6 +98,7 @@ Matrix4 Matrix4::operator *(const Matrix4 &m) const{
                 m.get(c,1)*get(1,r) +
                 m.get(c,2)*get(2,r) +
                 m.get(c,3)*get(3,r));
+#endif
 
     return prod;
 }
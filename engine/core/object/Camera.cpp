@@ -327,6 +327,7 @@ void Camera::rotatePosition(float angle){
         transf.position = Vector3(positionCenter.x + camera.view.x, positionCenter.y + camera.view.y, positionCenter.z + camera.view.z);
 
         transf.needUpdate = true;
+        scene->markTransformDirty(entity);
         camera.needUpdate = true;
     }
 }
@@ -362,6 +363,7 @@ void Camera::elevatePosition(float angle){
         transf.position = Vector3(positionCenter.x + camera.view.x, positionCenter.y + camera.view.y, positionCenter.z + camera.view.z);
 
         transf.needUpdate = true;
+        scene->markTransformDirty(entity);
         camera.needUpdate = true;
     }
 }
@@ -379,6 +381,7 @@ void Camera::moveForward(float distance){
         transf.position = transf.position + (viewCenter * distance);
 
         transf.needUpdate = true;
+        scene->markTransformDirty(entity);
         camera.needUpdate = true;
     }
 }
@@ -400,6 +403,7 @@ void Camera::walkForward(float distance){
         transf.position = transf.position + (walkVector * distance);
 
         transf.needUpdate = true;
+        scene->markTransformDirty(entity);
         camera.needUpdate = true;
     }
 }
@@ -419,6 +423,7 @@ void Camera::slide(float distance){
         transf.position = transf.position + (slideVector * distance);
 
         transf.needUpdate = true;
+        scene->markTransformDirty(entity);
         camera.needUpdate = true;
     }
 }
@@ -435,6 +440,7 @@ void Camera::zoom(float distance){
         transf.position = transf.position + (viewCenter * distance);
 
         transf.needUpdate = true;
+        scene->markTransformDirty(entity);
     }
 }
 
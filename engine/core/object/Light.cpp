@@ -37,6 +37,7 @@ void Light::setDirection(Vector3 direction){
 
     lightcomp.direction = direction;
     transform.needUpdate = true; //Does not affect children
+    scene->markTransformDirty(entity);
 }
 
 void Light::setDirection(const float x, const float y, const float z){
@@ -81,8 +82,10 @@ void Light::setIntensity(float intensity){
     LightComponent& lightcomp = getComponent<LightComponent>();
     Transform& transform = getComponent<Transform>();
 
-    if (intensity > 0 && lightcomp.intensity == 0)
+    if (intensity > 0 && lightcomp.intensity == 0){
         transform.needUpdate = true; //Does not affect children
+        scene->markTransformDirty(entity);
+    }
 
     lightcomp.intensity = intensity;
 }
@@ -10,6 +10,14 @@
 
 using namespace Supernova;
 
+// submeshes are allocated on demand by setters, can be set before model is loaded
+static Submesh& getSubmesh(MeshComponent& mesh, unsigned int submesh){
+    if (submesh >= mesh.submeshes.size()){
+        mesh.submeshes.resize(submesh + 1);
+    }
+    return mesh.submeshes[submesh];
+}
+
 Mesh::Mesh(Scene* scene): Object(scene){
     addComponent<MeshComponent>({});
 }
@@ -83,8 +91,8 @@ PrimitiveType Mesh::getPrimitiveType() const{
 void Mesh::setPrimitiveType(unsigned int submesh, PrimitiveType primitiveType){
     MeshComponent& mesh = getComponent<MeshComponent>();
 
-    if (mesh.submeshes[submesh].primitiveType != primitiveType){
-        mesh.submeshes[submesh].primitiveType = primitiveType;
+    if (getSubmesh(mesh, submesh).primitiveType != primitiveType){
+        getSubmesh(mesh, submesh).primitiveType = primitiveType;
 
         mesh.needReload = true;
     }
@@ -93,6 +101,11 @@ void Mesh::setPrimitiveType(unsigned int submesh, PrimitiveType primitiveType){
 PrimitiveType Mesh::getPrimitiveType(unsigned int submesh) const{
     MeshComponent& mesh = getComponent<MeshComponent>();
 
+    if (submesh >= mesh.submeshes.size()){
+        Log::error("Submesh %u does not exist in this mesh", submesh);
+        return PrimitiveType::TRIANGLES;
+    }
+
     return mesh.submeshes[submesh].primitiveType;
 }
 
@@ -107,8 +120,8 @@ bool Mesh::isEnableFaceCulling() const{
 void Mesh::setEnableFaceCulling(unsigned int submesh, bool enableFaceCulling){
     MeshComponent& mesh = getComponent<MeshComponent>();
 
-    if (mesh.submeshes[submesh].enableFaceCulling != enableFaceCulling){
-        mesh.submeshes[submesh].enableFaceCulling = enableFaceCulling;
+    if (getSubmesh(mesh, submesh).enableFaceCulling != enableFaceCulling){
+        getSubmesh(mesh, submesh).enableFaceCulling = enableFaceCulling;
 
         mesh.needReload = true;
     }
@@ -117,6 +130,11 @@ void Mesh::setEnableFaceCulling(unsigned int submesh, bool enableFaceCulling){
 bool Mesh::isEnableFaceCulling(unsigned int submesh) const{
     MeshComponent& mesh = getComponent<MeshComponent>();
 
+    if (submesh >= mesh.submeshes.size()){
+        Log::error("Submesh %u does not exist in this mesh", submesh);
+        return true;
+    }
+
     return mesh.submeshes[submesh].enableFaceCulling;
 }
 
@@ -132,7 +150,7 @@ bool Mesh::isCastShadowsWithTexture() const{
 void Mesh::setCastShadowsWithTexture(unsigned int submesh, bool castShadowsWithTexture){
     MeshComponent& mesh = getComponent<MeshComponent>();
 
-    mesh.submeshes[submesh].hasDepthTexture = castShadowsWithTexture;
+    getSubmesh(mesh, submesh).hasDepthTexture = castShadowsWithTexture;
 
     mesh.needReload = true;
 }
@@ -140,6 +158,11 @@ void Mesh::setCastShadowsWithTexture(unsigned int submesh, bool castShadowsWithT
 bool Mesh::isCastShadowsWithTexture(unsigned int submesh) const{
     MeshComponent& mesh = getComponent<MeshComponent>();
 
+    if (submesh >= mesh.submeshes.size()){
+        Log::error("Submesh %u does not exist in this mesh", submesh);
+        return false;
+    }
+
     return mesh.submeshes[submesh].hasDepthTexture;
 }
 
@@ -203,7 +226,8 @@ unsigned int Mesh::getNumSubmeshes() const{
 Material& Mesh::getMaterial(unsigned int submesh){
     MeshComponent& mesh = getComponent<MeshComponent>();
 
-    return mesh.submeshes[submesh].material;
+    // returned reference is used to set material, so it can allocate like setters
+    return getSubmesh(mesh, submesh).material;
 }
 
 void Mesh::setCastShadows(bool castShadows){
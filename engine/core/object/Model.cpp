@@ -12,10 +12,12 @@
 #include "subsystem/MeshSystem.h"
 #include "component/ActionComponent.h"
 #include "component/AnimationComponent.h"
+#include "component/SkeletalAnimationComponent.h"
 
 #include <algorithm>
 #include <sstream>
 #include <cfloat>
+#include <cmath>
 
 using namespace Supernova;
 
@@ -66,6 +68,14 @@ bool Model::loadGLTF(std::string filename){
     return ret;
 }
 
+bool Model::loadModelAsync(std::string filename){
+    return scene->getSystem<MeshSystem>()->loadModelAsync(entity, filename);
+}
+
+AssetLoadState Model::getLoadState() const{
+    return getComponent<ModelComponent>().loadState;
+}
+
 Animation Model::getAnimation(int index){
     ModelComponent& model = getComponent<ModelComponent>();
 
@@ -94,9 +104,31 @@ Animation Model::findAnimation(std::string name){
     throw std::out_of_range("vector animations is out of range");
 }
 
+void Model::setFlatSkeleton(bool flatSkeleton){
+    ModelComponent& model = getComponent<ModelComponent>();
+
+    if (model.skeletonData && model.flatSkeleton != flatSkeleton){
+        Log::warn("Flat skeleton is used only in next model loading");
+    }
+
+    model.flatSkeleton = flatSkeleton;
+}
+
+bool Model::isFlatSkeleton() const{
+    return getComponent<ModelComponent>().flatSkeleton;
+}
+
 Bone Model::getBone(std::string name){
     ModelComponent& model = getComponent<ModelComponent>();
 
+    if (model.flatSkeleton && model.skeletonData && !model.bonesNameMapping.count(name)){
+        const std::vector<std::string>& names = model.skeletonData->jointName;
+        auto it = std::find(names.begin(), names.end(), name);
+        if (it != names.end()){
+            scene->getSystem<MeshSystem>()->createJointEntity(entity, model, (int)(it - names.begin()));
+        }
+    }
+
     try{
         return Bone(scene, model.bonesNameMapping.at(name));
     }catch (const std::out_of_range& e){
@@ -108,6 +140,14 @@ Bone Model::getBone(std::string name){
 Bone Model::getBone(int id){
     ModelComponent& model = getComponent<ModelComponent>();
 
+    if (model.flatSkeleton && model.skeletonData && !model.bonesIdMapping.count(id)){
+        const std::vector<int>& nodes = model.skeletonData->jointNode;
+        auto it = std::find(nodes.begin(), nodes.end(), id);
+        if (it != nodes.end()){
+            scene->getSystem<MeshSystem>()->createJointEntity(entity, model, (int)(it - nodes.begin()));
+        }
+    }
+
     try{
         return Bone(scene, model.bonesIdMapping.at(id));
     }catch (const std::out_of_range& e){
@@ -129,10 +169,10 @@ float Model::getMorphWeight(std::string name){
 }
 
 float Model::getMorphWeight(int id){
-    MeshComponent& mesh = getComponent<MeshComponent>();
+    MorphTargetComponent* morphtarget = scene->findComponent<MorphTargetComponent>(entity);
 
-    if (id >= 0 && id < MAX_MORPHTARGETS){
-        return mesh.morphWeights[id];
+    if (morphtarget && id >= 0 && id < MAX_MORPHTARGETS){
+        return morphtarget->morphWeights[id];
     }else{
         Log::error("Retrieving non-existent morph weight '%i'", id);
     }
@@ -151,11 +191,193 @@ void Model::setMorphWeight(std::string name, float value){
 }
 
 void Model::setMorphWeight(int id, float value){
-    MeshComponent& mesh = getComponent<MeshComponent>();
+    MorphTargetComponent* morphtarget = scene->findComponent<MorphTargetComponent>(entity);
 
-    if (id >= 0 && id < MAX_MORPHTARGETS){
-        mesh.morphWeights[id] = value;
+    if (morphtarget && id >= 0 && id < MAX_MORPHTARGETS){
+        morphtarget->morphWeights[id] = value;
     }else{
         Log::error("Retrieving non-existent morph weight '%i'", id);
     }
-}
\ No newline at end of file
+}
+
+int Model::getClipIndex(std::string name){
+    SkeletalAnimationComponent* skeletal = scene->findComponent<SkeletalAnimationComponent>(entity);
+
+    if (skeletal && skeletal->data){
+        for (size_t i = 0; i < skeletal->data->clips.size(); i++){
+            if (skeletal->data->clips[i].name == name){
+                return (int)i;
+            }
+        }
+    }
+
+    return -1;
+}
+
+int Model::playClip(int clip){
+    return playClip(clip, 0);
+}
+
+int Model::playClip(int clip, float fadeTime){
+    SkeletalAnimationComponent* skeletal = scene->findComponent<SkeletalAnimationComponent>(entity);
+
+    if (!skeletal || !skeletal->data || clip < 0 || clip >= skeletal->data->clips.size()){
+        Log::error("Retrieving non-existent clip '%i'", clip);
+        return -1;
+    }
+
+    // crossfade from clips played before
+    for (SkeletalAnimationLayer& layer : skeletal->layers){
+        if (layer.removeOnFadeOut && !layer.additive){
+            layer.targetWeight = 0;
+            layer.fadeSpeed = (fadeTime > 0) ? (layer.weight / fadeTime) : 0;
+            if (fadeTime <= 0)
+                layer.weight = 0;
+        }
+    }
+
+    SkeletalAnimationLayer layer;
+    layer.id = skeletal->nextLayerId++;
+    layer.clip = clip;
+    layer.weight = (fadeTime > 0) ? 0 : 1;
+    layer.targetWeight = 1;
+    layer.fadeSpeed = (fadeTime > 0) ? (1 / fadeTime) : 0;
+    layer.removeOnFadeOut = true;
+
+    skeletal->layers.push_back(layer);
+
+    return layer.id;
+}
+
+int Model::playClip(std::string name){
+    return playClip(name, 0);
+}
+
+int Model::playClip(std::string name, float fadeTime){
+    int clip = getClipIndex(name);
+
+    if (clip < 0){
+        Log::error("Retrieving non-existent clip '%s'", name.c_str());
+        return -1;
+    }
+
+    return playClip(clip, fadeTime);
+}
+
+int Model::addClipLayer(int clip, float weight, bool additive){
+    SkeletalAnimationComponent* skeletal = scene->findComponent<SkeletalAnimationComponent>(entity);
+
+    if (!skeletal || !skeletal->data || clip < 0 || clip >= skeletal->data->clips.size()){
+        Log::error("Retrieving non-existent clip '%i'", clip);
+        return -1;
+    }
+
+    SkeletalAnimationLayer layer;
+    layer.id = skeletal->nextLayerId++;
+    layer.clip = clip;
+    layer.weight = weight;
+    layer.targetWeight = weight;
+    layer.additive = additive;
+
+    skeletal->layers.push_back(layer);
+
+    return layer.id;
+}
+
+int Model::addClipLayer(std::string name, float weight, bool additive){
+    int clip = getClipIndex(name);
+
+    if (clip < 0){
+        Log::error("Retrieving non-existent clip '%s'", name.c_str());
+        return -1;
+    }
+
+    return addClipLayer(clip, weight, additive);
+}
+
+void Model::setClipLayerWeight(int layer, float weight, float fadeTime){
+    SkeletalAnimationComponent* skeletal = scene->findComponent<SkeletalAnimationComponent>(entity);
+
+    if (skeletal){
+        for (SkeletalAnimationLayer& l : skeletal->layers){
+            if (l.id == layer){
+                l.targetWeight = weight;
+                if (fadeTime > 0){
+                    l.fadeSpeed = fabs(weight - l.weight) / fadeTime;
+                }else{
+                    l.weight = weight;
+                    l.fadeSpeed = 0;
+                }
+                return;
+            }
+        }
+    }
+
+    Log::error("Retrieving non-existent clip layer '%i'", layer);
+}
+
+void Model::setClipLayerSpeed(int layer, float speed){
+    SkeletalAnimationComponent* skeletal = scene->findComponent<SkeletalAnimationComponent>(entity);
+
+    if (skeletal){
+        for (SkeletalAnimationLayer& l : skeletal->layers){
+            if (l.id == layer){
+                l.speed = speed;
+                return;
+            }
+        }
+    }
+
+    Log::error("Retrieving non-existent clip layer '%i'", layer);
+}
+
+void Model::setClipLayerLoop(int layer, bool loop){
+    SkeletalAnimationComponent* skeletal = scene->findComponent<SkeletalAnimationComponent>(entity);
+
+    if (skeletal){
+        for (SkeletalAnimationLayer& l : skeletal->layers){
+            if (l.id == layer){
+                l.loop = loop;
+                return;
+            }
+        }
+    }
+
+    Log::error("Retrieving non-existent clip layer '%i'", layer);
+}
+
+void Model::stopClips(){
+    stopClips(0);
+}
+
+void Model::stopClips(float fadeTime){
+    SkeletalAnimationComponent* skeletal = scene->findComponent<SkeletalAnimationComponent>(entity);
+
+    if (skeletal){
+        // faded to bind pose
+        for (SkeletalAnimationLayer& layer : skeletal->layers){
+            layer.targetWeight = 0;
+            layer.fadeSpeed = (fadeTime > 0) ? (layer.weight / fadeTime) : 0;
+            if (fadeTime <= 0)
+                layer.weight = 0;
+            layer.removeOnFadeOut = true;
+        }
+    }
+}
+
+void Model::setClipsLOD(float fullRateScreenSize, float halfRateScreenSize){
+    SkeletalAnimationComponent* skeletal = scene->findComponent<SkeletalAnimationComponent>(entity);
+
+    if (skeletal){
+        skeletal->lodScreenSizes[0] = fullRateScreenSize;
+        skeletal->lodScreenSizes[1] = halfRateScreenSize;
+    }
+}
+
+void Model::setClipsUpdateBones(bool updateBones){
+    SkeletalAnimationComponent* skeletal = scene->findComponent<SkeletalAnimationComponent>(entity);
+
+    if (skeletal){
+        skeletal->updateBones = updateBones;
+    }
+}
@@ -8,6 +8,7 @@
 #include "Mesh.h"
 #include "Bone.h"
 #include "action/Animation.h"
+#include "util/AssetLoader.h"
 
 namespace tinygltf {class Model;}
 
@@ -22,9 +23,17 @@ namespace Supernova{
         bool loadOBJ(std::string filename);
         bool loadGLTF(std::string filename);
 
+        // model is created in a later frame, when onLoad is called
+        bool loadModelAsync(std::string filename);
+        AssetLoadState getLoadState() const;
+
         Animation getAnimation(int index);
         Animation findAnimation(std::string name);
 
+        // bones are not entities with flat skeleton, they are created here only to attach objects
+        void setFlatSkeleton(bool flatSkeleton);
+        bool isFlatSkeleton() const;
+
         Bone getBone(std::string name);
         Bone getBone(int id);
 
@@ -32,6 +41,24 @@ namespace Supernova{
         float getMorphWeight(int id);
         void setMorphWeight(std::string name, float value);
         void setMorphWeight(int id, float value);
+
+        // skeletal clips are sampled and blended without bone entities, returned ids are of clip layers
+        int getClipIndex(std::string name);
+        int playClip(int clip);
+        int playClip(int clip, float fadeTime);
+        int playClip(std::string name);
+        int playClip(std::string name, float fadeTime);
+        int addClipLayer(int clip, float weight, bool additive);
+        int addClipLayer(std::string name, float weight, bool additive);
+        void setClipLayerWeight(int layer, float weight, float fadeTime);
+        void setClipLayerSpeed(int layer, float speed);
+        void setClipLayerLoop(int layer, bool loop);
+        void stopClips();
+        void stopClips(float fadeTime);
+        // model height in screen to update every frame and by 2 frames, smaller is updated by 4 frames
+        void setClipsLOD(float fullRateScreenSize, float halfRateScreenSize);
+        // moves bone entities too, for objects attached to bones
+        void setClipsUpdateBones(bool updateBones);
     };
 }
 
@@ -36,6 +36,8 @@ void Object::setPosition(Vector3 position){
         transform.position = position;
 
         transform.needUpdate = true;
+
+        scene->markTransformDirty(entity);
     }
 }
 
@@ -64,6 +66,8 @@ void Object::setRotation(Quaternion rotation){
         transform.rotation = rotation;
 
         transform.needUpdate = true;
+
+        scene->markTransformDirty(entity);
     }
 }
 
@@ -92,6 +96,8 @@ void Object::setScale(Vector3 scale){
         transform.scale = scale;
 
         transform.needUpdate = true;
+
+        scene->markTransformDirty(entity);
     }
 }
 
@@ -109,6 +115,8 @@ void Object::setVisible(bool visible){
     Transform& transform = getComponent<Transform>();
     transform.visible = visible;
     transform.needUpdateChildVisibility = true;
+
+    scene->markTransformDirty(entity);
 }
 
 bool Object::isVisible() const{
@@ -169,6 +177,9 @@ void Object::setLocalMatrix(Matrix4 localMatrix){
     Transform& transform = getComponent<Transform>();
     transform.localMatrix = localMatrix;
     transform.staticObject = true;
+    transform.needUpdate = true;
+
+    scene->markTransformDirty(entity);
 }
 
 Matrix4 Object::getLocalMatrix() const{
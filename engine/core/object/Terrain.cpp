@@ -90,6 +90,7 @@ void Terrain::setSize(float size){
 
         terrain.needUpdateTerrain = true;
         transform.needUpdate = true;
+        scene->markTransformDirty(entity);
     }
 }
 
@@ -125,6 +126,7 @@ void Terrain::setResolution(int resolution){
         terrain.needUpdateTerrain = true;
         mesh.needReload = true;
         transform.needUpdate = true;
+        scene->markTransformDirty(entity);
     }
 }
 
@@ -169,6 +171,7 @@ void Terrain::setRootGridSize(int rootGridSize){
         terrain.needUpdateTerrain = true;
         mesh.needReload = true;
         transform.needUpdate = true;
+        scene->markTransformDirty(entity);
     }
 }
 
@@ -189,6 +192,7 @@ void Terrain::setLevels(int levels){
         terrain.needUpdateTerrain = true;
         mesh.needReload = true;
         transform.needUpdate = true;
+        scene->markTransformDirty(entity);
     }
 }
 
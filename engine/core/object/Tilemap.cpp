@@ -94,6 +94,9 @@ void Tilemap::addRect(int id, std::string name, std::string texture, TextureFilt
 
         if (!textureFound) {
             submeshId = mesh.numSubmeshes;
+            if (mesh.submeshes.size() <= mesh.numSubmeshes){
+                mesh.submeshes.resize(mesh.numSubmeshes + 1);
+            }
             mesh.submeshes[submeshId].material.baseColorTexture.setPath(texture);
             mesh.submeshes[submeshId].material.baseColorTexture.setMinFilter(texFilter);
             mesh.submeshes[submeshId].material.baseColorTexture.setMagFilter(texFilter);
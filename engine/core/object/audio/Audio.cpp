@@ -20,8 +20,12 @@ int Audio::loadAudio(std::string filename){
     AudioComponent& audio = getComponent<AudioComponent>();
 
     audio.filename = filename;
+    if (audio.loadState != AssetLoadState::LOADING)
+        audio.loadState = AssetLoadState::NONE;
 
-    if (Engine::isViewLoaded())
+    if (Engine::isAsyncLoading())
+        return scene->getSystem<AudioSystem>()->loadAudioAsync(audio, entity);
+    else if (Engine::isViewLoaded())
         return scene->getSystem<AudioSystem>()->loadAudio(audio, entity);
     else
         return false;
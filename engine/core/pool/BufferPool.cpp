@@ -0,0 +1,65 @@
+//
+// (c) 2024 Eduardo Doria.
+//
+
+#include "BufferPool.h"
+
+#include "Engine.h"
+#include "Log.h"
+
+using namespace Supernova;
+
+buffers_t& BufferPool::getMap(){
+    //To prevent similar problem of static init fiasco but on deinitialization
+    //https://isocpp.org/wiki/faq/ctors#static-init-order-on-first-use
+    static buffers_t* map = new buffers_t();
+    return *map;
+};
+
+std::shared_ptr<BufferRender> BufferPool::get(std::string id){
+	auto& shared = getMap()[id];
+
+	if (shared.use_count() > 0){
+		return shared;
+	}
+
+	return NULL;
+}
+
+std::shared_ptr<BufferRender> BufferPool::get(std::string id, BufferType type, size_t size, void* data){
+	auto& shared = getMap()[id];
+
+	if (shared.use_count() > 0){
+		return shared;
+	}
+
+	const auto resource =  std::make_shared<BufferRender>();
+
+	resource->createBuffer(size, data, type, BufferUsage::IMMUTABLE);
+
+	shared = resource;
+
+	return resource;
+}
+
+void BufferPool::remove(std::string id){
+	if (getMap().count(id)){
+		auto& shared = getMap()[id];
+		if (shared.use_count() <= 1){
+			shared->destroyBuffer();
+			getMap().erase(id);
+		}
+	}else{
+		if (Engine::isViewLoaded()){
+			Log::debug("Trying to destroy a non existent buffer: %s", id.c_str());
+		}
+	}
+}
+
+void BufferPool::clear(){
+	for (auto& it: getMap()) {
+		if (it.second)
+			it.second->destroyBuffer();
+	}
+	getMap().clear();
+}
@@ -0,0 +1,32 @@
+//
+// (c) 2024 Eduardo Doria.
+//
+
+#ifndef BUFFERPOOL_H
+#define BUFFERPOOL_H
+
+#include "render/BufferRender.h"
+#include <map>
+#include <memory>
+
+namespace Supernova{
+
+    typedef std::map< std::string, std::shared_ptr<BufferRender> > buffers_t;
+
+    // Immutable GPU buffers shared by meshes with same data (ex: same model file)
+    class BufferPool{
+    private:
+        static buffers_t& getMap();
+
+    public:
+        static std::shared_ptr<BufferRender> get(std::string id);
+        static std::shared_ptr<BufferRender> get(std::string id, BufferType type, size_t size, void* data);
+        static void remove(std::string id);
+
+        // necessary for engine shutdown
+        static void clear();
+
+    };
+}
+
+#endif /* BUFFERPOOL_H */
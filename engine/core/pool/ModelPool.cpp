@@ -0,0 +1,150 @@
+//
+// (c) 2024 Eduardo Doria.
+//
+
+#include "ModelPool.h"
+
+#include "Log.h"
+
+using namespace Supernova;
+
+gltfmodels_t& ModelPool::getGLTFMap(){
+    //To prevent similar problem of static init fiasco but on deinitialization
+    //https://isocpp.org/wiki/faq/ctors#static-init-order-on-first-use
+    static gltfmodels_t* map = new gltfmodels_t();
+    return *map;
+};
+
+objmodels_t& ModelPool::getOBJMap(){
+    static objmodels_t* map = new objmodels_t();
+    return *map;
+};
+
+skeletons_t& ModelPool::getSkeletonMap(){
+    static skeletons_t* map = new skeletons_t();
+    return *map;
+};
+
+skeletalanimations_t& ModelPool::getSkeletalAnimationMap(){
+    static skeletalanimations_t* map = new skeletalanimations_t();
+    return *map;
+};
+
+std::shared_ptr<tinygltf::Model> ModelPool::getGLTF(std::string filename){
+	auto& shared = getGLTFMap()[filename];
+
+	if (shared.use_count() > 0){
+		return shared;
+	}
+
+	return NULL;
+}
+
+std::shared_ptr<tinygltf::Model> ModelPool::getGLTF(std::string filename, std::shared_ptr<tinygltf::Model> model){
+	auto& shared = getGLTFMap()[filename];
+
+	if (shared.use_count() > 0){
+		return shared;
+	}
+
+	shared = model;
+
+	return model;
+}
+
+void ModelPool::removeGLTF(std::string filename){
+	if (getGLTFMap().count(filename)){
+		auto& shared = getGLTFMap()[filename];
+		if (shared.use_count() <= 1){
+			getGLTFMap().erase(filename);
+			getSkeletonMap().erase(filename);
+			getSkeletalAnimationMap().erase(filename);
+		}
+	}else{
+		Log::debug("Trying to destroy a non existent GLTF model: %s", filename.c_str());
+	}
+}
+
+std::shared_ptr<OBJModel> ModelPool::getOBJ(std::string filename){
+	auto& shared = getOBJMap()[filename];
+
+	if (shared.use_count() > 0){
+		return shared;
+	}
+
+	return NULL;
+}
+
+std::shared_ptr<OBJModel> ModelPool::getOBJ(std::string filename, std::shared_ptr<OBJModel> model){
+	auto& shared = getOBJMap()[filename];
+
+	if (shared.use_count() > 0){
+		return shared;
+	}
+
+	shared = model;
+
+	return model;
+}
+
+void ModelPool::removeOBJ(std::string filename){
+	if (getOBJMap().count(filename)){
+		auto& shared = getOBJMap()[filename];
+		if (shared.use_count() <= 1){
+			getOBJMap().erase(filename);
+		}
+	}else{
+		Log::debug("Trying to destroy a non existent OBJ model: %s", filename.c_str());
+	}
+}
+
+std::shared_ptr<SkeletonData> ModelPool::getSkeleton(std::string filename){
+	auto it = getSkeletonMap().find(filename);
+
+	if (it != getSkeletonMap().end()){
+		return it->second;
+	}
+
+	return NULL;
+}
+
+std::shared_ptr<SkeletonData> ModelPool::getSkeleton(std::string filename, std::shared_ptr<SkeletonData> data){
+	auto& shared = getSkeletonMap()[filename];
+
+	if (shared.use_count() > 0){
+		return shared;
+	}
+
+	shared = data;
+
+	return data;
+}
+
+std::shared_ptr<SkeletalAnimationData> ModelPool::getSkeletalAnimation(std::string filename){
+	auto it = getSkeletalAnimationMap().find(filename);
+
+	if (it != getSkeletalAnimationMap().end()){
+		return it->second;
+	}
+
+	return NULL;
+}
+
+std::shared_ptr<SkeletalAnimationData> ModelPool::getSkeletalAnimation(std::string filename, std::shared_ptr<SkeletalAnimationData> data){
+	auto& shared = getSkeletalAnimationMap()[filename];
+
+	if (shared.use_count() > 0){
+		return shared;
+	}
+
+	shared = data;
+
+	return data;
+}
+
+void ModelPool::clear(){
+	getGLTFMap().clear();
+	getOBJMap().clear();
+	getSkeletonMap().clear();
+	getSkeletalAnimationMap().clear();
+}
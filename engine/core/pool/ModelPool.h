@@ -0,0 +1,66 @@
+//
+// (c) 2024 Eduardo Doria.
+//
+
+#ifndef MODELPOOL_H
+#define MODELPOOL_H
+
+#include "buffer/InterleavedBuffer.h"
+#include "buffer/IndexBuffer.h"
+#include "texture/Material.h"
+#include "component/ModelComponent.h"
+#include "component/SkeletalAnimationComponent.h"
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace tinygltf {class Model;}
+
+namespace Supernova{
+
+    // OBJ file converted to engine buffers, one submesh for each material
+    struct OBJModel{
+        InterleavedBuffer buffer;
+        IndexBuffer indices;
+
+        std::vector<Material> materials;
+        std::vector<Attribute> indexAttributes;
+
+        bool transparent = false;
+    };
+
+    typedef std::map< std::string, std::shared_ptr<tinygltf::Model> > gltfmodels_t;
+    typedef std::map< std::string, std::shared_ptr<OBJModel> > objmodels_t;
+    typedef std::map< std::string, std::shared_ptr<SkeletonData> > skeletons_t;
+    typedef std::map< std::string, std::shared_ptr<SkeletalAnimationData> > skeletalanimations_t;
+
+    // Parsed model files shared by all entities loading same file
+    class ModelPool{
+    private:
+        static gltfmodels_t& getGLTFMap();
+        static objmodels_t& getOBJMap();
+        static skeletons_t& getSkeletonMap();
+        static skeletalanimations_t& getSkeletalAnimationMap();
+
+    public:
+        static std::shared_ptr<tinygltf::Model> getGLTF(std::string filename);
+        static std::shared_ptr<tinygltf::Model> getGLTF(std::string filename, std::shared_ptr<tinygltf::Model> model);
+        static void removeGLTF(std::string filename);
+
+        static std::shared_ptr<OBJModel> getOBJ(std::string filename);
+        static std::shared_ptr<OBJModel> getOBJ(std::string filename, std::shared_ptr<OBJModel> model);
+        static void removeOBJ(std::string filename);
+
+        // skeleton and clips of GLTF file, removed with GLTF model
+        static std::shared_ptr<SkeletonData> getSkeleton(std::string filename);
+        static std::shared_ptr<SkeletonData> getSkeleton(std::string filename, std::shared_ptr<SkeletonData> data);
+        static std::shared_ptr<SkeletalAnimationData> getSkeletalAnimation(std::string filename);
+        static std::shared_ptr<SkeletalAnimationData> getSkeletalAnimation(std::string filename, std::shared_ptr<SkeletalAnimationData> data);
+
+        // necessary for engine shutdown
+        static void clear();
+
+    };
+}
+
+#endif /* MODELPOOL_H */
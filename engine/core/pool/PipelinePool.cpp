@@ -0,0 +1,218 @@
+//
+// (c) 2024 Eduardo Doria.
+//
+
+#include "PipelinePool.h"
+
+#include "Log.h"
+#include "io/File.h"
+#include "pool/ShaderPool.h"
+#include "util/Profiler.h"
+#include <sstream>
+
+#define PIPELINE_MANIFEST_HEADER "SUPERNOVA_PIPELINES"
+#define PIPELINE_MANIFEST_VERSION 1
+
+using namespace Supernova;
+
+bool PipelinePool::recording = false;
+std::mutex PipelinePool::variantsMutex;
+
+std::set<std::string>& PipelinePool::getVariants(){
+    //To prevent similar problem of static init fiasco but on deinitialization
+    //https://isocpp.org/wiki/faq/ctors#static-init-order-on-first-use
+    static std::set<std::string>* variants = new std::set<std::string>();
+    return *variants;
+}
+
+std::vector<PipelineVariant>& PipelinePool::getPendingVariants(){
+    static std::vector<PipelineVariant>* pending = new std::vector<PipelineVariant>();
+    return *pending;
+}
+
+std::vector<PipelinePool::WarmPipeline>& PipelinePool::getWarmPipelines(){
+    static std::vector<WarmPipeline>* warmPipelines = new std::vector<WarmPipeline>();
+    return *warmPipelines;
+}
+
+std::string PipelinePool::getVariantStr(const PipelineVariant& variant){
+    std::ostringstream str;
+
+    str << variant.shaderKey << " " << (int)variant.primitiveType << " " << variant.indexed << " " << (int)variant.indexType << " "
+        << (int)variant.pipelines << " " << variant.enableFaceCulling << " " << (int)variant.cullingMode << " " << (int)variant.windingOrder << " "
+        << variant.attributes.size();
+
+    for (const PipelineVariantAttribute& attr : variant.attributes){
+        str << " " << attr.slot << " " << attr.buffer << " " << attr.elements << " " << (int)attr.dataType << " "
+            << attr.stride << " " << attr.offset << " " << attr.normalized << " " << attr.perInstance;
+    }
+
+    return str.str();
+}
+
+bool PipelinePool::readVariant(const std::string& str, PipelineVariant& variant){
+    std::istringstream in(str);
+
+    int primitiveType, indexType, pipelines, cullingMode, windingOrder;
+    size_t numAttributes;
+
+    in >> variant.shaderKey >> primitiveType >> variant.indexed >> indexType >> pipelines
+       >> variant.enableFaceCulling >> cullingMode >> windingOrder >> numAttributes;
+
+    if (in.fail()){
+        return false;
+    }
+
+    variant.primitiveType = (PrimitiveType)primitiveType;
+    variant.indexType = (AttributeDataType)indexType;
+    variant.pipelines = (uint8_t)pipelines;
+    variant.cullingMode = (CullingMode)cullingMode;
+    variant.windingOrder = (WindingOrder)windingOrder;
+
+    variant.attributes.clear();
+    for (size_t i = 0; i < numAttributes; i++){
+        PipelineVariantAttribute attr;
+        int dataType;
+
+        in >> attr.slot >> attr.buffer >> attr.elements >> dataType >> attr.stride >> attr.offset >> attr.normalized >> attr.perInstance;
+        attr.dataType = (AttributeDataType)dataType;
+
+        variant.attributes.push_back(attr);
+    }
+
+    return !in.fail();
+}
+
+void PipelinePool::setRecording(bool recording){
+    PipelinePool::recording = recording;
+}
+
+bool PipelinePool::isRecording(){
+    return recording;
+}
+
+void PipelinePool::addVariant(const PipelineVariant& variant){
+    std::string str = getVariantStr(variant);
+
+    std::lock_guard<std::mutex> lock(variantsMutex);
+    getVariants().insert(str);
+}
+
+size_t PipelinePool::getNumVariants(){
+    std::lock_guard<std::mutex> lock(variantsMutex);
+    return getVariants().size();
+}
+
+bool PipelinePool::warmUp(const PipelineVariant& variant){
+    ShaderType shaderType = (ShaderType)(variant.shaderKey >> 32);
+    uint32_t properties = (uint32_t)variant.shaderKey;
+
+    WarmPipeline warm;
+    warm.shader = ShaderPool::get(shaderType, properties, false);
+
+    if (!warm.shader->isCreated() || !warm.render.warmUp(variant, warm.shader.get())){
+        warm.render.destroy();
+        warm.shader.reset();
+        ShaderPool::remove(shaderType, properties);
+        return false;
+    }
+
+    getWarmPipelines().push_back(warm);
+
+    return true;
+}
+
+void PipelinePool::warmUp(){
+    if (getPendingVariants().empty()){
+        return;
+    }
+
+    PROFILE_ZONE("PipelinePool::warmUp");
+
+    size_t count = 0;
+    for (const PipelineVariant& variant : getPendingVariants()){
+        if (warmUp(variant)){
+            count++;
+        }
+    }
+
+    Log::verbose("Warmed up %lu of %lu pipeline variants", (unsigned long)count, (unsigned long)getPendingVariants().size());
+
+    getPendingVariants().clear();
+}
+
+bool PipelinePool::loadManifest(std::string filename){
+    File file;
+
+    if (file.open(filename.c_str()) != FileErrors::FILEDATA_OK){
+        // first run, manifest is created at the end
+        Log::verbose("Pipeline manifest not found: %s", filename.c_str());
+        return false;
+    }
+
+    std::istringstream in(file.readString());
+
+    std::string header, lang;
+    int version = 0;
+    std::getline(in, header);
+    std::istringstream(header) >> header >> version >> lang;
+
+    // layout offsets depend on backend
+    if (header != PIPELINE_MANIFEST_HEADER || version != PIPELINE_MANIFEST_VERSION || lang != ShaderPool::getShaderLangStr()){
+        Log::warn("Ignoring pipeline manifest of other version or shader language: %s", filename.c_str());
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(variantsMutex);
+
+    std::string line;
+    while (std::getline(in, line)){
+        if (line.empty())
+            continue;
+
+        PipelineVariant variant;
+        if (!readVariant(line, variant)){
+            Log::error("Invalid variant in pipeline manifest: %s", filename.c_str());
+            continue;
+        }
+
+        if (getVariants().insert(line).second){
+            getPendingVariants().push_back(variant);
+        }
+    }
+
+    return true;
+}
+
+bool PipelinePool::saveManifest(std::string filename){
+    std::string manifest = std::string(PIPELINE_MANIFEST_HEADER) + " " + std::to_string(PIPELINE_MANIFEST_VERSION) + " " + ShaderPool::getShaderLangStr() + "\n";
+
+    {
+        std::lock_guard<std::mutex> lock(variantsMutex);
+        for (const std::string& variant : getVariants()){
+            manifest += variant + "\n";
+        }
+    }
+
+    File file;
+    if (file.open(filename.c_str(), true) != FileErrors::FILEDATA_OK){
+        Log::error("Cannot open pipeline manifest file: %s", filename.c_str());
+        return false;
+    }
+
+    file.writeString(manifest);
+
+    return true;
+}
+
+void PipelinePool::clear(){
+    for (WarmPipeline& warm : getWarmPipelines()){
+        warm.render.destroy();
+    }
+    getWarmPipelines().clear();
+
+    getPendingVariants().clear();
+
+    std::lock_guard<std::mutex> lock(variantsMutex);
+    getVariants().clear();
+}
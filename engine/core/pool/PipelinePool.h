@@ -0,0 +1,60 @@
+//
+// (c) 2024 Eduardo Doria.
+//
+
+#ifndef PIPELINEPOOL_H
+#define PIPELINEPOOL_H
+
+#include "render/ObjectRender.h"
+#include "render/ShaderRender.h"
+#include <set>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+
+namespace Supernova{
+
+    // Pipelines are shared by backend between objects with same description.
+    // This pool records variants (shader, vertex layout and states) used by objects and creates
+    // their shaders and pipelines before objects need them, avoiding driver stalls in middle of frames.
+    // Variants used in previous runs are read from a manifest file, see Engine::setPipelineManifest.
+    class PipelinePool{
+    private:
+        struct WarmPipeline{
+            std::shared_ptr<ShaderRender> shader;
+            ObjectRender render;
+        };
+
+        static bool recording;
+        static std::mutex variantsMutex;
+
+        static std::set<std::string>& getVariants();
+        static std::vector<PipelineVariant>& getPendingVariants();
+        static std::vector<WarmPipeline>& getWarmPipelines();
+
+        static std::string getVariantStr(const PipelineVariant& variant);
+        static bool readVariant(const std::string& str, PipelineVariant& variant);
+
+    public:
+        static void setRecording(bool recording);
+        static bool isRecording();
+
+        // called by ObjectRender when recording
+        static void addVariant(const PipelineVariant& variant);
+        static size_t getNumVariants();
+
+        // creates and keeps variant shader and pipelines
+        static bool warmUp(const PipelineVariant& variant);
+        // warms up variants read from manifest, called by RenderSystem after loading scene objects
+        static void warmUp();
+
+        static bool loadManifest(std::string filename);
+        static bool saveManifest(std::string filename);
+
+        // necessary for engine shutdown
+        static void clear();
+    };
+}
+
+#endif /* PIPELINEPOOL_H */
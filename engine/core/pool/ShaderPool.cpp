@@ -7,23 +7,27 @@
 #include "Log.h"
 #include "Engine.h"
 #include "shader/SBSReader.h"
-#include "util/Base64.h"
 
-#ifdef SOKOL_GLCORE
+#if defined(SOKOL_GLCORE) || defined(SOKOL_DUMMY_BACKEND)
 #include "glsl410.h"
+#define SHADER_ARCHIVE shaders_glsl410
 #endif
 #ifdef SOKOL_GLES3
 #include "glsl300es.h"
+#define SHADER_ARCHIVE shaders_glsl300es
 #endif
 #ifdef SOKOL_D3D11
 #include "hlsl5.h"
+#define SHADER_ARCHIVE shaders_hlsl5
 #endif
 #if SOKOL_METAL || SUPERNOVA_APPLE
 #include <TargetConditionals.h>
 #if TARGET_OS_IPHONE
 #include "msl21ios.h"
+#define SHADER_ARCHIVE shaders_msl21ios
 #elif TARGET_OS_MAC
 #include "msl21macos.h"
+#define SHADER_ARCHIVE shaders_msl21macos
 #endif
 #endif
 
@@ -36,6 +40,19 @@ shaders_t& ShaderPool::getMap(){
     return *map;
 };
 
+const ShaderArchive& ShaderPool::getArchive(){
+    static ShaderArchive* archive = nullptr;
+
+    if (!archive){
+        archive = new ShaderArchive();
+        #ifdef SHADER_ARCHIVE
+        archive->open(SHADER_ARCHIVE, sizeof(SHADER_ARCHIVE));
+        #endif
+    }
+
+    return *archive;
+}
+
 std::vector<std::string>& ShaderPool::getMissingShaders(){
     static std::vector<std::string>* missingshaders = new std::vector<std::string>();
     return *missingshaders;
@@ -44,6 +61,8 @@ std::vector<std::string>& ShaderPool::getMissingShaders(){
 std::string ShaderPool::getShaderLangStr(){
 	if (Engine::getGraphicBackend() == GraphicBackend::GLCORE){
 		return "glsl410";
+	}else if (Engine::getGraphicBackend() == GraphicBackend::DUMMY){
+		return "glsl410"; // shader code is ignored, only reflection data is used
 	}else if (Engine::getGraphicBackend() == GraphicBackend::GLES3){
 		return "glsl300es";
 	}else if (Engine::getGraphicBackend() == GraphicBackend::METAL){
@@ -76,7 +95,13 @@ std::string ShaderPool::getShaderName(std::string shaderStr){
 	return name;
 }
 
-std::string ShaderPool::getShaderStr(ShaderType shaderType, std::string properties){
+// suffixes of shader names, in same bit order of ShaderProperty
+static const char* shaderPropertySuffixes[] = {
+	"Ult", "Tex", "Ftx", "Uv1", "Uv2", "Puc", "Shw", "Pcf", "Nor", "Nmp", "Tan",
+	"Vc3", "Vc4", "Txr", "Fog", "Ski", "Mta", "Mnr", "Mtg", "Ter", "Ist", "Dcp"
+};
+
+std::string ShaderPool::getShaderStr(ShaderType shaderType, uint32_t properties){
 
 	std::string str;
 
@@ -97,15 +122,24 @@ std::string ShaderPool::getShaderStr(ShaderType shaderType, std::string properti
 	if (str.empty())
 		Log::error("Erro mapping shader type to string");
 
-	if (!properties.empty())
-		str += "_" + properties;
+	if (properties != 0){
+		str += "_";
+		for (int i = 0; i < sizeof(shaderPropertySuffixes) / sizeof(shaderPropertySuffixes[0]); i++){
+			if (properties & (1 << i))
+				str += shaderPropertySuffixes[i];
+		}
+	}
 
 	return str;
 }
 
-std::shared_ptr<ShaderRender> ShaderPool::get(ShaderType shaderType, std::string properties){
-	std::string shaderStr = getShaderStr(shaderType, properties);
-	auto& shared = getMap()[shaderStr];
+ShaderKey ShaderPool::getShaderKey(ShaderType shaderType, uint32_t properties){
+	return ((ShaderKey)shaderType << 32) | properties;
+}
+
+std::shared_ptr<ShaderRender> ShaderPool::get(ShaderType shaderType, uint32_t properties, bool reportMissing){
+	ShaderKey key = getShaderKey(shaderType, properties);
+	auto& shared = getMap()[key];
 
 	if (shared.use_count() > 0){
 		return shared;
@@ -114,30 +148,43 @@ std::shared_ptr<ShaderRender> ShaderPool::get(ShaderType shaderType, std::string
 	SBSReader sbs;
 	const auto resource =  std::make_shared<ShaderRender>();
 
-	std::string base64Shd = getBase64Shader(getShaderName(shaderStr));
-	if (!base64Shd.empty() && sbs.read(Base64::decode(base64Shd))){ // from c header
-		resource->createShader(sbs.getShaderData());
-		//Log::debug("Create shader %s", shaderStr.c_str());
-	}else if (sbs.read("shader://"+getShaderFile(shaderStr))){ // from file in assets/shaders dir
+	const unsigned char* shaderData;
+	size_t shaderSize;
+	if (getArchive().find(key, shaderData, shaderSize) && sbs.read(shaderData, shaderSize)){ // from embedded archive
 		resource->createShader(sbs.getShaderData());
-		//Log::debug("Create shader %s", shaderStr.c_str());
+		//Log::debug("Create shader %s", getShaderStr(shaderType, properties).c_str());
 	}else{
-		getMissingShaders().push_back(shaderStr);
+		// names are only created for shaders not embedded in engine
+		std::string shaderStr = getShaderStr(shaderType, properties);
+		if (sbs.read("shader://"+getShaderFile(shaderStr))){ // from file in assets/shaders dir
+			resource->createShader(sbs.getShaderData());
+			//Log::debug("Create shader %s", shaderStr.c_str());
+		}else if (reportMissing){
+			getMissingShaders().push_back(shaderStr);
+		}
 	}
 
+	resource->key = key;
 	shared = resource;
 
 	return resource;
 }
 
-void ShaderPool::remove(ShaderType shaderType, std::string properties){
-	std::string shaderStr = getShaderStr(shaderType, properties);
-	if (getMap().count(shaderStr)){
-		auto& shared = getMap()[shaderStr];
+bool ShaderPool::isEmbedded(ShaderType shaderType, uint32_t properties){
+	const unsigned char* shaderData;
+	size_t shaderSize;
+	return getArchive().find(getShaderKey(shaderType, properties), shaderData, shaderSize);
+}
+
+void ShaderPool::remove(ShaderType shaderType, uint32_t properties){
+	ShaderKey key = getShaderKey(shaderType, properties);
+	auto it = getMap().find(key);
+	if (it != getMap().end()){
+		auto& shared = it->second;
 		if (shared.use_count() <= 1){
 			shared->destroyShader();
-			//Log::debug("Remove shader %s", shaderStr.c_str());
-			getMap().erase(shaderStr);
+			//Log::debug("Remove shader %s", getShaderStr(shaderType, properties).c_str());
+			getMap().erase(it);
 		}
 	}else{
 		if (Engine::isViewLoaded()){
@@ -146,113 +193,113 @@ void ShaderPool::remove(ShaderType shaderType, std::string properties){
 	}
 }
 
-std::string ShaderPool::getMeshProperties(bool unlit, bool uv1, bool uv2, 
+uint32_t ShaderPool::getMeshProperties(bool unlit, bool uv1, bool uv2, 
 						bool punctual, bool shadows, bool shadowsPCF, bool normals, bool normalMap, 
 						bool tangents, bool vertexColorVec3, bool vertexColorVec4, bool textureRect, 
 						bool fog, bool skinning, bool morphTarget, bool morphNormal, bool morphTangent,
 						bool terrain, bool instanced){
-	std::string prop;
+	uint32_t prop = 0;
 
 	if (unlit)
-		prop += "Ult";
+		prop |= SHD_UNLIT;
 	if (uv1)
-		prop += "Uv1";
+		prop |= SHD_UV_SET1;
 	if (uv2)
-		prop += "Uv2";
+		prop |= SHD_UV_SET2;
 	if (punctual)
-		prop += "Puc";
+		prop |= SHD_PUNCTUAL;
 	if (shadows)
-		prop += "Shw";
+		prop |= SHD_SHADOWS;
 	if (shadowsPCF)
-		prop += "Pcf";
+		prop |= SHD_SHADOWS_PCF;
 	if (normals)
-		prop += "Nor";
+		prop |= SHD_NORMALS;
 	if (normalMap)
-		prop += "Nmp";
+		prop |= SHD_NORMAL_MAP;
 	if (tangents)
-		prop += "Tan";
+		prop |= SHD_TANGENTS;
 	if (vertexColorVec3)
-		prop += "Vc3";
+		prop |= SHD_VERTEX_COLOR_VEC3;
 	if (vertexColorVec4)
-		prop += "Vc4";
+		prop |= SHD_VERTEX_COLOR_VEC4;
 	if (textureRect)
-		prop += "Txr";
+		prop |= SHD_TEXTURERECT;
 	if (fog)
-		prop += "Fog";
+		prop |= SHD_FOG;
 	if (skinning)
-		prop += "Ski";
+		prop |= SHD_SKINNING;
 	if (morphTarget)
-		prop += "Mta";
+		prop |= SHD_MORPHTARGET;
 	if (morphNormal)
-		prop += "Mnr";
+		prop |= SHD_MORPHNORMAL;
 	if (morphTangent)
-		prop += "Mtg";
+		prop |= SHD_MORPHTANGENT;
 	if (terrain)
-		prop += "Ter";
+		prop |= SHD_TERRAIN;
 	if (instanced)
-		prop += "Ist";
+		prop |= SHD_INSTANCING;
 
 	return prop;
 }
 
-std::string ShaderPool::getDepthMeshProperties(bool texture, bool skinning, bool morphTarget, bool morphNormal, bool morphTangent, bool terrain, bool instanced){
-	std::string prop;
+uint32_t ShaderPool::getDepthMeshProperties(bool texture, bool skinning, bool morphTarget, bool morphNormal, bool morphTangent, bool terrain, bool instanced){
+	uint32_t prop = 0;
 
 	if (texture)
-		prop += "Tex";
+		prop |= SHD_TEXTURE;
 	if (skinning)
-		prop += "Ski";
+		prop |= SHD_SKINNING;
 	if (morphTarget)
-		prop += "Mta";
+		prop |= SHD_MORPHTARGET;
 	if (morphNormal)
-		prop += "Mnr";
+		prop |= SHD_MORPHNORMAL;
 	if (morphTangent)
-		prop += "Mtg";
+		prop |= SHD_MORPHTANGENT;
 	if (terrain)
-		prop += "Ter";
+		prop |= SHD_TERRAIN;
 	if (instanced)
-		prop += "Ist";
+		prop |= SHD_INSTANCING;
 
 	return prop;
 }
 
-std::string ShaderPool::getUIProperties(bool texture, bool fontAtlasTexture, bool vertexColorVec3, bool vertexColorVec4){
-	std::string prop;
+uint32_t ShaderPool::getUIProperties(bool texture, bool fontAtlasTexture, bool vertexColorVec3, bool vertexColorVec4){
+	uint32_t prop = 0;
 
 	if (texture)
-		prop += "Tex";
+		prop |= SHD_TEXTURE;
 	if (fontAtlasTexture)
-		prop += "Ftx";
+		prop |= SHD_FONTATLAS_TEXTURE;
 	if (vertexColorVec3)
-		prop += "Vc3";
+		prop |= SHD_VERTEX_COLOR_VEC3;
 	if (vertexColorVec4)
-		prop += "Vc4";
+		prop |= SHD_VERTEX_COLOR_VEC4;
 
 	return prop;
 }
 
-std::string ShaderPool::getPointsProperties(bool texture, bool vertexColorVec3, bool vertexColorVec4, bool textureRect){
-	std::string prop;
+uint32_t ShaderPool::getPointsProperties(bool texture, bool vertexColorVec3, bool vertexColorVec4, bool textureRect){
+	uint32_t prop = 0;
 
 	if (texture)
-		prop += "Tex";
+		prop |= SHD_TEXTURE;
 	if (vertexColorVec3)
-		prop += "Vc3";
+		prop |= SHD_VERTEX_COLOR_VEC3;
 	if (vertexColorVec4)
-		prop += "Vc4";
+		prop |= SHD_VERTEX_COLOR_VEC4;
 	if (textureRect)
-		prop += "Txr";
+		prop |= SHD_TEXTURERECT;
 
 	return prop;
 }
 
-std::string ShaderPool::getLinesProperties(bool vertexColorVec3, bool vertexColorVec4){
-	std::string prop;
+uint32_t ShaderPool::getLinesProperties(bool vertexColorVec3, bool vertexColorVec4){
+	uint32_t prop = 0;
 
 	if (vertexColorVec3)
-		prop += "Vc3";
+		prop |= SHD_VERTEX_COLOR_VEC3;
 	if (vertexColorVec4)
-		prop += "Vc4";
+		prop |= SHD_VERTEX_COLOR_VEC4;
 
 	return prop;
 }
@@ -6,37 +6,44 @@
 #define SHADERPOOL_H
 
 #include "render/ShaderRender.h"
+#include "shader/ShaderArchive.h"
 #include <map>
 #include <memory>
 
 namespace Supernova{
 
-    typedef std::map<std::string, std::shared_ptr<ShaderRender>> shaders_t;
+    typedef std::map<ShaderKey, std::shared_ptr<ShaderRender>> shaders_t;
 
     class ShaderPool{  
     private:
         static shaders_t& getMap();
+        static const ShaderArchive& getArchive();
 
         static std::string getShaderFile(std::string shaderStr);
         static std::string getShaderName(std::string shaderStr);
-        static std::string getShaderStr(ShaderType shaderType, std::string properties);
+        static std::string getShaderStr(ShaderType shaderType, uint32_t properties);
 
     public:
-        static std::shared_ptr<ShaderRender> get(ShaderType shaderType, std::string properties);
-        static void remove(ShaderType shaderType, std::string properties);
+        // missing shaders are reported by RenderSystem, except with reportMissing false (ex: pipeline warm-up)
+        static std::shared_ptr<ShaderRender> get(ShaderType shaderType, uint32_t properties, bool reportMissing = true);
+        static void remove(ShaderType shaderType, uint32_t properties);
+
+        static ShaderKey getShaderKey(ShaderType shaderType, uint32_t properties);
+        // only checks engine archive, shaders of project assets are not included
+        static bool isEmbedded(ShaderType shaderType, uint32_t properties);
 
         static std::string getShaderLangStr();
         static std::vector<std::string>& getMissingShaders();
 
-        static std::string getMeshProperties(bool unlit, bool uv1, bool uv2, 
+        static uint32_t getMeshProperties(bool unlit, bool uv1, bool uv2, 
 						bool punctual, bool shadows, bool shadowsPCF, bool normals, bool normalMap, 
 						bool tangents, bool vertexColorVec3, bool vertexColorVec4, bool textureRect, 
                         bool fog, bool skinning, bool morphTarget, bool morphNormal, bool morphTangent,
                         bool terrain, bool instanced);
-        static std::string getDepthMeshProperties(bool texture, bool skinning, bool morphTarget, bool morphNormal, bool morphTangent, bool terrain, bool instanced);
-        static std::string getUIProperties(bool texture, bool fontAtlasTexture, bool vertexColorVec3, bool vertexColorVec4);
-        static std::string getPointsProperties(bool texture, bool vertexColorVec3, bool vertexColorVec4, bool textureRect);
-        static std::string getLinesProperties(bool vertexColorVec3, bool vertexColorVec4);
+        static uint32_t getDepthMeshProperties(bool texture, bool skinning, bool morphTarget, bool morphNormal, bool morphTangent, bool terrain, bool instanced);
+        static uint32_t getUIProperties(bool texture, bool fontAtlasTexture, bool vertexColorVec3, bool vertexColorVec4);
+        static uint32_t getPointsProperties(bool texture, bool vertexColorVec3, bool vertexColorVec4, bool textureRect);
+        static uint32_t getLinesProperties(bool vertexColorVec3, bool vertexColorVec4);
 
 		// necessary for engine shutdown
 		static void clear();
@@ -48,7 +48,7 @@ std::shared_ptr<TextureRender> TexturePool::get(std::string id, TextureType type
 		size_array[f] = (size_t)data[f].getSize();
 	}
 
-	resource->createTexture(id, data[0].getWidth(), data[0].getHeight(), data[0].getColorFormat(), type, numFaces, data_array, size_array, minFilter, magFilter, wrapU, wrapV);
+	resource->createTexture(id, data[0].getWidth(), data[0].getHeight(), data[0].getColorFormat(), type, numFaces, data_array, size_array, minFilter, magFilter, wrapU, wrapV, data[0].getMipLevels());
 	//Log::debug("Create texture %s", id.c_str());
 	shared = resource;
 
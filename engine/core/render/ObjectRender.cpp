@@ -4,10 +4,14 @@
 
 #include "ObjectRender.h"
 
+#include "pool/PipelinePool.h"
+#include <algorithm>
+
 using namespace Supernova;
 
 ObjectRender::ObjectRender(){ }
 
+// variant is only used while loading, it is not copied
 ObjectRender::ObjectRender(const ObjectRender& rhs) : backend(rhs.backend) { }
 
 ObjectRender& ObjectRender::operator=(const ObjectRender& rhs) { 
@@ -19,16 +23,40 @@ ObjectRender::~ObjectRender(){
     //Cannot destroy because its a handle
 }
 
+void ObjectRender::clearVariant(){
+    variant.reset();
+    variantBuffers.clear();
+}
+
 void ObjectRender::beginLoad(PrimitiveType primitiveType){
     backend.beginLoad(primitiveType);
+
+    clearVariant();
+    if (PipelinePool::isRecording()){
+        variant.reset(new PipelineVariant());
+        variant->primitiveType = primitiveType;
+    }
 }
 
 void ObjectRender::addIndex(BufferRender* buffer, AttributeDataType dataType, size_t offset){
     backend.addIndex(buffer, dataType, offset);
+
+    if (variant){
+        variant->indexed = true;
+        variant->indexType = dataType;
+    }
 }
 
 void ObjectRender::addAttribute(int slot, BufferRender* buffer, unsigned int elements, AttributeDataType dataType, unsigned int stride, size_t offset, bool normalized, bool perInstance){
     backend.addAttribute(slot, buffer, elements, dataType, stride, offset, normalized, perInstance);
+
+    if (variant && slot != -1){
+        int bufferIndex = (int)(std::find(variantBuffers.begin(), variantBuffers.end(), buffer) - variantBuffers.begin());
+        if (bufferIndex == variantBuffers.size()){
+            variantBuffers.push_back(buffer);
+        }
+        variant->attributes.push_back({slot, bufferIndex, elements, dataType, stride, offset, normalized, perInstance});
+    }
 }
 
 void ObjectRender::addStorageBuffer(int slot, ShaderStageType stage, BufferRender* buffer){
@@ -37,6 +65,10 @@ void ObjectRender::addStorageBuffer(int slot, ShaderStageType stage, BufferRende
 
 void ObjectRender::addShader(ShaderRender* shader){
     backend.addShader(shader);
+
+    if (variant){
+        variant->shaderKey = shader->key;
+    }
 }
 
 void ObjectRender::addTexture(std::pair<int, int> slot, ShaderStageType stage, TextureRender* texture){
@@ -44,7 +76,37 @@ void ObjectRender::addTexture(std::pair<int, int> slot, ShaderStageType stage, T
 }
 
 bool ObjectRender::endLoad(uint8_t pipelines, bool enableFaceCulling, CullingMode cullingMode, WindingOrder windingOrder){
-    return backend.endLoad(pipelines, enableFaceCulling, cullingMode, windingOrder);
+    bool ret = backend.endLoad(pipelines, enableFaceCulling, cullingMode, windingOrder);
+
+    if (variant){
+        if (ret){
+            variant->pipelines = pipelines;
+            variant->enableFaceCulling = enableFaceCulling;
+            variant->cullingMode = cullingMode;
+            variant->windingOrder = windingOrder;
+            PipelinePool::addVariant(*variant);
+        }
+        clearVariant();
+    }
+
+    return ret;
+}
+
+bool ObjectRender::warmUp(const PipelineVariant& variant, ShaderRender* shader){
+    backend.beginLoad(variant.primitiveType);
+    if (variant.indexed){
+        backend.addIndexType(variant.indexType);
+    }
+    for (const PipelineVariantAttribute& attr : variant.attributes){
+        backend.addAttributeLayout(attr.slot, attr.buffer, attr.elements, attr.dataType, attr.stride, attr.offset, attr.normalized, attr.perInstance);
+    }
+    backend.addShader(shader);
+
+    return backend.endLoad(variant.pipelines, variant.enableFaceCulling, variant.cullingMode, variant.windingOrder);
+}
+
+uint64_t ObjectRender::getStateKey(PipelineType pipType) const{
+    return backend.getStateKey(pipType);
 }
 
 bool ObjectRender::beginDraw(PipelineType pipType){
@@ -55,6 +117,10 @@ void ObjectRender::applyUniformBlock(int slot, ShaderStageType stage, unsigned i
     backend.applyUniformBlock(slot, stage, count, data);
 }
 
+void ObjectRender::applySharedUniformBlock(int slot, ShaderStageType stage, unsigned int count, void* data){
+    backend.applySharedUniformBlock(slot, stage, count, data);
+}
+
 void ObjectRender::draw(unsigned int vertexCount, unsigned int instanceCount){
     backend.draw(vertexCount, instanceCount);
 }
@@ -10,10 +10,44 @@
 
 #include "sokol/SokolObject.h"
 
+#include <vector>
+#include <memory>
+
 namespace Supernova {
 
+    struct PipelineVariantAttribute{
+        int slot;
+        int buffer; // index of different buffers in same variant
+        unsigned int elements;
+        AttributeDataType dataType;
+        unsigned int stride;
+        size_t offset;
+        bool normalized;
+        bool perInstance;
+    };
+
+    // everything that defines backend pipelines of an object, without its buffers and textures
+    struct PipelineVariant{
+        ShaderKey shaderKey = 0;
+        PrimitiveType primitiveType = PrimitiveType::TRIANGLES;
+        bool indexed = false;
+        AttributeDataType indexType = AttributeDataType::UNSIGNED_SHORT;
+        std::vector<PipelineVariantAttribute> attributes;
+        uint8_t pipelines = 0;
+        bool enableFaceCulling = false;
+        CullingMode cullingMode = CullingMode::BACK;
+        WindingOrder windingOrder = WindingOrder::CCW;
+    };
+
     class ObjectRender{
 
+    private:
+        // only filled when PipelinePool is recording
+        std::unique_ptr<PipelineVariant> variant;
+        std::vector<BufferRender*> variantBuffers;
+
+        void clearVariant();
+
     public:
 
         //***Backend***
@@ -33,8 +67,16 @@ namespace Supernova {
         void addTexture(std::pair<int, int> slot, ShaderStageType stage, TextureRender* texture);
         bool endLoad(uint8_t pipelines, bool enableFaceCulling, CullingMode cullingMode, WindingOrder windingOrder);
 
+        // creates pipelines of a variant without any object, they are shared with objects loaded later
+        bool warmUp(const PipelineVariant& variant, ShaderRender* shader);
+
+        // backend state identifier (shader, pipeline, texture) used to sort draws, 40 bits
+        uint64_t getStateKey(PipelineType pipType) const;
+
         bool beginDraw(PipelineType pipType);
         void applyUniformBlock(int slot, ShaderStageType stage, unsigned int count, void* data);
+        // data is not changed during render pass (lights, fog, shadows, skinning), applied again only after pipeline change
+        void applySharedUniformBlock(int slot, ShaderStageType stage, unsigned int count, void* data);
         void draw(unsigned int vertexCount, unsigned int instanceCount);
 
         void destroy();
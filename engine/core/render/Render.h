@@ -5,6 +5,7 @@
 #ifndef Render_h
 #define Render_h
 
+#include <cstdint>
 
 namespace Supernova{
 
@@ -46,6 +47,36 @@ namespace Supernova{
         UI
     };
 
+    // shader type in high bits and ShaderProperty flags in low bits
+    typedef uint64_t ShaderKey;
+
+    // shader variant properties, bit order is same of suffixes in shader names (ex: mesh_Uv1PucNor)
+    // keep it in sync with tools/supershader.py
+    enum ShaderProperty {
+        SHD_UNLIT               = 1 << 0,  // Ult
+        SHD_TEXTURE             = 1 << 1,  // Tex
+        SHD_FONTATLAS_TEXTURE   = 1 << 2,  // Ftx
+        SHD_UV_SET1             = 1 << 3,  // Uv1
+        SHD_UV_SET2             = 1 << 4,  // Uv2
+        SHD_PUNCTUAL            = 1 << 5,  // Puc
+        SHD_SHADOWS             = 1 << 6,  // Shw
+        SHD_SHADOWS_PCF         = 1 << 7,  // Pcf
+        SHD_NORMALS             = 1 << 8,  // Nor
+        SHD_NORMAL_MAP          = 1 << 9,  // Nmp
+        SHD_TANGENTS            = 1 << 10, // Tan
+        SHD_VERTEX_COLOR_VEC3   = 1 << 11, // Vc3
+        SHD_VERTEX_COLOR_VEC4   = 1 << 12, // Vc4
+        SHD_TEXTURERECT         = 1 << 13, // Txr
+        SHD_FOG                 = 1 << 14, // Fog
+        SHD_SKINNING            = 1 << 15, // Ski
+        SHD_MORPHTARGET         = 1 << 16, // Mta
+        SHD_MORPHNORMAL         = 1 << 17, // Mnr
+        SHD_MORPHTANGENT        = 1 << 18, // Mtg
+        SHD_TERRAIN             = 1 << 19, // Ter
+        SHD_INSTANCING          = 1 << 20, // Ist
+        SHD_DEPTH_COPY          = 1 << 21  // Dcp
+    };
+
     enum class AttributeType{
         INDEX,
         POSITION,
@@ -169,7 +200,18 @@ namespace Supernova{
 
     enum class ColorFormat{
         RED,
-        RGBA
+        RGBA,
+        // GPU compressed block formats, loaded from KTX2 files
+        BC1_RGBA,
+        BC3_RGBA,
+        BC4_R,
+        BC5_RG,
+        BC7_RGBA,
+        ETC2_RGB8,
+        ETC2_RGBA8,
+        EAC_R11,
+        EAC_RG11,
+        ASTC_4x4_RGBA
     };
 
     enum class TextureFilter{
@@ -9,13 +9,16 @@
 
 using namespace Supernova;
 
-ShaderRender::ShaderRender(){ }
+ShaderRender::ShaderRender(){
+    key = 0;
+}
 
-ShaderRender::ShaderRender(const ShaderRender& rhs) : backend(rhs.backend), shaderData(rhs.shaderData) { }
+ShaderRender::ShaderRender(const ShaderRender& rhs) : backend(rhs.backend), shaderData(rhs.shaderData), key(rhs.key) { }
 
 ShaderRender& ShaderRender::operator=(const ShaderRender& rhs) { 
     backend = rhs.backend;
     shaderData = rhs.shaderData;
+    key = rhs.key;
     return *this; 
 }
 
@@ -20,6 +20,7 @@ namespace Supernova{
         SokolShader backend;
         //***
         ShaderData shaderData; //For reflection info
+        ShaderKey key; //Variant set by ShaderPool
 
         ShaderRender();
         ShaderRender(const ShaderRender& rhs);
@@ -24,9 +24,9 @@ TextureRender::~TextureRender(){
 bool TextureRender::createTexture(
                 std::string label, int width, int height, 
                 ColorFormat colorFormat, TextureType type, int numFaces, void* data[6], size_t size[6], 
-                TextureFilter minFilter, TextureFilter magFilter, TextureWrap wrapU, TextureWrap wrapV){
+                TextureFilter minFilter, TextureFilter magFilter, TextureWrap wrapU, TextureWrap wrapV, int mipLevels){
     if (Engine::isViewLoaded())
-        return backend.createTexture(label, width, height, colorFormat, type, numFaces, data, size, minFilter, magFilter, wrapU, wrapV);
+        return backend.createTexture(label, width, height, colorFormat, type, numFaces, data, size, minFilter, magFilter, wrapU, wrapV, mipLevels);
     else
         return false;
 }
@@ -42,4 +42,11 @@ bool TextureRender::createFramebufferTexture(
 
 void TextureRender::destroyTexture(){
     backend.destroyTexture();
-}
\ No newline at end of file
+}
+
+bool TextureRender::isFormatSupported(ColorFormat colorFormat){
+    if (Engine::isViewLoaded())
+        return SokolTexture::isFormatSupported(colorFormat);
+    else
+        return false;
+}
@@ -26,13 +26,16 @@ namespace Supernova{
         bool createTexture(
                 std::string label, int width, int height, 
                 ColorFormat colorFormat, TextureType type, int numFaces, void* data[6], size_t size[6],
-                TextureFilter minFilter, TextureFilter magFilter, TextureWrap wrapU, TextureWrap wrapV);
+                TextureFilter minFilter, TextureFilter magFilter, TextureWrap wrapU, TextureWrap wrapV, int mipLevels = 1);
 
         bool createFramebufferTexture(
                 TextureType type, bool depth, bool shadowMap, int width, int height, 
                 TextureFilter minFilter, TextureFilter magFilter, TextureWrap wrapU, TextureWrap wrapV);
 
         void destroyTexture();
+
+        // compressed formats depend on graphic backend and device
+        static bool isFormatSupported(ColorFormat colorFormat);
     };
 }
 
@@ -61,6 +61,7 @@ void LuaBinding::registerCoreClasses(lua_State *L){
         .addVariable("D3D11", GraphicBackend::D3D11)
         .addVariable("METAL", GraphicBackend::METAL)
         .addVariable("WGPU", GraphicBackend::WGPU)
+        .addVariable("DUMMY", GraphicBackend::DUMMY)
         .endNamespace();
 
     luabridge::getGlobalNamespace(L)
@@ -82,6 +83,16 @@ void LuaBinding::registerCoreClasses(lua_State *L){
         .beginNamespace("ColorFormat")
         .addVariable("RED", ColorFormat::RED)
         .addVariable("RGBA", ColorFormat::RGBA)
+        .addVariable("BC1_RGBA", ColorFormat::BC1_RGBA)
+        .addVariable("BC3_RGBA", ColorFormat::BC3_RGBA)
+        .addVariable("BC4_R", ColorFormat::BC4_R)
+        .addVariable("BC5_RG", ColorFormat::BC5_RG)
+        .addVariable("BC7_RGBA", ColorFormat::BC7_RGBA)
+        .addVariable("ETC2_RGB8", ColorFormat::ETC2_RGB8)
+        .addVariable("ETC2_RGBA8", ColorFormat::ETC2_RGBA8)
+        .addVariable("EAC_R11", ColorFormat::EAC_R11)
+        .addVariable("EAC_RG11", ColorFormat::EAC_RG11)
+        .addVariable("ASTC_4x4_RGBA", ColorFormat::ASTC_4x4_RGBA)
         .endNamespace();
 
     luabridge::getGlobalNamespace(L)
@@ -168,6 +179,10 @@ void LuaBinding::registerCoreClasses(lua_State *L){
         .addStaticFunction("setCallTouchInMouseEvent", &Engine::setCallTouchInMouseEvent)
         .addStaticProperty("useDegrees", &Engine::isUseDegrees, &Engine::setUseDegrees)
         .addStaticProperty("automaticTransparency", &Engine::isAutomaticTransparency, &Engine::setAutomaticTransparency)
+        .addStaticProperty("automaticInstancing", &Engine::isAutomaticInstancing, &Engine::setAutomaticInstancing)
+        .addStaticProperty("asyncLoading", &Engine::isAsyncLoading, &Engine::setAsyncLoading)
+        .addStaticProperty("pipelineManifest", &Engine::getPipelineManifest, &Engine::setPipelineManifest)
+        .addStaticProperty("maxRenderBuffers", &Engine::getMaxRenderBuffers, &Engine::setMaxRenderBuffers)
         .addStaticProperty("allowEventsOutCanvas", &Engine::isAllowEventsOutCanvas, &Engine::setAllowEventsOutCanvas)
         .addStaticProperty("ignoreEventsHandledByUI", &Engine::isIgnoreEventsHandledByUI, &Engine::setIgnoreEventsHandledByUI)
         .addStaticFunction("isUIEventReceived", &Engine::isUIEventReceived)
@@ -419,6 +434,7 @@ void LuaBinding::registerCoreClasses(lua_State *L){
             luabridge::overload<float, float, float>(&Scene::setBackgroundColor),
             luabridge::overload<float, float, float, float>(&Scene::setBackgroundColor))
         .addProperty("shadowsPCF", &Scene::isShadowsPCF, &Scene::setShadowsPCF)
+        .addProperty("shadowsCache", &Scene::isShadowsCache, &Scene::setShadowsCache)
         .addProperty("ambientLightColor", &Scene::getAmbientLightColor, (void (Scene::*)(Vector3))&Scene::setAmbientLight)
         .addProperty("ambientLightFactor", &Scene::getAmbientLightFactor, (void (Scene::*)(float))&Scene::setAmbientLight)
         .addFunction("setAmbientLight", (void (Scene::*)(float, Vector3))&Scene::setAmbientLight)
@@ -30,6 +30,7 @@
 #include "component/ButtonComponent.h"
 #include "component/ParticlesComponent.h"
 #include "component/AudioComponent.h"
+#include "component/ModelComponent.h"
 #include "component/SpriteComponent.h"
 #include "component/FogComponent.h"
 #include "component/TilemapComponent.h"
@@ -570,6 +571,8 @@ void LuaBinding::registerECSClasses(lua_State *L){
         .addProperty("state", &AudioComponent::state)
         .addProperty("filename", &AudioComponent::filename)
         .addProperty("loaded", &AudioComponent::loaded)
+        .addProperty("loadState", &AudioComponent::loadState)
+        .addProperty("onLoad", [] (AudioComponent* self, lua_State* L) { return &self->onLoad; }, [] (AudioComponent* self, lua_State* L) { self->onLoad = L; })
         .addProperty("enableClocked", &AudioComponent::enableClocked)
         .addProperty("enable3D", &AudioComponent::enable3D)
         .addProperty("lastPosition", &AudioComponent::lastPosition)
@@ -596,6 +599,15 @@ void LuaBinding::registerECSClasses(lua_State *L){
         .addProperty("needUpdate", &AudioComponent::needUpdate)
         .endClass();
 
+    luabridge::getGlobalNamespace(L)
+        .beginClass<ModelComponent>("ModelComponent")
+        .addProperty("filename", &ModelComponent::filename)
+        .addProperty("loadState", &ModelComponent::loadState)
+        .addProperty("loadingFilename", &ModelComponent::loadingFilename)
+        .addProperty("flatSkeleton", &ModelComponent::flatSkeleton)
+        .addProperty("onLoad", [] (ModelComponent* self, lua_State* L) { return &self->onLoad; }, [] (ModelComponent* self, lua_State* L) { self->onLoad = L; })
+        .endClass();
+
     luabridge::getGlobalNamespace(L)
         .beginClass<TileRectData>("TileRectData")
         .addProperty("name", &TileRectData::name)
@@ -442,8 +442,12 @@ void LuaBinding::registerObjectClasses(lua_State *L){
         .addFunction("loadOBJ", &Model::loadOBJ)
         .addFunction("loadGLTF", &Model::loadGLTF)
         .addFunction("loadModel", &Model::loadModel)
+        .addFunction("loadModelAsync", &Model::loadModelAsync)
+        .addProperty("loadState", &Model::getLoadState)
+        .addFunction("getModelComponent", &Model::getComponent<ModelComponent>)
         .addFunction("getAnimation", &Model::getAnimation)
         .addFunction("findAnimation", &Model::findAnimation)
+        .addProperty("flatSkeleton", &Model::isFlatSkeleton, &Model::setFlatSkeleton)
         .addFunction("getBone", 
             luabridge::overload<int>(&Model::getBone),
             luabridge::overload<std::string>(&Model::getBone))
@@ -453,6 +457,23 @@ void LuaBinding::registerObjectClasses(lua_State *L){
         .addFunction("setMorphWeight", 
             luabridge::overload<int, float>(&Model::setMorphWeight),
             luabridge::overload<std::string, float>(&Model::setMorphWeight))
+        .addFunction("getClipIndex", &Model::getClipIndex)
+        .addFunction("playClip", 
+            luabridge::overload<int>(&Model::playClip),
+            luabridge::overload<int, float>(&Model::playClip),
+            luabridge::overload<std::string>(&Model::playClip),
+            luabridge::overload<std::string, float>(&Model::playClip))
+        .addFunction("addClipLayer", 
+            luabridge::overload<int, float, bool>(&Model::addClipLayer),
+            luabridge::overload<std::string, float, bool>(&Model::addClipLayer))
+        .addFunction("setClipLayerWeight", &Model::setClipLayerWeight)
+        .addFunction("setClipLayerSpeed", &Model::setClipLayerSpeed)
+        .addFunction("setClipLayerLoop", &Model::setClipLayerLoop)
+        .addFunction("stopClips", 
+            luabridge::overload<>(&Model::stopClips),
+            luabridge::overload<float>(&Model::stopClips))
+        .addFunction("setClipsLOD", &Model::setClipsLOD)
+        .addFunction("setClipsUpdateBones", &Model::setClipsUpdateBones)
         .endClass();
 
     luabridge::getGlobalNamespace(L)
@@ -11,6 +11,8 @@
 #include "util/Angle.h"
 #include "util/Base64.h"
 #include "util/Color.h"
+#include "util/Profiler.h"
+#include "util/AssetLoader.h"
 
 using namespace Supernova;
 
@@ -47,5 +49,35 @@ void LuaBinding::registerUtilClasses(lua_State *L){
             luabridge::overload<const float, const float, const float, const float>(&Color::sRGBToLinear))
         .endClass();
 
+    luabridge::getGlobalNamespace(L)
+        .beginClass<Profiler>("Profiler")
+        .addStaticProperty("enabled", &Profiler::isEnabled, &Profiler::setEnabled)
+        .addStaticFunction("setThreadName", &Profiler::setThreadName)
+        .addStaticFunction("getFrameTimes", &Profiler::getFrameTimes)
+        .addStaticFunction("getFrameCallCounts", &Profiler::getFrameCallCounts)
+        .addStaticFunction("getFrameTime", &Profiler::getFrameTime)
+        .addStaticFunction("getFrameCalls", &Profiler::getFrameCalls)
+        .addStaticFunction("getLostEvents", &Profiler::getLostEvents)
+        .addStaticFunction("startCapture", &Profiler::startCapture)
+        .addStaticFunction("stopCapture", &Profiler::stopCapture)
+        .addStaticFunction("isCapturing", &Profiler::isCapturing)
+        .addStaticFunction("saveCapture", &Profiler::saveCapture)
+        .endClass();
+
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("AssetLoadState")
+        .addVariable("NONE", AssetLoadState::NONE)
+        .addVariable("LOADING", AssetLoadState::LOADING)
+        .addVariable("LOADED", AssetLoadState::LOADED)
+        .addVariable("FAILED", AssetLoadState::FAILED)
+        .endNamespace();
+
+    luabridge::getGlobalNamespace(L)
+        .beginClass<AssetLoader>("AssetLoader")
+        .addStaticFunction("isRunning", &AssetLoader::isRunning)
+        .addStaticFunction("getNumTasks", &AssetLoader::getNumTasks)
+        .addStaticFunction("finish", &AssetLoader::finish)
+        .endClass();
+
 #endif //DISABLE_LUA_BINDINGS
 }
\ No newline at end of file
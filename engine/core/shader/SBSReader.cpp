@@ -158,7 +158,7 @@ SBSReader::SBSReader(){
 SBSReader::~SBSReader(){
     for (int i = 0; i < shaderData.stages.size(); i++){
         if (shaderData.stages[i].bytecode.data)
-            delete shaderData.stages[i].bytecode.data;
+            delete[] shaderData.stages[i].bytecode.data;
     }
 }
 
@@ -173,10 +173,15 @@ bool SBSReader::read(std::string filepath){
     return read(file);
 }
 
-bool SBSReader::read(std::vector<unsigned char> datashader){
+bool SBSReader::read(const std::vector<unsigned char>& datashader){
+    return read(datashader.data(), datashader.size());
+}
+
+bool SBSReader::read(const unsigned char* datashader, size_t size){
     Data data;
 
-    if (data.open(&(datashader.front()), datashader.size(), false, false) != FileErrors::FILEDATA_OK){
+    // not copied and not owned, Data only reads from it
+    if (data.open(const_cast<unsigned char*>(datashader), (unsigned int)size, false, false) != FileErrors::FILEDATA_OK){
         Log::error("Cannot read SBS file");
         return false;
     }
@@ -242,7 +247,7 @@ bool SBSReader::read(FileData& file){
         }else if (code == SBS_CHUNK_DATA){
             shaderStage->bytecode.data = new unsigned char[codeSize];
             shaderStage->bytecode.size = codeSize;
-            file.read((unsigned char*)&shaderStage->bytecode.data, codeSize);
+            file.read(shaderStage->bytecode.data, codeSize);
         }
 
         uint32_t refl = file.read32();
@@ -22,7 +22,9 @@ namespace Supernova {
         virtual ~SBSReader();
 
         bool read(std::string filepath);
-        bool read(std::vector<unsigned char> datashader);
+        bool read(const std::vector<unsigned char>& datashader);
+        // memory is only read, not copied
+        bool read(const unsigned char* datashader, size_t size);
 
         ShaderData& getShaderData();
     };
@@ -0,0 +1,105 @@
+//
+// (c) 2024 Eduardo Doria.
+//
+
+#include "ShaderArchive.h"
+
+#include "Log.h"
+#include <cstring>
+
+#define SHADERARCHIVE_MAGIC 0x41534E53 // "SNSA"
+#define SHADERARCHIVE_VERSION 1
+#define SHADERARCHIVE_HEADER_SIZE 16
+#define SHADERARCHIVE_SLOT_SIZE 16
+
+using namespace Supernova;
+
+static uint32_t readArchiveUint32(const unsigned char* data){
+    uint32_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+static uint64_t readArchiveUint64(const unsigned char* data){
+    uint64_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+// same hash of tools/supershader.py
+static uint32_t getArchiveSlot(uint64_t key, uint32_t tableSize){
+    return (uint32_t)((key * 0x9E3779B97F4A7C15ull) >> 32) & (tableSize - 1);
+}
+
+ShaderArchive::ShaderArchive(){
+    this->data = nullptr;
+    this->size = 0;
+    this->numShaders = 0;
+    this->tableSize = 0;
+}
+
+bool ShaderArchive::open(const unsigned char* data, size_t size){
+    this->data = nullptr;
+
+    if (!data || size < SHADERARCHIVE_HEADER_SIZE || readArchiveUint32(data) != SHADERARCHIVE_MAGIC){
+        Log::error("Invalid shader archive format");
+        return false;
+    }
+
+    if (readArchiveUint32(data + 4) != SHADERARCHIVE_VERSION){
+        Log::error("Invalid shader archive version");
+        return false;
+    }
+
+    uint32_t tableSize = readArchiveUint32(data + 12);
+    if (tableSize == 0 || (tableSize & (tableSize - 1)) != 0 || SHADERARCHIVE_HEADER_SIZE + (size_t)tableSize * SHADERARCHIVE_SLOT_SIZE > size){
+        Log::error("Invalid shader archive table");
+        return false;
+    }
+
+    this->data = data;
+    this->size = size;
+    this->numShaders = readArchiveUint32(data + 8);
+    this->tableSize = tableSize;
+
+    return true;
+}
+
+bool ShaderArchive::isOpen() const{
+    return (data != nullptr);
+}
+
+uint32_t ShaderArchive::getNumShaders() const{
+    return numShaders;
+}
+
+bool ShaderArchive::find(uint64_t key, const unsigned char*& shaderData, size_t& shaderSize) const{
+    if (!data)
+        return false;
+
+    uint32_t slot = getArchiveSlot(key, tableSize);
+
+    for (uint32_t i = 0; i < tableSize; i++){
+        const unsigned char* entry = data + SHADERARCHIVE_HEADER_SIZE + (size_t)slot * SHADERARCHIVE_SLOT_SIZE;
+
+        uint32_t entrySize = readArchiveUint32(entry + 12);
+        if (entrySize == 0)
+            return false;
+
+        if (readArchiveUint64(entry) == key){
+            uint32_t entryOffset = readArchiveUint32(entry + 8);
+            if ((size_t)entryOffset + entrySize > size){
+                Log::error("Invalid shader archive entry");
+                return false;
+            }
+
+            shaderData = data + entryOffset;
+            shaderSize = entrySize;
+            return true;
+        }
+
+        slot = (slot + 1) & (tableSize - 1);
+    }
+
+    return false;
+}
@@ -0,0 +1,39 @@
+//
+// (c) 2024 Eduardo Doria.
+//
+
+#ifndef SHADERARCHIVE_H
+#define SHADERARCHIVE_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Supernova {
+
+    // Read-only view of a packed archive of SBS shaders created by tools/supershader.py.
+    // Layout (little endian):
+    //   header: magic "SNSA", version, number of shaders, table size (power of two)
+    //   table:  slots of {uint64 key, uint32 offset, uint32 size}, open addressing by key hash, size 0 is empty
+    //   data:   SBS payloads, offsets are relative to archive start
+    // Archive memory is not copied and must live while it is used.
+    class ShaderArchive {
+    private:
+        const unsigned char* data;
+        size_t size;
+        uint32_t numShaders;
+        uint32_t tableSize;
+
+    public:
+        ShaderArchive();
+
+        bool open(const unsigned char* data, size_t size);
+        bool isOpen() const;
+
+        uint32_t getNumShaders() const;
+
+        bool find(uint64_t key, const unsigned char*& shaderData, size_t& shaderSize) const;
+    };
+
+}
+
+#endif //SHADERARCHIVE_H
@@ -8,12 +8,17 @@
 #include "util/Color.h"
 #include "util/Angle.h"
 #include "subsystem/MeshSystem.h"
+#include "util/JobSystem.h"
+#include "util/Profiler.h"
+#include <cmath>
 
 using namespace Supernova;
 
 
 ActionSystem::ActionSystem(Scene* scene): SubSystem(scene){
     signature.set(scene->getComponentType<ActionComponent>());
+
+    updateCount = 0;
 }
 
 void ActionSystem::actionStart(Entity entity){
@@ -819,7 +824,10 @@ void ActionSystem::keyframeUpdate(double dt, ActionComponent& action, KeyframeTr
 
     keyframe.interpolation = 0;
 
-    keyframe.index = 0;
+    // continues from last key, unless time is back
+    if (keyframe.index >= keyframe.times.size() || (keyframe.index > 0 && keyframe.times[keyframe.index-1] >= currentTime)){
+        keyframe.index = 0;
+    }
     while (keyframe.index < (keyframe.times.size()-1) && keyframe.times[keyframe.index] < currentTime){
         keyframe.index++;
     }
@@ -870,21 +878,283 @@ void ActionSystem::rotateTracksUpdate(KeyframeTracksComponent& keyframe, RotateT
     transform.needUpdate = true;
 }
 
-void ActionSystem::morphTracksUpdate(KeyframeTracksComponent& keyframe, MorphTracksComponent& morpthtracks, MeshComponent& mesh){
-    std::vector<float> previousMorph = morpthtracks.values[0];
-    if (keyframe.index > 0){
-        previousMorph = morpthtracks.values[keyframe.index-1];
-    }
+void ActionSystem::morphTracksUpdate(KeyframeTracksComponent& keyframe, MorphTracksComponent& morpthtracks, MorphTargetComponent& morphtarget){
+    const std::vector<float>& previousMorph = (keyframe.index > 0) ? morpthtracks.values[keyframe.index-1] : morpthtracks.values[0];
 
     if ((keyframe.index == 0) || (morpthtracks.values[keyframe.index].size() == morpthtracks.values[keyframe.index-1].size())) {
         for (int morphIndex = 0; morphIndex < morpthtracks.values[keyframe.index].size(); morphIndex++) {
-            mesh.morphWeights[morphIndex] = previousMorph[morphIndex] + keyframe.interpolation * (morpthtracks.values[keyframe.index][morphIndex] - previousMorph[morphIndex]);
+            if (morphIndex < MAX_MORPHTARGETS)
+                morphtarget.morphWeights[morphIndex] = previousMorph[morphIndex] + keyframe.interpolation * (morpthtracks.values[keyframe.index][morphIndex] - previousMorph[morphIndex]);
         }
     }else{
         Log::error("MorphTrack of index %i is different size than index %i", keyframe.index, keyframe.index-1);
     }
 }
 
+unsigned int ActionSystem::getSkeletalAnimationInterval(SkeletalAnimationComponent& skeletal, Entity entity, CameraComponent* camera){
+    Transform* transform = scene->findComponent<Transform>(entity);
+    MeshComponent* mesh = scene->findComponent<MeshComponent>(entity);
+
+    if (!camera || camera->type != CameraType::CAMERA_PERSPECTIVE || !transform || !mesh || !mesh->worldAABB.isFinite() || transform->distanceToCamera <= 0){
+        return 1;
+    }
+
+    Vector3 size = mesh->worldAABB.getSize();
+    float height = std::max(size.x, std::max(size.y, size.z));
+    float screenSize = height / (2.0f * transform->distanceToCamera * tan(camera->yfov / 2.0f));
+
+    if (screenSize >= skeletal.lodScreenSizes[0]){
+        return 1;
+    }else if (screenSize >= skeletal.lodScreenSizes[1]){
+        return 2;
+    }
+
+    return 4;
+}
+
+bool ActionSystem::sampleSkeletalClip(SkeletalAnimationComponent& skeletal, const SkeletonData& skeleton, SkeletalAnimationLayer& layer){
+    const SkeletalClip& clip = skeletal.data->clips[layer.clip];
+
+    // joints without tracks stay in bind pose
+    std::copy(skeleton.bindPosition.begin(), skeleton.bindPosition.end(), skeletal.layerPosition.begin());
+    std::copy(skeleton.bindRotation.begin(), skeleton.bindRotation.end(), skeletal.layerRotation.begin());
+    std::copy(skeleton.bindScale.begin(), skeleton.bindScale.end(), skeletal.layerScale.begin());
+
+    size_t numTracks = clip.trackJoint.size();
+    if (layer.cursors.size() != numTracks){
+        layer.cursors.assign(numTracks, 0);
+    }
+
+    bool hasWeights = false;
+
+    for (size_t t = 0; t < numTracks; t++){
+        const float* times = &clip.times[clip.trackKeysOffset[t]];
+        const float* values = &clip.values[clip.trackValuesOffset[t]];
+        uint32_t count = clip.trackKeysCount[t];
+        uint32_t size = clip.trackValuesSize[t];
+
+        // first key at or after time, continues from last sample
+        uint32_t& cursor = layer.cursors[t];
+        if (cursor >= count || (cursor > 0 && times[cursor-1] >= layer.time)){
+            cursor = 0;
+        }
+        while (cursor < (count-1) && times[cursor] < layer.time){
+            cursor++;
+        }
+
+        uint32_t previous = (cursor > 0) ? cursor - 1 : 0;
+        float interpolation = 0;
+        if (times[cursor] > times[previous]){
+            interpolation = std::min(1.0f, std::max(0.0f, (layer.time - times[previous]) / (times[cursor] - times[previous])));
+        }
+
+        const float* v0 = values + (previous * size);
+        const float* v1 = values + (cursor * size);
+        int joint = clip.trackJoint[t];
+
+        switch (clip.trackPath[t]){
+            case SkeletalTrackPath::TRANSLATION:
+                skeletal.layerPosition[joint] = Vector3(v0[0] + interpolation * (v1[0] - v0[0]), v0[1] + interpolation * (v1[1] - v0[1]), v0[2] + interpolation * (v1[2] - v0[2]));
+                break;
+            case SkeletalTrackPath::ROTATION:
+                skeletal.layerRotation[joint] = Quaternion::slerp(interpolation, Quaternion(v0[0], v0[1], v0[2], v0[3]), Quaternion(v1[0], v1[1], v1[2], v1[3]));
+                break;
+            case SkeletalTrackPath::SCALE:
+                skeletal.layerScale[joint] = Vector3(v0[0] + interpolation * (v1[0] - v0[0]), v0[1] + interpolation * (v1[1] - v0[1]), v0[2] + interpolation * (v1[2] - v0[2]));
+                break;
+            case SkeletalTrackPath::WEIGHTS:
+                for (uint32_t m = 0; m < size && m < MAX_MORPHTARGETS; m++){
+                    skeletal.layerWeights[m] = v0[m] + interpolation * (v1[m] - v0[m]);
+                }
+                hasWeights = true;
+                break;
+        }
+    }
+
+    return hasWeights;
+}
+
+void ActionSystem::skeletalAnimationUpdate(float dt, SkeletalAnimationComponent& skeletal, ModelComponent& model, MorphTargetComponent* morphtarget){
+    const SkeletalAnimationData& data = *skeletal.data;
+    const SkeletonData& skeleton = *model.skeletonData;
+    size_t numJoints = skeleton.jointNode.size();
+
+    for (auto it = skeletal.layers.begin(); it != skeletal.layers.end();){
+        SkeletalAnimationLayer& layer = *it;
+        float duration = data.clips[layer.clip].duration;
+
+        layer.time += dt * layer.speed;
+        if (layer.loop && duration > 0){
+            layer.time = fmod(layer.time, duration);
+            if (layer.time < 0)
+                layer.time += duration;
+        }else{
+            layer.time = std::min(duration, std::max(0.0f, layer.time));
+        }
+
+        if (layer.fadeSpeed > 0){
+            float step = layer.fadeSpeed * dt;
+            if (fabs(layer.targetWeight - layer.weight) <= step){
+                layer.weight = layer.targetWeight;
+                layer.fadeSpeed = 0;
+            }else{
+                layer.weight += (layer.targetWeight > layer.weight) ? step : -step;
+            }
+        }
+
+        // faded out
+        if (layer.removeOnFadeOut && layer.weight <= 0 && layer.targetWeight <= 0){
+            it = skeletal.layers.erase(it);
+        }else{
+            ++it;
+        }
+    }
+
+    // blend of layers, remaining weight is bind pose
+    float totalWeight = 0;
+    float totalMorphWeight = 0;
+    for (SkeletalAnimationLayer& layer : skeletal.layers){
+        if (layer.additive || layer.weight <= 0)
+            continue;
+
+        float w = layer.weight;
+        bool hasWeights = sampleSkeletalClip(skeletal, skeleton, layer);
+
+        if (totalWeight == 0){
+            for (size_t j = 0; j < numJoints; j++){
+                model.jointPosition[j] = skeletal.layerPosition[j] * w;
+                model.jointRotation[j] = skeletal.layerRotation[j] * w;
+                model.jointScale[j] = skeletal.layerScale[j] * w;
+            }
+        }else{
+            for (size_t j = 0; j < numJoints; j++){
+                Quaternion rotation = skeletal.layerRotation[j];
+                if (model.jointRotation[j].dot(rotation) < 0)
+                    rotation = -rotation;
+
+                model.jointPosition[j] += skeletal.layerPosition[j] * w;
+                model.jointRotation[j] = model.jointRotation[j] + rotation * w;
+                model.jointScale[j] += skeletal.layerScale[j] * w;
+            }
+        }
+        totalWeight += w;
+
+        if (hasWeights){
+            for (int m = 0; m < MAX_MORPHTARGETS; m++){
+                skeletal.poseWeights[m] = ((totalMorphWeight == 0) ? 0 : skeletal.poseWeights[m]) + skeletal.layerWeights[m] * w;
+            }
+            totalMorphWeight += w;
+        }
+    }
+
+    if (totalWeight == 0){
+        std::copy(skeleton.bindPosition.begin(), skeleton.bindPosition.end(), model.jointPosition.begin());
+        std::copy(skeleton.bindRotation.begin(), skeleton.bindRotation.end(), model.jointRotation.begin());
+        std::copy(skeleton.bindScale.begin(), skeleton.bindScale.end(), model.jointScale.begin());
+    }else{
+        float bindWeight = std::max(0.0f, 1.0f - totalWeight);
+        float normalize = 1.0f / std::max(1.0f, totalWeight);
+
+        for (size_t j = 0; j < numJoints; j++){
+            Quaternion rotation = skeleton.bindRotation[j];
+            if (model.jointRotation[j].dot(rotation) < 0)
+                rotation = -rotation;
+
+            model.jointPosition[j] = (model.jointPosition[j] + skeleton.bindPosition[j] * bindWeight) * normalize;
+            model.jointRotation[j] = model.jointRotation[j] + rotation * bindWeight;
+            model.jointRotation[j].normalize();
+            model.jointScale[j] = (model.jointScale[j] + skeleton.bindScale[j] * bindWeight) * normalize;
+        }
+    }
+
+    if (totalMorphWeight > 0){
+        for (int m = 0; m < MAX_MORPHTARGETS; m++){
+            skeletal.poseWeights[m] /= std::max(1.0f, totalMorphWeight);
+        }
+    }
+
+    // additive layers are difference from bind pose
+    for (SkeletalAnimationLayer& layer : skeletal.layers){
+        if (!layer.additive || layer.weight <= 0)
+            continue;
+
+        float w = layer.weight;
+        bool hasWeights = sampleSkeletalClip(skeletal, skeleton, layer);
+
+        for (size_t j = 0; j < numJoints; j++){
+            Quaternion delta = skeleton.bindRotation[j].inverse() * skeletal.layerRotation[j];
+
+            model.jointPosition[j] += (skeletal.layerPosition[j] - skeleton.bindPosition[j]) * w;
+            model.jointRotation[j] = model.jointRotation[j] * Quaternion::nlerp(w, Quaternion(), delta, true);
+
+            const Vector3& bindScale = skeleton.bindScale[j];
+            const Vector3& scale = skeletal.layerScale[j];
+            model.jointScale[j].x *= 1.0f + w * ((bindScale.x != 0) ? (scale.x / bindScale.x - 1.0f) : 0.0f);
+            model.jointScale[j].y *= 1.0f + w * ((bindScale.y != 0) ? (scale.y / bindScale.y - 1.0f) : 0.0f);
+            model.jointScale[j].z *= 1.0f + w * ((bindScale.z != 0) ? (scale.z / bindScale.z - 1.0f) : 0.0f);
+        }
+
+        if (hasWeights){
+            for (int m = 0; m < MAX_MORPHTARGETS; m++){
+                skeletal.poseWeights[m] += skeletal.layerWeights[m] * w;
+            }
+            totalMorphWeight += w;
+        }
+    }
+
+    if (morphtarget && totalMorphWeight > 0){
+        memcpy(morphtarget->morphWeights, skeletal.poseWeights, sizeof(skeletal.poseWeights));
+    }
+}
+
+void ActionSystem::skeletalAnimationsUpdate(double dt){
+    auto skeletals = scene->getComponentArray<SkeletalAnimationComponent>();
+    if (skeletals->size() == 0)
+        return;
+
+    PROFILE_ZONE("ActionSystem::skeletalAnimationsUpdate");
+
+    updateCount++;
+
+    CameraComponent* camera = scene->findComponent<CameraComponent>(scene->getCamera());
+    std::shared_ptr<MeshSystem> meshSystem = scene->getSystem<MeshSystem>();
+
+    skeletalUpdates.clear();
+    for (int i = 0; i < skeletals->size(); i++){
+        SkeletalAnimationComponent& skeletal = skeletals->getComponentFromIndex(i);
+        Entity entity = skeletals->getEntity(i);
+        ModelComponent* model = scene->findComponent<ModelComponent>(entity);
+
+        if (!skeletal.data || skeletal.layers.empty() || !model || !model->skeletonData)
+            continue;
+
+        // small models are updated in less frames, spread by entity
+        skeletal.updateInterval = getSkeletalAnimationInterval(skeletal, entity, camera);
+        skeletal.elapsedTime += dt;
+        if (((updateCount + entity) % skeletal.updateInterval) != 0)
+            continue;
+
+        skeletalUpdates.push_back({&skeletal, model, scene->findComponent<SkinningComponent>(entity), scene->findComponent<MorphTargetComponent>(entity), skeletal.elapsedTime});
+        skeletal.elapsedTime = 0;
+    }
+
+    JobSystem::parallelFor(skeletalUpdates.size(), 4, [&](size_t start, size_t end){
+        for (size_t i = start; i < end; i++){
+            const SkeletalAnimationUpdate& update = skeletalUpdates[i];
+
+            skeletalAnimationUpdate(update.dt, *update.skeletal, *update.model, update.morphtarget);
+            meshSystem->updateSkeleton(*update.model, update.skinning);
+        }
+    });
+
+    // bone entities are only for objects attached to them, flat skeletons only have the requested ones
+    for (const SkeletalAnimationUpdate& update : skeletalUpdates){
+        if (update.model->flatSkeleton || update.skeletal->updateBones){
+            meshSystem->updateJointEntities(*update.model);
+        }
+    }
+}
+
 void ActionSystem::load(){
 
 }
@@ -933,24 +1203,16 @@ void ActionSystem::actionStateChange(Entity entity, ActionComponent& action){
 
 void ActionSystem::update(double dt){
 
-    //Animations actions
-    auto animations = scene->getComponentArray<AnimationComponent>();
-    for (int i = 0; i < animations->size(); i++){
-        AnimationComponent& animcomp = animations->getComponentFromIndex(i);
-
-        Entity entity = animations->getEntity(i);
-        Signature signature = scene->getSignature(entity);
+    skeletalAnimationsUpdate(dt);
 
-        if (signature.test(scene->getComponentType<ActionComponent>())){
-            ActionComponent& action = scene->getComponent<ActionComponent>(entity);
-
-            actionStateChange(entity, action);
+    //Animations actions
+    scene->view<AnimationComponent, ActionComponent>().each([&](Entity entity, AnimationComponent& animcomp, ActionComponent& action){
+        actionStateChange(entity, action);
 
-            if (action.state == ActionState::Running){
-                animationUpdate(dt, entity, action, animcomp);
-            }
+        if (action.state == ActionState::Running){
+            animationUpdate(dt, entity, action, animcomp);
         }
-    }
+    });
 
     //All actions
     auto actions = scene->getComponentArray<ActionComponent>();
@@ -1013,6 +1275,8 @@ void ActionSystem::update(double dt){
                         Transform& transform = scene->getComponent<Transform>(action.target);
 
                         translateTracksUpdate(keyframe, translatetracks, transform);
+
+                        scene->markTransformDirty(action.target);
                     }
                 }
 
@@ -1023,6 +1287,8 @@ void ActionSystem::update(double dt){
                         Transform& transform = scene->getComponent<Transform>(action.target);
 
                         rotateTracksUpdate(keyframe, rotatetracks, transform);
+
+                        scene->markTransformDirty(action.target);
                     }
                 }
 
@@ -1033,16 +1299,18 @@ void ActionSystem::update(double dt){
                         Transform& transform = scene->getComponent<Transform>(action.target);
 
                         scaleTracksUpdate(keyframe, scaletracks, transform);
+
+                        scene->markTransformDirty(action.target);
                     }
                 }
 
                 if (signature.test(scene->getComponentType<MorphTracksComponent>())){
                     MorphTracksComponent& morpthtracks = scene->getComponent<MorphTracksComponent>(entity);
 
-                    if (targetSignature.test(scene->getComponentType<MeshComponent>())){
-                        MeshComponent& mesh = scene->getComponent<MeshComponent>(action.target);
+                    if (targetSignature.test(scene->getComponentType<MorphTargetComponent>())){
+                        MorphTargetComponent& morphtarget = scene->getComponent<MorphTargetComponent>(action.target);
 
-                        morphTracksUpdate(keyframe, morpthtracks, mesh);
+                        morphTracksUpdate(keyframe, morpthtracks, morphtarget);
                     }
                 }
             }
@@ -1062,18 +1330,24 @@ void ActionSystem::update(double dt){
                         PositionActionComponent& posaction = scene->getComponent<PositionActionComponent>(entity);
 
                         positionActionUpdate(dt, action, timedaction, posaction, transform);
+
+                        scene->markTransformDirty(action.target);
                     }
 
                     if (signature.test(scene->getComponentType<RotationActionComponent>())){
                         RotationActionComponent& rotaction = scene->getComponent<RotationActionComponent>(entity);
 
                         rotationActionUpdate(dt, action, timedaction, rotaction, transform);
+
+                        scene->markTransformDirty(action.target);
                     }
 
                     if (signature.test(scene->getComponentType<ScaleActionComponent>())){
                         ScaleActionComponent& scaleaction = scene->getComponent<ScaleActionComponent>(entity);
 
                         scaleActionUpdate(dt, action, timedaction, scaleaction, transform);
+
+                        scene->markTransformDirty(action.target);
                     }
                 }
 
@@ -29,12 +29,29 @@
 #include "component/RotateTracksComponent.h"
 #include "component/ScaleTracksComponent.h"
 #include "component/MorphTracksComponent.h"
+#include "component/MorphTargetComponent.h"
+#include "component/SkinningComponent.h"
+#include "component/SkeletalAnimationComponent.h"
+#include "component/ModelComponent.h"
+#include "component/CameraComponent.h"
+#include <vector>
 
 namespace Supernova{
 
 	class ActionSystem : public SubSystem {
 
     private:
+		// skeletal animation sampled by one job
+		struct SkeletalAnimationUpdate{
+			SkeletalAnimationComponent* skeletal;
+			ModelComponent* model;
+			SkinningComponent* skinning;
+			MorphTargetComponent* morphtarget;
+			float dt;
+		};
+
+		std::vector<SkeletalAnimationUpdate> skeletalUpdates;
+		uint64_t updateCount;
 
 		void actionStateChange(Entity entity, ActionComponent& action);
 
@@ -96,7 +113,13 @@ namespace Supernova{
 		void translateTracksUpdate(KeyframeTracksComponent& keyframe, TranslateTracksComponent& translatetracks, Transform& transform);
 		void scaleTracksUpdate(KeyframeTracksComponent& keyframe, ScaleTracksComponent& scaletracks, Transform& transform);
 		void rotateTracksUpdate(KeyframeTracksComponent& keyframe, RotateTracksComponent& rotatetracks, Transform& transform);
-		void morphTracksUpdate(KeyframeTracksComponent& keyframe, MorphTracksComponent& morpthtracks, MeshComponent& mesh);
+		void morphTracksUpdate(KeyframeTracksComponent& keyframe, MorphTracksComponent& morpthtracks, MorphTargetComponent& morphtarget);
+
+		//Skeletal animation
+		unsigned int getSkeletalAnimationInterval(SkeletalAnimationComponent& skeletal, Entity entity, CameraComponent* camera);
+		bool sampleSkeletalClip(SkeletalAnimationComponent& skeletal, const SkeletonData& skeleton, SkeletalAnimationLayer& layer);
+		void skeletalAnimationUpdate(float dt, SkeletalAnimationComponent& skeletal, ModelComponent& model, MorphTargetComponent* morphtarget);
+		void skeletalAnimationsUpdate(double dt);
 
 	public:
 		ActionSystem(Scene* scene);
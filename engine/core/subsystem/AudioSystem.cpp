@@ -20,6 +20,10 @@ float AudioSystem::globalVolume = 1.0;
 AudioSystem::AudioSystem(Scene* scene): SubSystem(scene){
     signature.set(scene->getComponentType<AudioComponent>());
 
+    readComponents.set(scene->getComponentType<CameraComponent>());
+    writeComponents.set(scene->getComponentType<AudioComponent>());
+    readWorldTransform = true;
+
     cameraLastPosition = Vector3(0, 0, 0);
 }
 
@@ -50,31 +54,36 @@ void AudioSystem::deInit(){
     }
 }
 
-bool AudioSystem::loadAudio(AudioComponent& audio, Entity entity){
+bool AudioSystem::loadSample(SoLoud::Wav& sample, const std::string& filename){
     Data filedata;
 
-    if (filedata.open(audio.filename.c_str()) != FileErrors::FILEDATA_OK){
-        Log::error("Audio file not found: %s", audio.filename.c_str());
+    if (filedata.open(filename.c_str()) != FileErrors::FILEDATA_OK){
+        Log::error("Audio file not found: %s", filename.c_str());
         return false;
     }
 
-    if (!audio.sample){
-        audio.sample = new SoLoud::Wav();
-    }
-
-    SoLoud::result res = audio.sample->loadMem(filedata.getMemPtr(), filedata.length(), false, false);
+    SoLoud::result res = sample.loadMem(filedata.getMemPtr(), filedata.length(), false, false);
 
     if (res == SoLoud::SOLOUD_ERRORS::FILE_LOAD_FAILED){
-        Log::error("Audio file type of '%s' could not be loaded", audio.filename.c_str());
+        Log::error("Audio file type of '%s' could not be loaded", filename.c_str());
         return false;
     }else if (res == SoLoud::SOLOUD_ERRORS::OUT_OF_MEMORY){
-        Log::error("Out of memory when loading '%s'", audio.filename.c_str());
+        Log::error("Out of memory when loading '%s'", filename.c_str());
         return false;
     }else if (res == SoLoud::SOLOUD_ERRORS::UNKNOWN_ERROR){
-        Log::error("Unknown error when loading '%s'", audio.filename.c_str());
+        Log::error("Unknown error when loading '%s'", filename.c_str());
         return false;
     }
 
+    return true;
+}
+
+void AudioSystem::setupSample(AudioComponent& audio, SoLoud::Wav* sample){
+    if (audio.sample && audio.sample != sample){
+        delete audio.sample;
+    }
+    audio.sample = sample;
+
     audio.sample->setSingleInstance(true);
     audio.sample->setVolume(1.0);
 
@@ -83,11 +92,60 @@ bool AudioSystem::loadAudio(AudioComponent& audio, Entity entity){
     init();
 
     audio.loaded = true;
+    audio.loadState = AssetLoadState::LOADED;
+}
+
+bool AudioSystem::loadAudio(AudioComponent& audio, Entity entity){
+    if (!audio.sample){
+        audio.sample = new SoLoud::Wav();
+    }
+
+    if (!loadSample(*audio.sample, audio.filename)){
+        audio.loadState = AssetLoadState::FAILED;
+        return false;
+    }
+
+    setupSample(audio, audio.sample);
+
+    return true;
+}
+
+bool AudioSystem::loadAudioAsync(AudioComponent& audio, Entity entity){
+    if (audio.loadState == AssetLoadState::LOADING){
+        AssetLoader::cancel(audio.loadTask);
+    }
+
+    audio.loadState = AssetLoadState::LOADING;
+
+    // sample is deleted with task if it is canceled
+    std::shared_ptr<std::unique_ptr<SoLoud::Wav>> sample = std::make_shared<std::unique_ptr<SoLoud::Wav>>(new SoLoud::Wav());
+    std::string filename = audio.filename;
+
+    audio.loadTask = AssetLoader::load([sample, filename](){
+        return loadSample(**sample, filename);
+    }, [this, entity, sample, filename](bool success){
+        // component could be destroyed or changed while loading
+        AudioComponent* audio = scene->findComponent<AudioComponent>(entity);
+        if (!audio || audio->loadState != AssetLoadState::LOADING || audio->filename != filename)
+            return;
+
+        if (success){
+            setupSample(*audio, sample->release());
+        }else{
+            audio->loadState = AssetLoadState::FAILED;
+        }
+
+        audio->onLoad.call(success);
+    });
 
     return true;
 }
 
 void AudioSystem::destroyAudio(AudioComponent& audio){
+    if (audio.loadState == AssetLoadState::LOADING){
+        AssetLoader::cancel(audio.loadTask);
+    }
+    audio.loadState = AssetLoadState::NONE;
     audio.loaded = false;
     if (audio.sample){
         delete audio.sample;
@@ -164,7 +222,11 @@ void AudioSystem::update(double dt){
 
         if (audio.state == AudioState::Playing || audio.startTrigger){
             if (!audio.loaded){
-                loadAudio(audio, entity);
+                if (!Engine::isAsyncLoading()){
+                    loadAudio(audio, entity);
+                }else if (audio.loadState == AssetLoadState::NONE){
+                    loadAudioAsync(audio, entity);
+                }
             }
         }
 
@@ -273,6 +335,11 @@ void AudioSystem::draw(){
 
 }
 
+bool AudioSystem::isConcurrentUpdate(){
+    // SoLoud calls are locked by its own mutex and onLoad is only called by AssetLoader
+    return true;
+}
+
 void AudioSystem::entityDestroyed(Entity entity){
     Signature signature = scene->getSignature(entity);
 
@@ -26,6 +26,9 @@ namespace Supernova{
 
 		static float globalVolume;
 
+		static bool loadSample(SoLoud::Wav& sample, const std::string& filename);
+		void setupSample(AudioComponent& audio, SoLoud::Wav* sample);
+
 		Vector3 cameraLastPosition;
 
 	public:
@@ -40,6 +43,8 @@ namespace Supernova{
 		static float getGlobalVolume();
 
         bool loadAudio(AudioComponent& audio, Entity entity);
+		// file is decoded in AssetLoader thread, AudioComponent::onLoad is called when loaded
+		bool loadAudioAsync(AudioComponent& audio, Entity entity);
 		void destroyAudio(AudioComponent& audio);
 		bool seekAudio(AudioComponent& audio, double time);
 
@@ -48,6 +53,8 @@ namespace Supernova{
         virtual void update(double dt);
 		virtual void draw();
 
+		virtual bool isConcurrentUpdate();
+
 		virtual void entityDestroyed(Entity entity);
 	};
 
@@ -9,11 +9,15 @@
 #include "buffer/InterleavedBuffer.h"
 #include "io/FileData.h"
 #include "io/Data.h"
+#include "pool/ModelPool.h"
+#include "util/Profiler.h"
 
-#include <sstream>
 #include "tiny_obj_loader.h"
 #include "tiny_gltf.h"
 
+#include <algorithm>
+#include <cfloat>
+
 using namespace Supernova;
 
 
@@ -397,14 +401,21 @@ std::vector<float> MeshSystem::buildUnitCircleVertices(float slices){
 }
 
 std::string MeshSystem::readFileToString(const char* filename){
-    Data filedata;
+    File file;
 
-    if (filedata.open(filename) != FileErrors::FILEDATA_OK){
+    if (file.open(filename) != FileErrors::FILEDATA_OK){
         Log::error("Model file not found: %s", filename);
         return "";
     }
-    filedata.seek(0);
-    return filedata.readString(filedata.length());
+
+    // read directly to string memory, without intermediate buffer
+    std::string str;
+    str.resize(file.length());
+    if (str.size() > 0){
+        str.resize(file.read((unsigned char*)&str[0], (unsigned int)str.size()));
+    }
+
+    return str;
 }
 
 bool MeshSystem::fileExists(const std::string &abs_filename, void *) {
@@ -419,9 +430,9 @@ bool MeshSystem::fileExists(const std::string &abs_filename, void *) {
 }
 
 bool MeshSystem::readWholeFile(std::vector<unsigned char> *out, std::string *err, const std::string &filepath, void *) {
-    Data filedata;
+    File file;
 
-    if (filedata.open(filepath.c_str()) != FileErrors::FILEDATA_OK){
+    if (file.open(filepath.c_str()) != FileErrors::FILEDATA_OK){
         if (err) {
             (*err) += "File open error : " + filepath + "\n";
         }
@@ -429,19 +440,7 @@ bool MeshSystem::readWholeFile(std::vector<unsigned char> *out, std::string *err
         return false;
     }
 
-    filedata.seek(0);
-    std::istringstream f(filedata.readString(filedata.length()));
-
-    if (!f) {
-        if (err) {
-            (*err) += "File open error : " + filepath + "\n";
-        }
-        return false;
-    }
-
-    f.seekg(0, f.end);
-    size_t sz = static_cast<size_t>(f.tellg());
-    f.seekg(0, f.beg);
+    size_t sz = static_cast<size_t>(file.length());
 
     if (int(sz) < 0) {
         if (err) {
@@ -456,10 +455,14 @@ bool MeshSystem::readWholeFile(std::vector<unsigned char> *out, std::string *err
         return false;
     }
 
+    // read directly to loader memory, without intermediate buffers
     out->resize(sz);
-    f.read(reinterpret_cast<char *>(&out->at(0)),
-           static_cast<std::streamsize>(sz));
-    //f.close();
+    if (file.read(&out->at(0), (unsigned int)sz) != sz){
+        if (err) {
+            (*err) += "File read error : " + filepath + "\n";
+        }
+        return false;
+    }
 
     return true;
 }
@@ -467,9 +470,9 @@ bool MeshSystem::readWholeFile(std::vector<unsigned char> *out, std::string *err
 bool MeshSystem::getFileSizeInBytes(size_t *filesize_out, std::string *err, const std::string &filepath, void *userdata) {
   (void)userdata;
 
-    Data filedata;
+    File file;
 
-    if (filedata.open(filepath.c_str()) != FileErrors::FILEDATA_OK){
+    if (file.open(filepath.c_str()) != FileErrors::FILEDATA_OK){
         if (err) {
             (*err) += "File open error : " + filepath + "\n";
         }
@@ -477,7 +480,7 @@ bool MeshSystem::getFileSizeInBytes(size_t *filesize_out, std::string *err, cons
         return false;
     }
 
-    (*filesize_out) = static_cast<size_t>(filedata.length());
+    (*filesize_out) = static_cast<size_t>(file.length());
 
     return true;
 }
@@ -502,21 +505,24 @@ bool MeshSystem::loadGLTFBuffer(int bufferViewIndex, MeshComponent& mesh, ModelC
     if (std::find(loadedBuffers.begin(), loadedBuffers.end(), name) == loadedBuffers.end() && bufferView.target != 0) {
         loadedBuffers.push_back(name);
 
+        if (mesh.eBuffers.size() <= mesh.numExternalBuffers){
+            mesh.eBuffers.resize(mesh.numExternalBuffers + 1);
+        }
+        ExternalBuffer& eBuffer = mesh.eBuffers[mesh.numExternalBuffers];
+
         if (bufferView.target == 34962) { //GL_ARRAY_BUFFER
-            mesh.eBuffers[mesh.numExternalBuffers].setType(BufferType::VERTEX_BUFFER);
+            eBuffer.setType(BufferType::VERTEX_BUFFER);
         } else if (bufferView.target == 34963) { //GL_ELEMENT_ARRAY_BUFFER
-            mesh.eBuffers[mesh.numExternalBuffers].setType(BufferType::INDEX_BUFFER);
+            eBuffer.setType(BufferType::INDEX_BUFFER);
         }
 
-        mesh.eBuffers[mesh.numExternalBuffers].setData(&model.gltfModel->buffers[bufferView.buffer].data.at(0) + bufferView.byteOffset, bufferView.byteLength);
-        mesh.eBuffers[mesh.numExternalBuffers].setStride(stride);
-        mesh.eBuffers[mesh.numExternalBuffers].setName(name);
-        mesh.eBuffers[mesh.numExternalBuffers].setRenderAttributes(false);
+        eBuffer.setData(&model.gltfModel->buffers[bufferView.buffer].data.at(0) + bufferView.byteOffset, bufferView.byteLength);
+        eBuffer.setStride(stride);
+        eBuffer.setName(name);
+        eBuffer.setRenderAttributes(false);
+        eBuffer.setSharedId(model.filename + "|" + name);
 
         mesh.numExternalBuffers++;
-        if (mesh.numExternalBuffers > MAX_EXTERNAL_BUFFERS){
-            Log::error("External buffer limit reached for GLTF model");
-        }
 
         return true;
     }
@@ -627,74 +633,220 @@ Matrix4 MeshSystem::getGLTFMeshGlobalMatrix(int nodeIndex, ModelComponent& model
     return matrix;
 }
 
-Entity MeshSystem::generateSketetalStructure(Entity entity, ModelComponent& model, int nodeIndex, int skinIndex){
-    tinygltf::Node node = model.gltfModel->nodes[nodeIndex];
-    tinygltf::Skin skin = model.gltfModel->skins[skinIndex];
+bool MeshSystem::loadSkeleton(Entity entity, ModelComponent& model, int skeletonRoot, int skinIndex){
+    std::shared_ptr<SkeletonData> data;
+    if (!model.filename.empty()){
+        data = ModelPool::getSkeleton(model.filename);
+    }
 
-    int index = -1;
+    if (!data){
+        const tinygltf::Skin& skin = model.gltfModel->skins[skinIndex];
 
-    for (int j = 0; j < skin.joints.size(); j++) {
-        if (nodeIndex == skin.joints[j])
-            index = j;
-    }
+        const float* matrices = NULL;
+
+        if (skin.inverseBindMatrices >= 0) {
+
+            const tinygltf::Accessor& accessor = model.gltfModel->accessors[skin.inverseBindMatrices];
+            const tinygltf::BufferView& bufferView = model.gltfModel->bufferViews[accessor.bufferView];
+
+            if (accessor.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT || accessor.type != TINYGLTF_TYPE_MAT4) {
+                Log::error("Skeleton error: Unknown inverse bind matrix data type");
+
+                return false;
+            }
 
-    Matrix4 offsetMatrix;
+            matrices = (const float *) (&model.gltfModel->buffers[bufferView.buffer].data.at(0) +
+                                        bufferView.byteOffset + accessor.byteOffset);
+        }
 
-    if (skin.inverseBindMatrices >= 0) {
+        data = std::make_shared<SkeletonData>();
 
-        tinygltf::Accessor accessor = model.gltfModel->accessors[skin.inverseBindMatrices];
-        tinygltf::BufferView bufferView = model.gltfModel->bufferViews[accessor.bufferView];
+        // parents before children
+        std::vector<std::pair<int, int>> stack = {{skeletonRoot, -1}};
+        while (!stack.empty()){
+            std::pair<int, int> node = stack.back();
+            stack.pop_back();
 
-        float *matrices = (float *) (&model.gltfModel->buffers[bufferView.buffer].data.at(0) +
-                                     bufferView.byteOffset + accessor.byteOffset +
-                                     (16 * sizeof(float) * index));
+            int joint = (int)data->jointNode.size();
 
-        if (accessor.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT || accessor.type != TINYGLTF_TYPE_MAT4) {
-            Log::error("Skeleton error: Unknown inverse bind matrix data type");
+            int index = -1;
+            for (int j = 0; j < skin.joints.size(); j++) {
+                if (node.first == skin.joints[j])
+                    index = j;
+            }
 
-            return NULL_ENTITY;
+            Matrix4 offsetMatrix;
+            if (matrices && index >= 0){
+                const float* m = matrices + (16 * index);
+                offsetMatrix = Matrix4(
+                        m[0], m[4], m[8], m[12],
+                        m[1], m[5], m[9], m[13],
+                        m[2], m[6], m[10], m[14],
+                        m[3], m[7], m[11], m[15]);
+            }
+
+            Vector3 position;
+            Vector3 scale;
+            Quaternion rotation;
+            getGLTFNodeMatrix(node.first, model).decompose(position, scale, rotation);
+
+            data->jointName.push_back(model.gltfModel->nodes[node.first].name);
+            data->jointNode.push_back(node.first);
+            data->jointParent.push_back(node.second);
+            data->jointBone.push_back(index);
+            data->bindPosition.push_back(position);
+            data->bindRotation.push_back(rotation);
+            data->bindScale.push_back(scale);
+            data->offsetMatrix.push_back(offsetMatrix);
+
+            const std::vector<int>& children = model.gltfModel->nodes[node.first].children;
+            for (auto it = children.rbegin(); it != children.rend(); ++it){
+                stack.push_back({*it, joint});
+            }
         }
 
-        offsetMatrix = Matrix4(
-                matrices[0], matrices[4], matrices[8], matrices[12],
-                matrices[1], matrices[5], matrices[9], matrices[13],
-                matrices[2], matrices[6], matrices[10], matrices[14],
-                matrices[3], matrices[7], matrices[11], matrices[15]);
+        if (!model.filename.empty()){
+            data = ModelPool::getSkeleton(model.filename, data);
+        }
+    }
 
+    size_t numJoints = data->jointNode.size();
+
+    model.skeletonData = data;
+    model.jointPosition = data->bindPosition;
+    model.jointRotation = data->bindRotation;
+    model.jointScale = data->bindScale;
+    model.jointMatrix.resize(numJoints);
+    model.jointEntities.assign(numJoints, NULL_ENTITY);
+
+    if (!model.flatSkeleton){
+        generateSketetalStructure(entity, model);
+    }
+
+    updateSkeleton(model, scene->findComponent<SkinningComponent>(entity));
+
+    return true;
+}
+
+void MeshSystem::generateSketetalStructure(Entity entity, ModelComponent& model){
+    const SkeletonData& data = *model.skeletonData;
+
+    for (size_t j = 0; j < data.jointNode.size(); j++){
+        createJointEntity(entity, model, (int)j);
+    }
+}
+
+Entity MeshSystem::createJointEntity(Entity entity, ModelComponent& model, int joint){
+    const SkeletonData& data = *model.skeletonData;
+
+    if (model.jointEntities[joint] != NULL_ENTITY){
+        return model.jointEntities[joint];
     }
 
     Entity bone;
 
     bone = scene->createEntity();
     scene->addComponent<Transform>(bone, {});
-    scene->addComponent<BoneComponent>(bone, {});
 
     Transform& bonetransform = scene->getComponent<Transform>(bone);
-    BoneComponent& bonecomp = scene->getComponent<BoneComponent>(bone);
 
-    bonecomp.index = index;
-    bonetransform.name = node.name;
+    bonetransform.name = data.jointName[joint];
 
-    Matrix4 matrix = getGLTFNodeMatrix(nodeIndex, model);
-    matrix.decompose(bonecomp.bindPosition, bonecomp.bindScale, bonecomp.bindRotation);
+    model.bonesNameMapping[bonetransform.name] = bone;
+    model.bonesIdMapping[data.jointNode[joint]] = bone;
+    model.jointEntities[joint] = bone;
 
-    // move to bind
-    bonetransform.position = bonecomp.bindPosition;
-    bonetransform.rotation = bonecomp.bindRotation;
-    bonetransform.scale = bonecomp.bindScale;
+    if (model.flatSkeleton){
+        // only follows joint, skinning is not changed by its transform
+        model.jointMatrix[joint].decompose(bonetransform.position, bonetransform.scale, bonetransform.rotation);
 
-    bonecomp.offsetMatrix = offsetMatrix;
-    bonecomp.model = entity;
+        scene->addEntityChild(entity, bone);
+    }else{
+        scene->addComponent<BoneComponent>(bone, {});
+        BoneComponent& bonecomp = scene->getComponent<BoneComponent>(bone);
+
+        bonecomp.index = data.jointBone[joint];
+        bonecomp.bindPosition = data.bindPosition[joint];
+        bonecomp.bindRotation = data.bindRotation[joint];
+        bonecomp.bindScale = data.bindScale[joint];
+        bonecomp.offsetMatrix = data.offsetMatrix[joint];
+        bonecomp.model = entity;
+
+        // move to bind
+        bonetransform.position = bonecomp.bindPosition;
+        bonetransform.rotation = bonecomp.bindRotation;
+        bonetransform.scale = bonecomp.bindScale;
+
+        int parent = data.jointParent[joint];
+        if (parent >= 0){
+            scene->addEntityChild(model.jointEntities[parent], bone);
+        }else{
+            model.skeleton = bone;
+        }
+    }
 
-    model.bonesNameMapping[bonetransform.name] = bone;
-    model.bonesIdMapping[nodeIndex] = bone;
+    return bone;
+}
+
+void MeshSystem::updateSkeleton(ModelComponent& model, SkinningComponent* skinning){
+    const SkeletonData& data = *model.skeletonData;
+    size_t numJoints = data.jointNode.size();
 
-    for (size_t i = 0; i < node.children.size(); i++){
-        // here bonetransform and bonecomp losts references
-        scene->addEntityChild(bone, generateSketetalStructure(entity, model, node.children[i], skinIndex));
+    // local matrices are independent of each other
+    for (size_t j = 0; j < numJoints; j++){
+        Matrix4& matrix = model.jointMatrix[j];
+        const Vector3& position = model.jointPosition[j];
+        const Vector3& scale = model.jointScale[j];
+
+        // same of translate * rotation * scale
+        matrix = model.jointRotation[j].getRotationMatrix();
+        for (int i = 0; i < 3; i++){
+            matrix[0][i] *= scale.x;
+            matrix[1][i] *= scale.y;
+            matrix[2][i] *= scale.z;
+        }
+        matrix[3][0] = position.x;
+        matrix[3][1] = position.y;
+        matrix[3][2] = position.z;
     }
 
-    return bone;
+    // parents are before children
+    for (size_t j = 0; j < numJoints; j++){
+        int parent = data.jointParent[j];
+        if (parent >= 0){
+            model.jointMatrix[j] = model.jointMatrix[parent] * model.jointMatrix[j];
+        }
+    }
+
+    if (skinning){
+        for (size_t j = 0; j < numJoints; j++){
+            int bone = data.jointBone[j];
+            if (bone >= 0 && bone < MAX_BONES){
+                skinning->bonesMatrix[bone] = model.jointMatrix[j] * data.offsetMatrix[j];
+            }
+        }
+    }
+}
+
+void MeshSystem::updateJointEntities(ModelComponent& model){
+    for (size_t j = 0; j < model.jointEntities.size(); j++){
+        if (model.jointEntities[j] == NULL_ENTITY)
+            continue;
+
+        Transform* transform = scene->findComponent<Transform>(model.jointEntities[j]);
+        if (transform){
+            if (model.flatSkeleton){
+                model.jointMatrix[j].decompose(transform->position, transform->scale, transform->rotation);
+            }else{
+                transform->position = model.jointPosition[j];
+                transform->rotation = model.jointRotation[j];
+                transform->scale = model.jointScale[j];
+            }
+            transform->needUpdate = true;
+
+            scene->markTransformDirty(model.jointEntities[j]);
+        }
+    }
 }
 
 TextureFilter MeshSystem::convertFilter(int filter){
@@ -734,6 +886,124 @@ void MeshSystem::clearAnimations(ModelComponent& model){
     model.animations.clear();
 }
 
+void MeshSystem::loadSkeletalAnimation(Entity entity, ModelComponent& model){
+    if (!model.skeletonData || model.gltfModel->animations.size() == 0){
+        if (scene->findComponent<SkeletalAnimationComponent>(entity)){
+            scene->removeComponent<SkeletalAnimationComponent>(entity);
+        }
+        return;
+    }
+
+    std::shared_ptr<SkeletalAnimationData> data;
+    if (!model.filename.empty()){
+        data = ModelPool::getSkeletalAnimation(model.filename);
+    }
+
+    if (!data){
+        data = std::make_shared<SkeletalAnimationData>();
+
+        std::map<int, int> nodesJoint;
+        for (size_t j = 0; j < model.skeletonData->jointNode.size(); j++){
+            nodesJoint[model.skeletonData->jointNode[j]] = (int)j;
+        }
+
+        for (size_t i = 0; i < model.gltfModel->animations.size(); i++) {
+            const tinygltf::Animation &animation = model.gltfModel->animations[i];
+
+            data->clips.push_back({});
+            SkeletalClip& clip = data->clips.back();
+            clip.name = animation.name;
+
+            for (size_t j = 0; j < animation.channels.size(); j++) {
+                const tinygltf::AnimationChannel &channel = animation.channels[j];
+                const tinygltf::AnimationSampler &sampler = animation.samplers[channel.sampler];
+
+                const tinygltf::Accessor& accessorIn = model.gltfModel->accessors[sampler.input];
+                const tinygltf::BufferView& bufferViewIn = model.gltfModel->bufferViews[accessorIn.bufferView];
+
+                const tinygltf::Accessor& accessorOut = model.gltfModel->accessors[sampler.output];
+                const tinygltf::BufferView& bufferViewOut = model.gltfModel->bufferViews[accessorOut.bufferView];
+
+                if (accessorOut.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT || accessorIn.count == 0)
+                    continue;
+
+                SkeletalTrackPath path;
+                uint32_t valuesSize;
+                int joint = -1;
+
+                if (channel.target_path.compare("weights") == 0){
+                    path = SkeletalTrackPath::WEIGHTS;
+                    valuesSize = accessorOut.count / accessorIn.count;
+                }else{
+                    // only skeleton nodes are animated by clips
+                    if (!nodesJoint.count(channel.target_node))
+                        continue;
+                    joint = nodesJoint[channel.target_node];
+
+                    if (channel.target_path.compare("translation") == 0){
+                        path = SkeletalTrackPath::TRANSLATION;
+                        valuesSize = 3;
+                    }else if (channel.target_path.compare("rotation") == 0){
+                        path = SkeletalTrackPath::ROTATION;
+                        valuesSize = 4;
+                    }else if (channel.target_path.compare("scale") == 0){
+                        path = SkeletalTrackPath::SCALE;
+                        valuesSize = 3;
+                    }else{
+                        continue;
+                    }
+
+                    if (accessorIn.count != accessorOut.count)
+                        continue;
+                }
+
+                float *timeValues = (float *) (&model.gltfModel->buffers[bufferViewIn.buffer].data.at(0) +
+                                               bufferViewIn.byteOffset + accessorIn.byteOffset);
+                float *values = (float *) (&model.gltfModel->buffers[bufferViewOut.buffer].data.at(0) +
+                                           bufferViewOut.byteOffset + accessorOut.byteOffset);
+
+                clip.trackJoint.push_back(joint);
+                clip.trackPath.push_back(path);
+                clip.trackKeysOffset.push_back((uint32_t)clip.times.size());
+                clip.trackKeysCount.push_back((uint32_t)accessorIn.count);
+                clip.trackValuesOffset.push_back((uint32_t)clip.values.size());
+                clip.trackValuesSize.push_back(valuesSize);
+
+                clip.times.insert(clip.times.end(), timeValues, timeValues + accessorIn.count);
+
+                if (path == SkeletalTrackPath::ROTATION){
+                    // same order of Quaternion constructor (w, x, y, z)
+                    for (size_t c = 0; c < accessorIn.count; c++){
+                        clip.values.push_back(values[(4 * c) + 3]);
+                        clip.values.insert(clip.values.end(), values + (4 * c), values + (4 * c) + 3);
+                    }
+                }else{
+                    clip.values.insert(clip.values.end(), values, values + (valuesSize * accessorIn.count));
+                }
+
+                clip.duration = std::max(clip.duration, timeValues[accessorIn.count - 1]);
+            }
+        }
+
+        if (!model.filename.empty()){
+            data = ModelPool::getSkeletalAnimation(model.filename, data);
+        }
+    }
+
+    if (!scene->findComponent<SkeletalAnimationComponent>(entity)){
+        scene->addComponent<SkeletalAnimationComponent>(entity, {});
+    }
+    SkeletalAnimationComponent& skeletal = scene->getComponent<SkeletalAnimationComponent>(entity);
+
+    size_t numJoints = model.skeletonData->jointNode.size();
+
+    skeletal.data = data;
+    skeletal.layers.clear();
+    skeletal.layerPosition.resize(numJoints);
+    skeletal.layerRotation.resize(numJoints);
+    skeletal.layerScale.resize(numJoints);
+}
+
 void MeshSystem::calculateMeshAABB(MeshComponent& mesh){
     std::map<std::string, Buffer*> buffers;
 
@@ -971,6 +1241,9 @@ void MeshSystem::createTerrain(TerrainComponent& terrain, MeshComponent& mesh){
     terrain.nodes.resize(idealSize);
 
     mesh.numSubmeshes = 2;
+    if (mesh.submeshes.size() < mesh.numSubmeshes){
+        mesh.submeshes.resize(mesh.numSubmeshes);
+    }
     // fullRes submesh
     createPlaneNodeSubmesh(0, terrain, mesh, 1, 1, terrain.resolution, terrain.resolution);
     // halfRes submesh
@@ -1590,28 +1863,13 @@ void MeshSystem::createTorus(Entity entity, float radius, float ringRadius, unsi
     calculateMeshAABB(mesh);
 }
 
-bool MeshSystem::loadGLTF(Entity entity, std::string filename){
-    MeshComponent& mesh = scene->getComponent<MeshComponent>(entity);
-    ModelComponent& model = scene->getComponent<ModelComponent>(entity);
-    Transform& transform = scene->getComponent<Transform>(entity);
-
-    destroyModel(model);
-
-    mesh.submeshes[0].primitiveType = PrimitiveType::TRIANGLES;
-    mesh.numSubmeshes = 1;
-
-    if (!model.gltfModel)
-        model.gltfModel = new tinygltf::Model();
+bool MeshSystem::readGLTFModel(std::string filename, tinygltf::Model& gltfModel){
+    PROFILE_ZONE("MeshSystem::readGLTFModel");
 
     tinygltf::TinyGLTF loader;
     std::string err;
     std::string warn;
 
-    int meshIndex = 0;
-    std::vector<std::string> loadedBuffers;
-
-    mesh.numExternalBuffers = 0;
-
     loader.SetFsCallbacks({&fileExists, &tinygltf::ExpandFilePath, &readWholeFile, &tinygltf::WriteWholeFile, &getFileSizeInBytes});
 
     std::string ext = FileData::getFilePathExtension(filename);
@@ -1619,9 +1877,9 @@ bool MeshSystem::loadGLTF(Entity entity, std::string filename){
     bool res = false;
 
     if (ext.compare("glb") == 0) {
-        res = loader.LoadBinaryFromFile(model.gltfModel, &err, &warn, filename); // for binary glTF(.glb)
+        res = loader.LoadBinaryFromFile(&gltfModel, &err, &warn, filename); // for binary glTF(.glb)
     }else{
-        res = loader.LoadASCIIFromFile(model.gltfModel, &err, &warn, filename);
+        res = loader.LoadASCIIFromFile(&gltfModel, &err, &warn, filename);
     }
 
     if (!warn.empty()) {
@@ -1638,6 +1896,38 @@ bool MeshSystem::loadGLTF(Entity entity, std::string filename){
         return false;
     }
 
+    return true;
+}
+
+bool MeshSystem::loadGLTF(Entity entity, std::string filename){
+    PROFILE_ZONE("MeshSystem::loadGLTF");
+
+    MeshComponent& mesh = scene->getComponent<MeshComponent>(entity);
+    ModelComponent& model = scene->getComponent<ModelComponent>(entity);
+    Transform& transform = scene->getComponent<Transform>(entity);
+
+    cancelModelAsync(entity, model);
+
+    destroyModel(model);
+
+    mesh.submeshes[0].primitiveType = PrimitiveType::TRIANGLES;
+    mesh.numSubmeshes = 1;
+
+    int meshIndex = 0;
+    std::vector<std::string> loadedBuffers;
+
+    mesh.numExternalBuffers = 0;
+
+    // file is parsed only by first entity, others use same model data and GPU buffers
+    model.gltfModel = ModelPool::getGLTF(filename);
+    if (!model.gltfModel){
+        std::shared_ptr<tinygltf::Model> gltfModel = std::make_shared<tinygltf::Model>();
+        if (!readGLTFModel(filename, *gltfModel))
+            return false;
+        model.gltfModel = ModelPool::getGLTF(filename, gltfModel);
+    }
+    model.filename = filename;
+
     int meshNode = -1;
     std::map<int, int> nodesParent;
 
@@ -1646,7 +1936,7 @@ bool MeshSystem::loadGLTF(Entity entity, std::string filename){
     }
 
     for (size_t i = 0; i < model.gltfModel->nodes.size(); i++) {
-        tinygltf::Node node = model.gltfModel->nodes[i];
+        const tinygltf::Node& node = model.gltfModel->nodes[i];
 
         if (node.mesh == meshIndex){
             meshNode = i;
@@ -1661,6 +1951,7 @@ bool MeshSystem::loadGLTF(Entity entity, std::string filename){
     Matrix4 matrix = getGLTFMeshGlobalMatrix(meshNode, model, nodesParent);
     matrix.decompose(transform.position, transform.scale, transform.rotation);
     transform.needUpdate = true;
+    scene->markTransformDirty(entity);
 
     mesh.cullingMode = CullingMode::BACK;
     if (matrix.determinant() < 0.0){
@@ -1669,7 +1960,7 @@ bool MeshSystem::loadGLTF(Entity entity, std::string filename){
         mesh.windingOrder = WindingOrder::CCW;
     }
 
-    tinygltf::Mesh gltfmesh = model.gltfModel->meshes[meshIndex];
+    const tinygltf::Mesh& gltfmesh = model.gltfModel->meshes[meshIndex];
 
     if (gltfmesh.primitives.size() > 0){
         mesh.numSubmeshes = gltfmesh.primitives.size();
@@ -1680,13 +1971,24 @@ bool MeshSystem::loadGLTF(Entity entity, std::string filename){
         Log::error("Model %s has more submeshes then MAX_SUBMESHES. Please increase MAX_SUBMESHES", filename.c_str());
         mesh.numSubmeshes = MAX_SUBMESHES;
     }
+    if (mesh.submeshes.size() < mesh.numSubmeshes){
+        mesh.submeshes.resize(mesh.numSubmeshes);
+    }
+
+    // skinning and morph target data are kept in their own components
+    bool hasSkinning = false;
+    float normAdjustJoint = 1;
+    float normAdjustWeight = 1;
+
+    bool hasMorphTargets = false;
+    float morphWeights[MAX_MORPHTARGETS] = {};
 
     for (size_t i = 0; i < mesh.numSubmeshes; i++) {
 
         mesh.submeshes[i].attributes.clear();
 
-        tinygltf::Primitive primitive = gltfmesh.primitives[i];
-        tinygltf::Accessor indexAccessor = model.gltfModel->accessors[primitive.indices];
+        const tinygltf::Primitive& primitive = gltfmesh.primitives[i];
+        const tinygltf::Accessor& indexAccessor = model.gltfModel->accessors[primitive.indices];
         tinygltf::Material &mat = model.gltfModel->materials[primitive.material];
 
         AttributeDataType indexType;
@@ -1790,7 +2092,7 @@ bool MeshSystem::loadGLTF(Entity entity, std::string filename){
         addSubmeshAttribute(mesh.submeshes[i], getBufferName(indexAccessor.bufferView, model), AttributeType::INDEX, 1, indexType, indexAccessor.count, indexAccessor.byteOffset, false);
 
         for (auto &attrib : primitive.attributes) {
-            tinygltf::Accessor accessor = model.gltfModel->accessors[attrib.second];
+            const tinygltf::Accessor& accessor = model.gltfModel->accessors[attrib.second];
             int byteStride = accessor.ByteStride(model.gltfModel->bufferViews[accessor.bufferView]);
             std::string bufferName = getBufferName(accessor.bufferView, model);
 
@@ -1855,10 +2157,11 @@ bool MeshSystem::loadGLTF(Entity entity, std::string filename){
             if (attrib.first.compare("JOINTS_0") == 0){
                 attType = AttributeType::BONEIDS;
                 foundAttrs = true;
+                hasSkinning = true;
 
                 // Sokol always normalize unsigned short
                 if (dataType == AttributeDataType::UNSIGNED_SHORT){
-                    mesh.normAdjustJoint = 65535.0;
+                    normAdjustJoint = 65535.0;
                 }
             }
             if (attrib.first.compare("WEIGHTS_0") == 0){
@@ -1867,16 +2170,16 @@ bool MeshSystem::loadGLTF(Entity entity, std::string filename){
 
                 if (accessor.normalized){
                     if (dataType == AttributeDataType::BYTE){
-                        mesh.normAdjustWeight = 127.0;
+                        normAdjustWeight = 127.0;
                     }else if (dataType == AttributeDataType::UNSIGNED_BYTE){
-                        mesh.normAdjustWeight = 255.0;
+                        normAdjustWeight = 255.0;
                     }else if (dataType == AttributeDataType::SHORT){
-                        mesh.normAdjustWeight = 32767.0;
+                        normAdjustWeight = 32767.0;
                     }
                 }
                 // Sokol always normalize unsigned short
                 if (dataType == AttributeDataType::UNSIGNED_SHORT){
-                    mesh.normAdjustWeight = 65535.0;
+                    normAdjustWeight = 65535.0;
                 }
             }
 
@@ -1901,7 +2204,7 @@ bool MeshSystem::loadGLTF(Entity entity, std::string filename){
 
                 morphTargets = true;
 
-                tinygltf::Accessor accessor = model.gltfModel->accessors[attribMorph.second];
+                const tinygltf::Accessor& accessor = model.gltfModel->accessors[attribMorph.second];
                 int byteStride = accessor.ByteStride(model.gltfModel->bufferViews[accessor.bufferView]);
                 std::string bufferName = getBufferName(accessor.bufferView, model);
 
@@ -2014,9 +2317,10 @@ bool MeshSystem::loadGLTF(Entity entity, std::string filename){
         }
 
         if (morphTargets){
+            hasMorphTargets = true;
             for (int w = 0; w < gltfmesh.weights.size(); w++) {
                 if (w < MAX_MORPHTARGETS){
-                    mesh.morphWeights[w] = gltfmesh.weights[w];
+                    morphWeights[w] = gltfmesh.weights[w];
                 }
             }
 
@@ -2031,6 +2335,27 @@ bool MeshSystem::loadGLTF(Entity entity, std::string filename){
 
     }
 
+    if (hasSkinning){
+        if (!scene->findComponent<SkinningComponent>(entity)){
+            scene->addComponent<SkinningComponent>(entity, {});
+        }
+        SkinningComponent& skinning = scene->getComponent<SkinningComponent>(entity);
+        skinning.normAdjustJoint = normAdjustJoint;
+        skinning.normAdjustWeight = normAdjustWeight;
+    }else if (scene->findComponent<SkinningComponent>(entity)){
+        scene->removeComponent<SkinningComponent>(entity);
+    }
+
+    if (hasMorphTargets){
+        if (!scene->findComponent<MorphTargetComponent>(entity)){
+            scene->addComponent<MorphTargetComponent>(entity, {});
+        }
+        MorphTargetComponent& morphTarget = scene->getComponent<MorphTargetComponent>(entity);
+        memcpy(morphTarget.morphWeights, morphWeights, sizeof(morphWeights));
+    }else if (scene->findComponent<MorphTargetComponent>(entity)){
+        scene->removeComponent<MorphTargetComponent>(entity);
+    }
+
     int skinIndex = model.gltfModel->nodes[meshNode].skin;
     int skeletonRoot = -1;
 
@@ -2052,14 +2377,14 @@ bool MeshSystem::loadGLTF(Entity entity, std::string filename){
         model.bonesNameMapping.clear();
         model.bonesIdMapping.clear();
 
-        model.skeleton = generateSketetalStructure(entity, model, skeletonRoot, skinIndex);
-
-        if (model.skeleton != NULL_ENTITY) {
+        if (loadSkeleton(entity, model, skeletonRoot, skinIndex)) {
             if (skin.joints.size() > MAX_BONES){
                 Log::error("Cannot create skinning bigger than %i", MAX_BONES);
                 return false;
             }
-            scene->addEntityChild(entity, model.skeleton);
+            if (model.skeleton != NULL_ENTITY) {
+                scene->addEntityChild(entity, model.skeleton);
+            }
         }
     }
 
@@ -2165,6 +2490,12 @@ bool MeshSystem::loadGLTF(Entity entity, std::string filename){
                     }
                 }
 
+                // flat skeleton joints are only animated by clips
+                if (foundTrack && model.flatSkeleton && model.skeletonData &&
+                    std::find(model.skeletonData->jointNode.begin(), model.skeletonData->jointNode.end(), channel.target_node) != model.skeletonData->jointNode.end()) {
+                    foundTrack = false;
+                }
+
                 if (foundTrack) {
                     if (model.bonesIdMapping.count(channel.target_node)) {
                         actiontrack.target = model.bonesIdMapping[channel.target_node];
@@ -2188,6 +2519,8 @@ bool MeshSystem::loadGLTF(Entity entity, std::string filename){
 
     }
 
+    loadSkeletalAnimation(entity, model);
+
 /*
     //BEGIN DEBUG
     for (auto &gltfmesh : gltfModel->meshes) {
@@ -2219,7 +2552,7 @@ bool MeshSystem::loadGLTF(Entity entity, std::string filename){
     }
     //END DEBUG
 */
-    std::reverse(mesh.submeshes, mesh.submeshes + mesh.numSubmeshes);
+    std::reverse(mesh.submeshes.begin(), mesh.submeshes.begin() + mesh.numSubmeshes);
 
     if (mesh.loaded)
         mesh.needReload = true;
@@ -2229,15 +2562,8 @@ bool MeshSystem::loadGLTF(Entity entity, std::string filename){
     return true;
 }
 
-bool MeshSystem::loadOBJ(Entity entity, std::string filename){
-    MeshComponent& mesh = scene->getComponent<MeshComponent>(entity);
-    ModelComponent& model = scene->getComponent<ModelComponent>(entity);
-    Transform& transform = scene->getComponent<Transform>(entity);
-
-    destroyModel(model);
-
-    mesh.submeshes[0].primitiveType = PrimitiveType::TRIANGLES;
-    mesh.numSubmeshes = 1;
+bool MeshSystem::readOBJModel(std::string filename, OBJModel& obj){
+    PROFILE_ZONE("MeshSystem::readOBJModel");
 
     tinyobj::attrib_t attrib;
     std::vector<tinyobj::shape_t> shapes;
@@ -2261,145 +2587,239 @@ bool MeshSystem::loadOBJ(Entity entity, std::string filename){
         return false;
     }
 
-    if (ret) {
+    if (!ret) {
+        return false;
+    }
 
-        mesh.buffer.clear();
-        mesh.buffer.addAttribute(AttributeType::POSITION, 3);
-        mesh.buffer.addAttribute(AttributeType::TEXCOORD1, 2);
-        mesh.buffer.addAttribute(AttributeType::NORMAL, 3);
-        mesh.buffer.addAttribute(AttributeType::COLOR, 4);
+    obj.buffer.clearAll();
+    obj.buffer.addAttribute(AttributeType::POSITION, 3);
+    obj.buffer.addAttribute(AttributeType::TEXCOORD1, 2);
+    obj.buffer.addAttribute(AttributeType::NORMAL, 3);
+    obj.buffer.addAttribute(AttributeType::COLOR, 4);
 
-        mesh.indices.clear();
+    obj.indices.clear();
 
-        if (materials.size() > 0){
-            mesh.numSubmeshes = materials.size();
+    size_t numSubmeshes = 1;
+    if (materials.size() > 0){
+        numSubmeshes = materials.size();
+    }
 
-        }
+    if (numSubmeshes > MAX_SUBMESHES){
+        Log::error("Model %s has more submeshes then MAX_SUBMESHES. Please increase MAX_SUBMESHES", filename.c_str());
+        numSubmeshes = MAX_SUBMESHES;
+    }
+
+    obj.materials.resize(numSubmeshes);
+
+    for (size_t i = 0; i < materials.size() && i < numSubmeshes; i++) {
 
-        if (mesh.numSubmeshes > MAX_SUBMESHES){
-            Log::error("Model %s has more submeshes then MAX_SUBMESHES. Please increase MAX_SUBMESHES", filename.c_str());
-            mesh.numSubmeshes = MAX_SUBMESHES;
+        // Convert the blinn-phong model to the pbr metallic-roughness model
+        // Based on https://github.com/CesiumGS/obj2gltf
+        const float specularIntensity = materials[i].specular[0] * 0.2125 + materials[i].specular[1] * 0.7154 + materials[i].specular[2] * 0.0721; //luminance
+
+        float roughnessFactor = materials[i].shininess;
+        roughnessFactor = roughnessFactor / 1000.0;
+        roughnessFactor = 1.0 - roughnessFactor;
+        roughnessFactor = std::min(std::max(roughnessFactor, 0.0f), 1.0f); //clamp
+
+        if (specularIntensity < 0.1) {
+            roughnessFactor *= (1.0 - specularIntensity);
         }
 
-        for (size_t i = 0; i < mesh.numSubmeshes; i++) {
+        const float metallicFactor = 0.0;
 
-            mesh.submeshes[i].attributes.clear();
+        materials[i].specular[0] = metallicFactor;
+        materials[i].specular[1] = metallicFactor;
+        materials[i].specular[2] = metallicFactor;
 
-            // Convert the blinn-phong model to the pbr metallic-roughness model
-            // Based on https://github.com/CesiumGS/obj2gltf
-            const float specularIntensity = materials[i].specular[0] * 0.2125 + materials[i].specular[1] * 0.7154 + materials[i].specular[2] * 0.0721; //luminance
+        materials[i].shininess = roughnessFactor;
+        // ------ End convertion
 
-            float roughnessFactor = materials[i].shininess;
-            roughnessFactor = roughnessFactor / 1000.0;
-            roughnessFactor = 1.0 - roughnessFactor;
-            roughnessFactor = std::min(std::max(roughnessFactor, 0.0f), 1.0f); //clamp
+        obj.materials[i].baseColorFactor = Vector4(materials[i].diffuse[0], materials[i].diffuse[1], materials[i].diffuse[2], 1.0);
+        obj.materials[i].emissiveFactor = Vector3(materials[i].emission[0], materials[i].emission[1], materials[i].emission[2]);
+        obj.materials[i].metallicFactor = materials[i].specular[0];
+        obj.materials[i].roughnessFactor = materials[i].shininess;
 
-            if (specularIntensity < 0.1) {
-                roughnessFactor *= (1.0 - specularIntensity);
-            }
+        if (!materials[i].diffuse_texname.empty())
+            obj.materials[i].baseColorTexture.setPath(baseDir+materials[i].diffuse_texname);
+        if (!materials[i].normal_texname.empty())
+            obj.materials[i].normalTexture.setPath(baseDir+materials[i].normal_texname);
+        if (!materials[i].emissive_texname.empty())
+            obj.materials[i].emissiveTexture.setPath(baseDir+materials[i].emissive_texname);
+        if (!materials[i].ambient_texname.empty())
+            obj.materials[i].occlusionTexture.setPath(baseDir+materials[i].ambient_texname);
+
+        //TODO: occlusionFactor (Ka)
+        //TODO: metallicroughnessTexture (map_Ks + map_Ns)
+
+        if (materials[i].dissolve < 1){
+            obj.transparent = true;
+        }
+    }
 
-            const float metallicFactor = 0.0;
+    Attribute* attVertex = obj.buffer.getAttribute(AttributeType::POSITION);
+    Attribute* attTexcoord = obj.buffer.getAttribute(AttributeType::TEXCOORD1);
+    Attribute* attNormal = obj.buffer.getAttribute(AttributeType::NORMAL);
+    Attribute* attColor = obj.buffer.getAttribute(AttributeType::COLOR);
 
-            materials[i].specular[0] = metallicFactor;
-            materials[i].specular[1] = metallicFactor;
-            materials[i].specular[2] = metallicFactor;
+    std::vector<std::vector<uint16_t>> indexMap;
+    if (materials.size() > 0) {
+        indexMap.resize(materials.size());
+    }else{
+        indexMap.resize(1);
+    }
 
-            materials[i].shininess = roughnessFactor;
-            // ------ End convertion
+    for (size_t i = 0; i < shapes.size(); i++) {
 
-            mesh.submeshes[i].material.baseColorFactor = Vector4(materials[i].diffuse[0], materials[i].diffuse[1], materials[i].diffuse[2], 1.0);
-            mesh.submeshes[i].material.emissiveFactor = Vector3(materials[i].emission[0], materials[i].emission[1], materials[i].emission[2]);
-            mesh.submeshes[i].material.metallicFactor = materials[i].specular[0];
-            mesh.submeshes[i].material.roughnessFactor = materials[i].shininess;
+        size_t index_offset = 0;
+        for (size_t f = 0; f < shapes[i].mesh.num_face_vertices.size(); f++) {
+            size_t fnum = shapes[i].mesh.num_face_vertices[f];
 
-            if (!materials[i].diffuse_texname.empty())
-                mesh.submeshes[i].material.baseColorTexture.setPath(baseDir+materials[i].diffuse_texname);
-            if (!materials[i].normal_texname.empty())
-                mesh.submeshes[i].material.normalTexture.setPath(baseDir+materials[i].normal_texname);
-            if (!materials[i].emissive_texname.empty())
-                mesh.submeshes[i].material.emissiveTexture.setPath(baseDir+materials[i].emissive_texname);
-            if (!materials[i].ambient_texname.empty())
-                mesh.submeshes[i].material.occlusionTexture.setPath(baseDir+materials[i].ambient_texname);
+            int material_id = shapes[i].mesh.material_ids[f];
+            if (material_id < 0)
+                material_id = 0;
 
-            //TODO: occlusionFactor (Ka)
-            //TODO: metallicroughnessTexture (map_Ks + map_Ns)
+            // For each vertex in the face
+            for (size_t v = 0; v < fnum; v++) {
+                tinyobj::index_t idx = shapes[i].mesh.indices[index_offset + v];
+
+                indexMap[material_id].push_back(obj.buffer.getCount());
+
+                 obj.buffer.addVector3(attVertex,
+                                      Vector3(attrib.vertices[3*idx.vertex_index+0],
+                                              attrib.vertices[3*idx.vertex_index+1],
+                                              attrib.vertices[3*idx.vertex_index+2]));
+
+                if (attrib.texcoords.size() > 0) {
+                     obj.buffer.addVector2(attTexcoord,
+                                          Vector2(attrib.texcoords[2 * idx.texcoord_index + 0],
+                                                  1.0f - attrib.texcoords[2 * idx.texcoord_index + 1]));
+                }
+                if (attrib.normals.size() > 0) {
+                     obj.buffer.addVector3(attNormal,
+                                          Vector3(attrib.normals[3 * idx.normal_index + 0],
+                                                  attrib.normals[3 * idx.normal_index + 1],
+                                                  attrib.normals[3 * idx.normal_index + 2]));
+                }
+
+                if (attrib.colors.size() > 0){
+                     obj.buffer.addVector4(attColor,
+                                          Vector4(attrib.colors[3 * idx.vertex_index + 0],
+                                                  attrib.colors[3 * idx.vertex_index + 1],
+                                                  attrib.colors[3 * idx.vertex_index + 2],
+                                                  1.0));
+                }else{
+                     obj.buffer.addVector4(attColor, Vector4(1.0, 1.0, 1.0, 1.0));
+                }
 
-            if (materials[i].dissolve < 1){
-                mesh.transparent = true;
             }
+
+            index_offset += fnum;
         }
+    }
 
-        Attribute* attVertex = mesh.buffer.getAttribute(AttributeType::POSITION);
-        Attribute* attTexcoord = mesh.buffer.getAttribute(AttributeType::TEXCOORD1);
-        Attribute* attNormal = mesh.buffer.getAttribute(AttributeType::NORMAL);
-        Attribute* attColor = mesh.buffer.getAttribute(AttributeType::COLOR);
+    obj.indexAttributes.resize(numSubmeshes);
 
-        std::vector<std::vector<uint16_t>> indexMap;
-        if (materials.size() > 0) {
-            indexMap.resize(materials.size());
-        }else{
-            indexMap.resize(1);
+    for (size_t i = 0; i < numSubmeshes; i++) {
+        Attribute& attIndex = obj.indexAttributes[i];
+        attIndex.setBuffer("indices");
+        attIndex.setDataType(AttributeDataType::UNSIGNED_SHORT);
+        attIndex.setElements(1);
+        attIndex.setCount(indexMap[i].size());
+        attIndex.setOffset(obj.indices.getCount() * sizeof(uint16_t));
+        attIndex.setNormalized(false);
+
+        if (indexMap[i].size() > 0){
+            obj.indices.setValues(obj.indices.getCount(), obj.indices.getAttribute(AttributeType::INDEX), indexMap[i].size(), (char*)&indexMap[i].front(), sizeof(uint16_t));
         }
+    }
+    obj.indices.setRenderAttributes(false);
 
-        for (size_t i = 0; i < shapes.size(); i++) {
+    return true;
+}
 
-            size_t index_offset = 0;
-            for (size_t f = 0; f < shapes[i].mesh.num_face_vertices.size(); f++) {
-                size_t fnum = shapes[i].mesh.num_face_vertices[f];
+void MeshSystem::setOBJBuffer(ExternalBuffer& eBuffer, Buffer& buffer, std::string name, std::string filename){
+    eBuffer.clearAll();
+    eBuffer.setData(buffer.getData(), buffer.getSize());
+    eBuffer.setType(buffer.getType());
+    eBuffer.setStride(buffer.getStride());
+    for (auto const& attr : buffer.getAttributes()){
+        eBuffer.addAttribute(attr.first, attr.second);
+    }
+    eBuffer.setRenderAttributes(buffer.isRenderAttributes());
+    eBuffer.setName(name);
+    eBuffer.setSharedId(filename + "|" + name);
+}
 
-                int material_id = shapes[i].mesh.material_ids[f];
-                if (material_id < 0)
-                    material_id = 0;
+bool MeshSystem::loadOBJ(Entity entity, std::string filename){
+    PROFILE_ZONE("MeshSystem::loadOBJ");
 
-                // For each vertex in the face
-                for (size_t v = 0; v < fnum; v++) {
-                    tinyobj::index_t idx = shapes[i].mesh.indices[index_offset + v];
+    MeshComponent& mesh = scene->getComponent<MeshComponent>(entity);
+    ModelComponent& model = scene->getComponent<ModelComponent>(entity);
 
-                    indexMap[material_id].push_back(mesh.buffer.getCount());
+    cancelModelAsync(entity, model);
 
-                     mesh.buffer.addVector3(attVertex,
-                                          Vector3(attrib.vertices[3*idx.vertex_index+0],
-                                                  attrib.vertices[3*idx.vertex_index+1],
-                                                  attrib.vertices[3*idx.vertex_index+2]));
+    destroyModel(model);
 
-                    if (attrib.texcoords.size() > 0) {
-                         mesh.buffer.addVector2(attTexcoord,
-                                              Vector2(attrib.texcoords[2 * idx.texcoord_index + 0],
-                                                      1.0f - attrib.texcoords[2 * idx.texcoord_index + 1]));
-                    }
-                    if (attrib.normals.size() > 0) {
-                         mesh.buffer.addVector3(attNormal,
-                                              Vector3(attrib.normals[3 * idx.normal_index + 0],
-                                                      attrib.normals[3 * idx.normal_index + 1],
-                                                      attrib.normals[3 * idx.normal_index + 2]));
-                    }
+    // file is parsed only by first entity, others use same buffers
+    model.objModel = ModelPool::getOBJ(filename);
+    if (!model.objModel){
+        std::shared_ptr<OBJModel> objModel = std::make_shared<OBJModel>();
+        if (!readOBJModel(filename, *objModel))
+            return false;
+        model.objModel = ModelPool::getOBJ(filename, objModel);
+    }
+    model.filename = filename;
 
-                    if (attrib.colors.size() > 0){
-                         mesh.buffer.addVector4(attColor,
-                                              Vector4(attrib.colors[3 * idx.vertex_index + 0],
-                                                      attrib.colors[3 * idx.vertex_index + 1],
-                                                      attrib.colors[3 * idx.vertex_index + 2],
-                                                      1.0));
-                    }else{
-                         mesh.buffer.addVector4(attColor, Vector4(1.0, 1.0, 1.0, 1.0));
-                    }
+    OBJModel& obj = *model.objModel;
 
-                }
+    mesh.buffer.clearAll();
+    mesh.indices.clearAll();
 
-                index_offset += fnum;
-            }
-        }
+    mesh.numSubmeshes = obj.materials.size();
+    if (mesh.submeshes.size() < mesh.numSubmeshes){
+        mesh.submeshes.resize(mesh.numSubmeshes);
+    }
 
-        for (size_t i = 0; i < mesh.numSubmeshes; i++) {
-            addSubmeshAttribute(mesh.submeshes[i], "indices", AttributeType::INDEX, 1, AttributeDataType::UNSIGNED_SHORT, indexMap[i].size(), mesh.indices.getCount() * sizeof(uint16_t), false);
+    for (size_t i = 0; i < mesh.numSubmeshes; i++) {
+        Submesh& submesh = mesh.submeshes[i];
+        Material& material = obj.materials[i];
 
-            mesh.indices.setValues(mesh.indices.getCount(),  mesh.indices.getAttribute(AttributeType::INDEX), indexMap[i].size(), (char*)&indexMap[i].front(), sizeof(uint16_t));
-            mesh.indices.setRenderAttributes(false);
-        }
+        submesh.primitiveType = PrimitiveType::TRIANGLES;
+
+        submesh.material.baseColorFactor = material.baseColorFactor;
+        submesh.material.emissiveFactor = material.emissiveFactor;
+        submesh.material.metallicFactor = material.metallicFactor;
+        submesh.material.roughnessFactor = material.roughnessFactor;
+
+        if (!material.baseColorTexture.getPath().empty())
+            submesh.material.baseColorTexture.setPath(material.baseColorTexture.getPath());
+        if (!material.normalTexture.getPath().empty())
+            submesh.material.normalTexture.setPath(material.normalTexture.getPath());
+        if (!material.emissiveTexture.getPath().empty())
+            submesh.material.emissiveTexture.setPath(material.emissiveTexture.getPath());
+        if (!material.occlusionTexture.getPath().empty())
+            submesh.material.occlusionTexture.setPath(material.occlusionTexture.getPath());
 
-        std::reverse(mesh.submeshes, mesh.submeshes + mesh.numSubmeshes);
+        submesh.attributes.clear();
+        submesh.attributes[AttributeType::INDEX] = obj.indexAttributes[i];
     }
 
+    if (obj.transparent){
+        mesh.transparent = true;
+    }
+
+    if (mesh.eBuffers.size() < 2){
+        mesh.eBuffers.resize(2);
+    }
+    setOBJBuffer(mesh.eBuffers[0], obj.buffer, "vertices", filename);
+    setOBJBuffer(mesh.eBuffers[1], obj.indices, "indices", filename);
+    mesh.numExternalBuffers = 2;
+
+    mesh.vertexCount = obj.buffer.getCount();
+
+    std::reverse(mesh.submeshes.begin(), mesh.submeshes.begin() + mesh.numSubmeshes);
+
     if (mesh.loaded)
         mesh.needReload = true;
 
@@ -2408,6 +2828,142 @@ bool MeshSystem::loadOBJ(Entity entity, std::string filename){
     return true;
 }
 
+bool MeshSystem::loadModelAsync(Entity entity, std::string filename){
+    ModelComponent& model = scene->getComponent<ModelComponent>(entity);
+
+    cancelModelAsync(entity, model);
+
+    model.loadState = AssetLoadState::LOADING;
+    model.loadingFilename = filename;
+
+    // same file requested by other entity is parsed only once
+    auto it = modelLoadTasks.find(filename);
+    if (it != modelLoadTasks.end()){
+        it->second.entities.push_back(entity);
+        return true;
+    }
+
+    bool isOBJ = (FileData::getFilePathExtension(filename).compare("obj") == 0);
+
+    std::shared_ptr<tinygltf::Model> gltfModel;
+    std::shared_ptr<OBJModel> objModel;
+
+    // already parsed files are only created in next frame, to keep same behavior
+    bool parsed = isOBJ ? (bool)ModelPool::getOBJ(filename) : (bool)ModelPool::getGLTF(filename);
+    if (!parsed){
+        if (isOBJ){
+            objModel = std::make_shared<OBJModel>();
+        }else{
+            gltfModel = std::make_shared<tinygltf::Model>();
+        }
+    }
+
+    AssetTaskId id = AssetLoader::load([filename, isOBJ, gltfModel, objModel](){
+        if (objModel)
+            return readOBJModel(filename, *objModel);
+        if (gltfModel)
+            return readGLTFModel(filename, *gltfModel);
+        return true;
+    }, [this, filename, isOBJ, gltfModel, objModel](bool success){
+        completeModelAsync(filename, isOBJ, success, gltfModel, objModel);
+    }, getModelLoadPriority(entity));
+
+    modelLoadTasks[filename] = {id, {entity}};
+
+    return true;
+}
+
+void MeshSystem::completeModelAsync(std::string filename, bool isOBJ, bool success, std::shared_ptr<tinygltf::Model> gltfModel, std::shared_ptr<OBJModel> objModel){
+    auto it = modelLoadTasks.find(filename);
+    if (it == modelLoadTasks.end())
+        return;
+
+    std::vector<Entity> entities = it->second.entities;
+    modelLoadTasks.erase(it);
+
+    // kept in pool while entities are loaded
+    if (success){
+        if (gltfModel)
+            gltfModel = ModelPool::getGLTF(filename, gltfModel);
+        if (objModel)
+            objModel = ModelPool::getOBJ(filename, objModel);
+    }
+
+    for (Entity entity : entities){
+        ModelComponent* model = scene->findComponent<ModelComponent>(entity);
+        if (!model || model->loadState != AssetLoadState::LOADING || model->loadingFilename != filename)
+            continue;
+
+        model->loadState = AssetLoadState::NONE;
+        model->loadingFilename.clear();
+
+        bool loaded = false;
+        if (success){
+            loaded = isOBJ ? loadOBJ(entity, filename) : loadGLTF(entity, filename);
+        }
+
+        if (loaded){
+            scene->getComponent<MeshComponent>(entity).needReload = true;
+        }
+
+        // loading can create entities and move components
+        model = scene->findComponent<ModelComponent>(entity);
+        if (model){
+            model->loadState = loaded ? AssetLoadState::LOADED : AssetLoadState::FAILED;
+            model->onLoad.call(loaded);
+        }
+    }
+
+    if (gltfModel){
+        gltfModel.reset();
+        ModelPool::removeGLTF(filename);
+    }
+    if (objModel){
+        objModel.reset();
+        ModelPool::removeOBJ(filename);
+    }
+}
+
+void MeshSystem::cancelModelAsync(Entity entity, ModelComponent& model){
+    if (model.loadState != AssetLoadState::LOADING)
+        return;
+
+    auto it = modelLoadTasks.find(model.loadingFilename);
+    if (it != modelLoadTasks.end()){
+        std::vector<Entity>& entities = it->second.entities;
+        entities.erase(std::remove(entities.begin(), entities.end(), entity), entities.end());
+
+        if (entities.empty()){
+            AssetLoader::cancel(it->second.id);
+            modelLoadTasks.erase(it);
+        }
+    }
+
+    model.loadState = AssetLoadState::NONE;
+    model.loadingFilename.clear();
+}
+
+float MeshSystem::getModelLoadPriority(Entity entity){
+    Transform* transform = scene->findComponent<Transform>(entity);
+    Transform* cameraTransform = scene->findComponent<Transform>(scene->getCamera());
+
+    if (!transform || !cameraTransform)
+        return 0;
+
+    return (transform->worldPosition - cameraTransform->worldPosition).length();
+}
+
+void MeshSystem::updateModelLoadPriorities(){
+    // closest entity waiting for a file sets its priority
+    for (auto& pair : modelLoadTasks){
+        float priority = FLT_MAX;
+        for (Entity entity : pair.second.entities){
+            priority = std::min(priority, getModelLoadPriority(entity));
+        }
+        AssetLoader::setPriority(pair.second.id, priority);
+    }
+}
+
 void MeshSystem::createInstancedMesh(Entity entity){
     Signature signature = scene->getSignature(entity);
 
@@ -2460,9 +3016,14 @@ bool MeshSystem::hasInstancedMesh(Entity entity) const{
 
 void MeshSystem::destroyModel(ModelComponent& model){
     if (model.gltfModel){
-        delete model.gltfModel;
-        model.gltfModel = NULL;
+        model.gltfModel.reset();
+        ModelPool::removeGLTF(model.filename);
+    }
+    if (model.objModel){
+        model.objModel.reset();
+        ModelPool::removeOBJ(model.filename);
     }
+    model.filename.clear();
 
     for (auto const& bone : model.bonesIdMapping){
         scene->destroyEntity(bone.second);
@@ -2475,6 +3036,12 @@ void MeshSystem::destroyModel(ModelComponent& model){
     model.morphNameMapping.clear();
 
     model.skeleton = NULL_ENTITY;
+    model.skeletonData.reset();
+    model.jointPosition.clear();
+    model.jointRotation.clear();
+    model.jointScale.clear();
+    model.jointMatrix.clear();
+    model.jointEntities.clear();
 }
 
 bool MeshSystem::createOrUpdateSprite(SpriteComponent& sprite, MeshComponent& mesh){
@@ -2537,11 +3104,18 @@ void MeshSystem::load(){
 }
 
 void MeshSystem::destroy(){
-
+    for (auto& pair : modelLoadTasks){
+        AssetLoader::cancel(pair.second.id);
+    }
+    modelLoadTasks.clear();
 }
 
 void MeshSystem::update(double dt){
 
+    if (!modelLoadTasks.empty()){
+        updateModelLoadPriorities();
+    }
+
     auto sprites = scene->getComponentArray<SpriteComponent>();
     for (int i = 0; i < sprites->size(); i++){
 		SpriteComponent& sprite = sprites->getComponentFromIndex(i);
@@ -2617,6 +3191,8 @@ void MeshSystem::entityDestroyed(Entity entity){
 	Signature signature = scene->getSignature(entity);
 
 	if (signature.test(scene->getComponentType<ModelComponent>())){
-        destroyModel(scene->getComponent<ModelComponent>(entity));
+        ModelComponent& model = scene->getComponent<ModelComponent>(entity);
+        cancelModelAsync(entity, model);
+        destroyModel(model);
 	}
 }
\ No newline at end of file
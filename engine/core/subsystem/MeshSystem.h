@@ -14,12 +14,22 @@
 #include "component/CameraComponent.h"
 #include "component/TerrainComponent.h"
 #include "component/TilemapComponent.h"
+#include "component/SkinningComponent.h"
+#include "pool/ModelPool.h"
+#include "util/AssetLoader.h"
 
 namespace Supernova{
 
 	class MeshSystem : public SubSystem {
 
     private:
+		// files parsed by AssetLoader and entities waiting for each one
+		struct ModelLoadTask{
+			AssetTaskId id;
+			std::vector<Entity> entities;
+		};
+		std::map<std::string, ModelLoadTask> modelLoadTasks;
+
         void createSprite(SpriteComponent& sprite, MeshComponent& mesh, CameraComponent& camera);
 		void createMeshPolygon(MeshPolygonComponent& polygon, MeshComponent& mesh);
 		void createTilemap(TilemapComponent& tilemap, MeshComponent& mesh);
@@ -42,10 +52,19 @@ namespace Supernova{
 		std::string getBufferName(int bufferViewIndex, ModelComponent& model);
 		Matrix4 getGLTFNodeMatrix(int nodeIndex, ModelComponent& model);
 		Matrix4 getGLTFMeshGlobalMatrix(int nodeIndex, ModelComponent& model, std::map<int, int>& nodesParent);
-		Entity generateSketetalStructure(Entity entity, ModelComponent& model, int nodeIndex, int skinIndex);
+		bool loadSkeleton(Entity entity, ModelComponent& model, int skeletonRoot, int skinIndex);
+		void generateSketetalStructure(Entity entity, ModelComponent& model);
 		TextureFilter convertFilter(int filter);
 		TextureWrap convertWrap(int wrap);
 		void clearAnimations(ModelComponent& model);
+		void loadSkeletalAnimation(Entity entity, ModelComponent& model);
+		static bool readGLTFModel(std::string filename, tinygltf::Model& gltfModel);
+		static bool readOBJModel(std::string filename, OBJModel& obj);
+		void completeModelAsync(std::string filename, bool isOBJ, bool success, std::shared_ptr<tinygltf::Model> gltfModel, std::shared_ptr<OBJModel> objModel);
+		void cancelModelAsync(Entity entity, ModelComponent& model);
+		float getModelLoadPriority(Entity entity);
+		void updateModelLoadPriorities();
+		void setOBJBuffer(ExternalBuffer& eBuffer, Buffer& buffer, std::string name, std::string filename);
 
 		// Terrain
 		size_t getTerrainGridArraySize(int rootGridSize, int levels);
@@ -68,6 +87,8 @@ namespace Supernova{
 		void createTorus(Entity entity, float radius=1, float ringRadius=0.5, unsigned int sides=36, unsigned int rings=16);
 		bool loadGLTF(Entity entity, std::string filename);
 		bool loadOBJ(Entity entity, std::string filename);
+		// file is parsed in AssetLoader thread, model is created later in main thread and ModelComponent::onLoad is called
+		bool loadModelAsync(Entity entity, std::string filename);
 
 		void createInstancedMesh(Entity entity);
 		void removeInstancedMesh(Entity entity);
@@ -75,6 +96,12 @@ namespace Supernova{
 
 		void destroyModel(ModelComponent& model);
 
+		// joint matrices relative to model and skinning palette in one pass, parents are before children
+		void updateSkeleton(ModelComponent& model, SkinningComponent* skinning);
+		// bone entity of joint, with flat skeleton is created only when requested
+		Entity createJointEntity(Entity entity, ModelComponent& model, int joint);
+		void updateJointEntities(ModelComponent& model);
+
 		bool createOrUpdateSprite(SpriteComponent& sprite, MeshComponent& mesh);
 		bool createOrUpdateTerrain(TerrainComponent& terrain, MeshComponent& mesh);
 		bool createOrUpdateMeshPolygon(MeshPolygonComponent& polygon, MeshComponent& mesh);
@@ -8,6 +8,7 @@
 
 #include "util/Box2DAux.h"
 #include "util/JoltPhysicsAux.h"
+#include "util/JobSystem.h"
 
 
 using namespace Supernova;
@@ -16,6 +17,11 @@ using namespace Supernova;
 PhysicsSystem::PhysicsSystem(Scene* scene): SubSystem(scene){
 	signature.set(scene->getComponentType<Body2DComponent>());
 
+	writeComponents.set(scene->getComponentType<Body2DComponent>());
+	writeComponents.set(scene->getComponentType<Body3DComponent>());
+	writeComponents.set(scene->getComponentType<Transform>());
+	readWorldTransform = true;
+
 	this->scene = scene;
 
     this->gravity = Vector3(0, -9.81f, 0);
@@ -56,7 +62,8 @@ PhysicsSystem::PhysicsSystem(Scene* scene): SubSystem(scene){
     world3D.SetGravity(JPH::Vec3(this->gravity.x, this->gravity.y, this->gravity.z));
 
     temp_allocator = new JPH::TempAllocatorImpl(10 * 1024 * 1024);
-    job_system = new JPH::JobSystemThreadPool (JPH::cMaxPhysicsJobs, JPH::cMaxPhysicsBarriers, JPH::thread::hardware_concurrency() - 1);
+    // physics jobs run on engine JobSystem threads
+    job_system = new JoltJobSystem(JPH::cMaxPhysicsJobs, JPH::cMaxPhysicsBarriers);
 
     activationListener3D = new JoltActivationListener(scene, this);
     world3D.SetBodyActivationListener(activationListener3D);
@@ -1848,11 +1855,13 @@ void PhysicsSystem::update(double dt){
             if (transform.position != nPosition){
                 transform.position = nPosition;
                 transform.needUpdate = true;
+                scene->markTransformDirty(entity);
             }
 
             if (transform.rotation != nRotation){
                 transform.rotation = nRotation;
                 transform.needUpdate = true;
+                scene->markTransformDirty(entity);
             }
         }
     }
@@ -1879,50 +1888,71 @@ void PhysicsSystem::update(double dt){
 		world3D.Update(dt, cCollisionSteps, temp_allocator, job_system);
 	}
 
-	for (int i = 0; i < bodies3d->size(); i++){
-		Body3DComponent& body = bodies3d->getComponentFromIndex(i);
-		Entity entity = bodies3d->getEntity(i);
-		Signature signature = scene->getSignature(entity);
+    auto transforms = scene->getComponentArray<Transform>();
+    JPH::BodyInterface &body_interface = world3D.GetBodyInterfaceNoLock();
 
-        if (!body.body.IsInvalid()){
-            JPH::BodyInterface &body_interface = world3D.GetBodyInterfaceNoLock();
-            JPH::RVec3 position = body_interface.GetPosition(body.body);
-            JPH::Quat rotation = body_interface.GetRotation(body.body);
-            if (signature.test(scene->getComponentType<Transform>())){
-                Transform& transform = scene->getComponent<Transform>(entity);
+    // each body only writes its own Transform, so they are read back in parallel
+    // batches are at least minBatch long, so start / minBatch is a unique slot for each one
+    const size_t minBatch = 64;
+    movedBodies3D.resize((bodies3d->size() + minBatch - 1) / minBatch);
+    for (auto& moved : movedBodies3D){
+        moved.clear();
+    }
+
+    JobSystem::parallelFor(bodies3d->size(), minBatch, [&](size_t start, size_t end){
+        std::vector<Entity>& moved = movedBodies3D[start / minBatch];
+
+        for (size_t i = start; i < end; i++){
+            Body3DComponent& body = bodies3d->getComponentFromIndex(i);
+            Entity entity = bodies3d->getEntity(i);
+            Transform* transform = transforms->findComponent(entity);
+
+            if (transform && !body.body.IsInvalid()){
+                JPH::RVec3 position = body_interface.GetPosition(body.body);
+                JPH::Quat rotation = body_interface.GetRotation(body.body);
 
                 if (!std::isnan(position.GetX()) && !std::isnan(position.GetY()) && !std::isnan(position.GetZ())){
                     Vector3 nPosition = Vector3(position.GetX(), position.GetY(), position.GetZ());
                     Quaternion nRotation = Quaternion(rotation.GetW(), rotation.GetX(), rotation.GetY(), rotation.GetZ());
 
-                    if (transform.parent != NULL_ENTITY){
-                        Transform& transformParent = scene->getComponent<Transform>(transform.parent);
+                    if (transform->parent != NULL_ENTITY){
+                        Transform& transformParent = transforms->getComponent(transform->parent);
 
                         nPosition = transformParent.modelMatrix.inverse() * nPosition;
                         nRotation = transformParent.worldRotation.inverse() * nRotation;
                     }
 
-                    if (transform.position != nPosition){
-                        transform.position = nPosition;
-                        transform.needUpdate = true;
-                    }
+                    if (transform->position != nPosition || transform->rotation != nRotation){
+                        transform->position = nPosition;
+                        transform->rotation = nRotation;
+                        transform->needUpdate = true;
 
-                    if (transform.rotation != nRotation){
-                        transform.rotation = nRotation;
-                        transform.needUpdate = true;
+                        moved.push_back(entity);
                     }
                 }
-
             }
         }
+    });
+
+    for (auto& moved : movedBodies3D){
+        for (Entity entity : moved){
+            scene->markTransformDirty(entity);
+        }
     }
-    
 }
 
 void PhysicsSystem::draw(){
 
 }
 
+bool PhysicsSystem::isConcurrentUpdate(){
+    // callbacks can run scripts and access any component
+    return beginContact2D.empty() && endContact2D.empty() && beginSensorContact2D.empty() && endSensorContact2D.empty() &&
+        hitContact2D.empty() && preSolve2D.empty() && shouldCollide2D.empty() &&
+        onBodyActivated3D.empty() && onBodyDeactivated3D.empty() && onContactAdded3D.empty() &&
+        onContactPersisted3D.empty() && onContactRemoved3D.empty() && shouldCollide3D.empty();
+}
+
 void PhysicsSystem::entityDestroyed(Entity entity){
     Signature signature = scene->getSignature(entity);
 
@@ -17,7 +17,7 @@
 #include "box2d/box2d.h"
 
 #include "Jolt/Jolt.h"
-#include "Jolt/Core/JobSystemThreadPool.h"
+#include "util/JoltJobSystem.h"
 #include "Jolt/Physics/PhysicsSystem.h"
 #include "Jolt/Physics/Collision/BroadPhase/BroadPhaseLayerInterfaceMask.h"
 #include "Jolt/Physics/Collision/BroadPhase/ObjectVsBroadPhaseLayerFilterMask.h"
@@ -42,7 +42,7 @@ namespace Supernova{
 		JoltContactListener* contactListener3D;
 
         JPH::TempAllocatorImpl* temp_allocator;
-        JPH::JobSystemThreadPool* job_system;
+        JoltJobSystem* job_system;
 
 		JPH::PhysicsSystem world3D;
 
@@ -50,6 +50,9 @@ namespace Supernova{
 		JPH::ObjectVsBroadPhaseLayerFilterMask* object_vs_broadphase_layer_filter;
 		JPH::ObjectLayerPairFilterMask* object_vs_object_layer_filter;
 
+		// moved entities of each 3D body batch, marked dirty after parallel read back
+		std::vector<std::vector<Entity>> movedBodies3D;
+
 		void updateBody2DPosition(Signature signature, Entity entity, Body2DComponent& body);
 		void updateBody3DPosition(Signature signature, Entity entity, Body3DComponent& body);
 
@@ -165,6 +168,8 @@ namespace Supernova{
 		virtual void update(double dt);
 		virtual void draw();
 
+		virtual bool isConcurrentUpdate();
+
 		virtual void entityDestroyed(Entity entity);
 	};
 
@@ -12,13 +12,25 @@
 #include "render/ObjectRender.h"
 #include "render/SystemRender.h"
 #include "pool/ShaderPool.h"
+#include "pool/PipelinePool.h"
 #include "pool/TexturePool.h"
 #include "math/Vector3.h"
 #include "util/Angle.h"
 #include "buffer/ExternalBuffer.h"
 #include "math/AABB.h"
+#include "util/JobSystem.h"
+#include "util/RadixSort.h"
+#include "util/Hash.h"
+#include "util/Profiler.h"
 #include <memory>
 #include <cmath>
+#include <algorithm>
+#include <cstring>
+#include <set>
+#include <limits>
+
+// frames without changes before a shadow caster is cached
+#define SHADOWCASTER_STATIC_FRAMES 30
 
 using namespace Supernova;
 
@@ -37,6 +49,14 @@ RenderSystem::RenderSystem(Scene* scene): SubSystem(scene){
 	signature.set(scene->getComponentType<Transform>());
 
 	this->scene = scene;
+
+	frameCount = 0;
+
+	staticShadowsHash = 0;
+	staticShadowsVersion = 1;
+	slotShadowCopyTexture = std::make_pair(-1, -1);
+	shadowCopyLoaded = false;
+	hasShadowCopy = false;
 }
 
 RenderSystem::~RenderSystem(){
@@ -52,6 +72,9 @@ void RenderSystem::load(){
 		
 	update(0); // first update
 
+	// variants of previous runs, objects created later will share these pipelines
+	PipelinePool::warmUp();
+
 	auto cameras = scene->getComponentArray<CameraComponent>();
 	for (int i = 0; i < cameras->size(); i++){
 		CameraComponent& camera = cameras->getComponentFromIndex(i);
@@ -71,6 +94,20 @@ void RenderSystem::destroy(){
 
 	emptyTexturesCreated = false;
 
+	if (shadowCopyLoaded){
+		shadowCopyRender.destroy();
+		shadowCopyShader.reset();
+		ShaderPool::remove(ShaderType::DEPTH, ShaderProperty::SHD_DEPTH_COPY);
+
+		shadowCopyLoaded = false;
+		hasShadowCopy = false;
+	}
+
+	for (auto& batch : autoInstancingBatches){
+		destroyAutoInstancing(batch.second);
+	}
+	autoInstancingBatches.clear();
+
 	auto skys = scene->getComponentArray<SkyComponent>();
 	if (skys->size() > 0){
 		SkyComponent& sky = skys->getComponentFromIndex(0);
@@ -220,29 +257,35 @@ bool RenderSystem::loadLights(int numLights){
 			}
 
 			if (light.type == LightType::POINT){
-				if (!light.framebuffer[0].isCreated())
+				if (!light.framebuffer[0].isCreated()){
 					light.framebuffer[0].createFramebuffer(
 							TextureType::TEXTURE_CUBE, light.mapResolution, light.mapResolution, 
 							TextureFilter::LINEAR, TextureFilter::LINEAR, TextureWrap::CLAMP_TO_BORDER, TextureWrap::CLAMP_TO_BORDER, true);
+					resetShadowsCache(light);
+				}
 
 				if ((freeShadowCubeMap - MAX_SHADOWSMAP) < MAX_SHADOWSCUBEMAP){
 					light.shadowMapIndex = freeShadowCubeMap++;
 				}
 			}else if (light.type == LightType::SPOT){
-				if (!light.framebuffer[0].isCreated())
+				if (!light.framebuffer[0].isCreated()){
 					light.framebuffer[0].createFramebuffer(
 							TextureType::TEXTURE_2D, light.mapResolution, light.mapResolution, 
 							TextureFilter::LINEAR, TextureFilter::LINEAR, TextureWrap::CLAMP_TO_BORDER, TextureWrap::CLAMP_TO_BORDER, true);
+					resetShadowsCache(light);
+				}
 
 				if (freeShadowMap < MAX_SHADOWSMAP){
 					light.shadowMapIndex = freeShadowMap++;
 				}
 			}else if (light.type == LightType::DIRECTIONAL){
 				for (int c = 0; c < light.numShadowCascades; c++){
-					if (!light.framebuffer[c].isCreated())
+					if (!light.framebuffer[c].isCreated()){
 						light.framebuffer[c].createFramebuffer(
 								TextureType::TEXTURE_2D, light.mapResolution, light.mapResolution, 
 								TextureFilter::LINEAR, TextureFilter::LINEAR, TextureWrap::CLAMP_TO_BORDER, TextureWrap::CLAMP_TO_BORDER, true);
+						resetShadowsCache(light);
+					}
 				}
 
 				if ((freeShadowMap + light.numShadowCascades - 1) < MAX_SHADOWSMAP){
@@ -502,7 +545,24 @@ void RenderSystem::loadTerrainTextures(TerrainComponent& terrain, ObjectRender&
 		render.addTexture(slotTex, ShaderStageType::FRAGMENT, &emptyWhite);
 }
 
+bool RenderSystem::loadMeshTexturesAsync(MeshComponent& mesh, float priority){
+	bool ready = true;
+
+	for (unsigned int i = 0; i < mesh.numSubmeshes; i++){
+		Material& material = mesh.submeshes[i].material;
+
+		ready = material.baseColorTexture.loadAsync(priority) && ready;
+		ready = material.emissiveTexture.loadAsync(priority) && ready;
+		ready = material.metallicRoughnessTexture.loadAsync(priority) && ready;
+		ready = material.occlusionTexture.loadAsync(priority) && ready;
+		ready = material.normalTexture.loadAsync(priority) && ready;
+	}
+
+	return ready;
+}
+
 bool RenderSystem::loadMesh(Entity entity, MeshComponent& mesh, uint8_t pipelines, InstancedMeshComponent* instmesh, TerrainComponent* terrain){
+	PROFILE_ZONE("RenderSystem::loadMesh");
 
 	if (!Engine::isViewLoaded()) 
 		return false;
@@ -516,6 +576,7 @@ bool RenderSystem::loadMesh(Entity entity, MeshComponent& mesh, uint8_t pipeline
 
 	std::map<std::string, Buffer*> buffers;
 	std::map<std::string, BufferRender*> bufferNameToRender;
+	std::set<std::string> sharedBuffers;
 	bool allBuffersEmpty = true;
 
 	if (mesh.buffer.getSize() > 0){
@@ -538,6 +599,10 @@ bool RenderSystem::loadMesh(Entity entity, MeshComponent& mesh, uint8_t pipeline
 		if (mesh.eBuffers[i].getUsage() != BufferUsage::IMMUTABLE){
 			mesh.needUpdateBuffer = true;
 		}
+		// model files loaded by many entities are uploaded once
+		if (mesh.eBuffers[i].createSharedRender()){
+			sharedBuffers.insert(mesh.eBuffers[i].getName());
+		}
 	}
 
 	if (mesh.vertexCount == 0){
@@ -550,7 +615,9 @@ bool RenderSystem::loadMesh(Entity entity, MeshComponent& mesh, uint8_t pipeline
 	std::map<std::string, unsigned int> bufferStride;
 
 	for (auto const& buf : buffers){
-		buf.second->getRender()->createBuffer(buf.second->getSize(), buf.second->getData(), buf.second->getType(), buf.second->getUsage());
+		if (!sharedBuffers.count(buf.first)){
+			buf.second->getRender()->createBuffer(buf.second->getSize(), buf.second->getData(), buf.second->getType(), buf.second->getUsage());
+		}
 		bufferNameToRender[buf.first] = buf.second->getRender();
 		bufferStride[buf.first] = buf.second->getStride();
 	}
@@ -892,6 +959,11 @@ bool RenderSystem::loadMesh(Entity entity, MeshComponent& mesh, uint8_t pipeline
 		//----------End depth shader---------------
 	}
 
+	mesh.instancingKey = 0;
+	if (Engine::isAutomaticInstancing() && !instmesh && !terrain){
+		mesh.instancingKey = getInstancingKey(mesh);
+	}
+
 	mesh.needReload = false;
 	mesh.loadCalled = true;
 	SystemRender::addQueueCommand(&changeLoaded, new check_load_t{scene, entity});
@@ -899,7 +971,7 @@ bool RenderSystem::loadMesh(Entity entity, MeshComponent& mesh, uint8_t pipeline
 	return true;
 }
 
-bool RenderSystem::drawMesh(MeshComponent& mesh, Transform& transform, CameraComponent& camera, Transform& camTransform, bool renderToTexture, InstancedMeshComponent* instmesh, TerrainComponent* terrain){
+bool RenderSystem::drawMesh(Entity entity, MeshComponent& mesh, Transform& transform, CameraComponent& camera, Transform& camTransform, bool renderToTexture, InstancedMeshComponent* instmesh, TerrainComponent* terrain){
 	if (mesh.loaded){
 
 		if (mesh.worldAABB != AABB::ZERO && !isInsideCamera(camera, mesh.worldAABB)) {
@@ -916,6 +988,7 @@ bool RenderSystem::drawMesh(MeshComponent& mesh, Transform& transform, CameraCom
 					mesh.eBuffers[i].getRender()->updateBuffer(mesh.eBuffers[i].getSize(), mesh.eBuffers[i].getData());
 			}
 
+			mesh.shadowChangedFrame = frameCount;
 			mesh.needUpdateBuffer = false;
 		}
 		unsigned int instanceCount = 1;
@@ -946,6 +1019,9 @@ bool RenderSystem::drawMesh(MeshComponent& mesh, Transform& transform, CameraCom
 			terrain->needUpdateTerrain = false;
 		}
 
+		SkinningComponent* skinning = scene->findComponent<SkinningComponent>(entity);
+		MorphTargetComponent* morphTarget = scene->findComponent<MorphTargetComponent>(entity);
+
 		for (int i = 0; i < mesh.numSubmeshes; i++){
 			ObjectRender& render = mesh.submeshes[i].render;
 
@@ -972,14 +1048,14 @@ bool RenderSystem::drawMesh(MeshComponent& mesh, Transform& transform, CameraCom
 			}
 
 			if (hasFog){
-				render.applyUniformBlock(mesh.submeshes[i].slotFSFog, ShaderStageType::FRAGMENT, sizeof(float) * 8, &fs_fog);
+				render.applySharedUniformBlock(mesh.submeshes[i].slotFSFog, ShaderStageType::FRAGMENT, sizeof(float) * 8, &fs_fog);
 			}
 
 			if (hasLights){
-				render.applyUniformBlock(mesh.submeshes[i].slotFSLighting, ShaderStageType::FRAGMENT, sizeof(float) * (16 * MAX_LIGHTS + 4), &fs_lighting);
+				render.applySharedUniformBlock(mesh.submeshes[i].slotFSLighting, ShaderStageType::FRAGMENT, sizeof(float) * (16 * MAX_LIGHTS + 4), &fs_lighting);
 				if (hasShadows && mesh.receiveShadows){
-					render.applyUniformBlock(mesh.submeshes[i].slotVSShadows, ShaderStageType::VERTEX, sizeof(float) * (16 * MAX_SHADOWSMAP), &vs_shadows);
-					render.applyUniformBlock(mesh.submeshes[i].slotFSShadows, ShaderStageType::FRAGMENT, sizeof(float) * (4 * (MAX_SHADOWSMAP + MAX_SHADOWSCUBEMAP)), &fs_shadows);
+					render.applySharedUniformBlock(mesh.submeshes[i].slotVSShadows, ShaderStageType::VERTEX, sizeof(float) * (16 * MAX_SHADOWSMAP), &vs_shadows);
+					render.applySharedUniformBlock(mesh.submeshes[i].slotFSShadows, ShaderStageType::FRAGMENT, sizeof(float) * (4 * (MAX_SHADOWSMAP + MAX_SHADOWSCUBEMAP)), &fs_shadows);
 				}
 			}
 
@@ -987,15 +1063,15 @@ bool RenderSystem::drawMesh(MeshComponent& mesh, Transform& transform, CameraCom
 				render.applyUniformBlock(mesh.submeshes[i].slotVSSprite, ShaderStageType::VERTEX, sizeof(float) * 4, &mesh.submeshes[i].textureRect);
 			}
 
-			if (mesh.submeshes[i].hasSkinning){
-				render.applyUniformBlock(mesh.submeshes[i].slotVSSkinning, ShaderStageType::VERTEX, sizeof(float) * 16 * MAX_BONES + (sizeof(float) * 4), &mesh.bonesMatrix);
+			if (mesh.submeshes[i].hasSkinning && skinning){
+				render.applySharedUniformBlock(mesh.submeshes[i].slotVSSkinning, ShaderStageType::VERTEX, sizeof(float) * 16 * MAX_BONES + (sizeof(float) * 4), &skinning->bonesMatrix);
 			}
 
-			if (mesh.submeshes[i].hasMorphTarget){
+			if (mesh.submeshes[i].hasMorphTarget && morphTarget){
 				if (!mesh.submeshes[i].hasMorphNormal && !mesh.submeshes[i].hasMorphTangent){
-					render.applyUniformBlock(mesh.submeshes[i].slotVSMorphTarget, ShaderStageType::VERTEX, sizeof(float) * MAX_MORPHTARGETS, &mesh.morphWeights);
+					render.applySharedUniformBlock(mesh.submeshes[i].slotVSMorphTarget, ShaderStageType::VERTEX, sizeof(float) * MAX_MORPHTARGETS, &morphTarget->morphWeights);
 				}else{
-					render.applyUniformBlock(mesh.submeshes[i].slotVSMorphTarget, ShaderStageType::VERTEX, sizeof(float) * MAX_MORPHTARGETS / 2, &mesh.morphWeights);
+					render.applySharedUniformBlock(mesh.submeshes[i].slotVSMorphTarget, ShaderStageType::VERTEX, sizeof(float) * MAX_MORPHTARGETS / 2, &morphTarget->morphWeights);
 				}
 			}
 
@@ -1019,19 +1095,427 @@ bool RenderSystem::drawMesh(MeshComponent& mesh, Transform& transform, CameraCom
 	return true;
 }
 
-bool RenderSystem::drawMeshDepth(MeshComponent& mesh, const float cameraFar, const Plane frustumPlanes[6], vs_depth_t vsDepthParams, InstancedMeshComponent* instmesh, TerrainComponent* terrain){
+uint64_t RenderSystem::getMeshDrawKey(MeshComponent& mesh, Transform& transform, CameraComponent& camera){
+	// key bits: pass/layer (8) | render state (40) | depth (16)
+	// the whole mesh is drawn at once, so state is from first submesh and other submeshes can break it
+	uint64_t passKey = 0; // reserved, all opaque meshes are in same pass now
+	uint64_t stateKey = mesh.submeshes[0].render.getStateKey((camera.renderToTexture)?PIP_RTT:PIP_DEFAULT) & 0xFFFFFFFFFF;
+
+	// front to back inside same state
+	float depth = (camera.far > 0) ? (transform.distanceToCamera / camera.far) : 0;
+	depth = std::max(0.0f, std::min(depth, 1.0f));
+	uint64_t depthKey = (uint64_t)(depth * 0xFFFF);
+
+	return (passKey << 56) | (stateKey << 16) | depthKey;
+}
+
+void RenderSystem::drawOpaqueMeshes(CameraComponent& camera, Entity cameraEntity, Transform& cameraTransform){
+	// called before each primitive drawn in hierarchy order, to keep it after previous meshes
+	if (opaqueMeshes.empty())
+		return;
+
+	if (Engine::isAutomaticInstancing()){
+		buildAutoInstancing(camera, cameraEntity);
+	}
+	radixSort(opaqueMeshes, sortTemp);
+	for (MeshDrawData& meshData : opaqueMeshes){
+		if (meshData.batch){
+			drawAutoInstancing(*meshData.batch, *meshData.mesh, camera, camera.renderToTexture);
+		}else{
+			drawMesh(meshData.entity, *meshData.mesh, *meshData.transform, camera, cameraTransform, camera.renderToTexture, meshData.instmesh, meshData.terrain);
+		}
+	}
+	opaqueMeshes.clear();
+}
+
+uint64_t RenderSystem::getInstancingKey(MeshComponent& mesh){
+	// only geometry in pooled GPU buffers (ex: same model file), identified by shared id
+	if (mesh.buffer.getSize() > 0 || mesh.indices.getSize() > 0 || mesh.numExternalBuffers == 0){
+		return 0;
+	}
+
+	uint64_t key = hashValue(mesh.vertexCount);
+
+	for (int i = 0; i < mesh.numExternalBuffers; i++){
+		ExternalBuffer& eBuffer = mesh.eBuffers[i];
+		if (!eBuffer.hasSharedRender()){
+			return 0;
+		}
+		std::string sharedId = eBuffer.getSharedId();
+		std::string name = eBuffer.getName();
+		key = hashBytes(sharedId.data(), sharedId.size(), key);
+		key = hashBytes(name.data(), name.size(), key);
+		key = hashValue(eBuffer.getStride(), key);
+		for (auto const &attr : eBuffer.getAttributes()){
+			key = hashValue(attr.first, key);
+			key = hashValue(attr.second.getOffset(), key);
+		}
+	}
+
+	key = hashValue(mesh.cullingMode, key);
+	key = hashValue(mesh.windingOrder, key);
+	key = hashValue(mesh.receiveShadows, key);
+
+	for (int i = 0; i < mesh.numSubmeshes; i++){
+		Submesh& submesh = mesh.submeshes[i];
+
+		if (submesh.hasSkinning || submesh.hasMorphTarget || submesh.hasTextureRect){
+			return 0;
+		}
+
+		// optional variant, a missing one would be reported and batch would fail every frame
+		if (!ShaderPool::isEmbedded(ShaderType::MESH, submesh.shaderProperties | SHD_INSTANCING)){
+			return 0;
+		}
+
+		key = hashValue(submesh.shaderProperties, key);
+		key = hashValue(submesh.primitiveType, key);
+		key = hashValue(submesh.vertexCount, key);
+		key = hashValue(submesh.enableFaceCulling, key);
+		for (auto const& attr : submesh.attributes){
+			key = hashValue(attr.first, key);
+			key = hashBytes(attr.second.getBuffer().data(), attr.second.getBuffer().size(), key);
+			key = hashValue(attr.second.getOffset(), key);
+			key = hashValue(attr.second.getCount(), key);
+		}
+	}
+
+	return (key != 0) ? key : 1;
+}
+
+uint64_t RenderSystem::getInstancingBatchKey(MeshComponent& mesh, Entity cameraEntity){
+	// each camera has its own instance buffer, it can be updated only once per frame
+	uint64_t key = hashCombine(mesh.instancingKey, cameraEntity);
+
+	for (int i = 0; i < mesh.numSubmeshes; i++){
+		Material& material = mesh.submeshes[i].material;
+
+		key = hashValue(material.baseColorFactor, key);
+		key = hashValue(material.metallicFactor, key);
+		key = hashValue(material.roughnessFactor, key);
+		key = hashValue(material.emissiveFactor, key);
+		key = hashValue(material.baseColorTexture.getRender(), key);
+		key = hashValue(material.emissiveTexture.getRender(), key);
+		key = hashValue(material.metallicRoughnessTexture.getRender(), key);
+		key = hashValue(material.occlusionTexture.getRender(), key);
+		key = hashValue(material.normalTexture.getRender(), key);
+	}
+
+	return key;
+}
+
+bool RenderSystem::isAutoInstancingCandidate(MeshDrawData& meshData){
+	MeshComponent& mesh = *meshData.mesh;
+
+	if (mesh.instancingKey == 0 || mesh.needUpdateBuffer || meshData.instmesh || meshData.terrain){
+		return false;
+	}
+
+	// instanced normals are transformed by instance matrix without its inverse transpose
+	Vector3& scale = meshData.transform->worldScale;
+	if (std::fabs(scale.x - scale.y) > 0.0001 || std::fabs(scale.x - scale.z) > 0.0001){
+		return false;
+	}
+
+	for (int i = 0; i < mesh.numSubmeshes; i++){
+		Material& material = mesh.submeshes[i].material;
+
+		if (mesh.submeshes[i].needUpdateTexture){
+			return false;
+		}
+		if (material.baseColorTexture.isFramebuffer() || material.emissiveTexture.isFramebuffer() ||
+			material.metallicRoughnessTexture.isFramebuffer() || material.occlusionTexture.isFramebuffer() ||
+			material.normalTexture.isFramebuffer()){
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void RenderSystem::buildAutoInstancing(CameraComponent& camera, Entity cameraEntity){
+	instancingCandidates.clear();
+
+	size_t numOpaque = 0;
+	for (size_t i = 0; i < opaqueMeshes.size(); i++){
+		MeshDrawData& meshData = opaqueMeshes[i];
+
+		if (isAutoInstancingCandidate(meshData)){
+			// culled here because batches skip culling of drawMesh
+			if (meshData.mesh->worldAABB == AABB::ZERO || isInsideCamera(camera, meshData.mesh->worldAABB)){
+				meshData.key = getInstancingBatchKey(*meshData.mesh, cameraEntity);
+				instancingCandidates.push_back(meshData);
+			}
+		}else{
+			opaqueMeshes[numOpaque++] = meshData;
+		}
+	}
+	opaqueMeshes.resize(numOpaque);
+
+	radixSort(instancingCandidates, sortTemp);
+
+	size_t start = 0;
+	while (start < instancingCandidates.size()){
+		size_t end = start + 1;
+		while (end < instancingCandidates.size() && instancingCandidates[end].key == instancingCandidates[start].key){
+			end++;
+		}
+
+		size_t numInstances = end - start;
+		MeshDrawData& first = instancingCandidates[start];
+
+		AutoInstancingBatch* batch = nullptr;
+		// batch buffer is updated once by frame, so it is not used again after a flush of opaque meshes
+		auto itBatch = autoInstancingBatches.find(first.key);
+		bool usedInFrame = (itBatch != autoInstancingBatches.end() && itBatch->second.loaded && itBatch->second.lastFrame == frameCount);
+
+		if (numInstances >= MIN_AUTO_INSTANCING_MESHES && !usedInFrame){
+			batch = &autoInstancingBatches[first.key];
+
+			if (batch->loaded && batch->maxInstances < numInstances){
+				destroyAutoInstancing(*batch);
+			}
+			if (!batch->loaded && !loadAutoInstancing(*batch, first, numInstances, camera.renderToTexture)){
+				destroyAutoInstancing(*batch);
+				batch = nullptr;
+			}
+		}
+
+		if (batch){
+			batch->lastFrame = frameCount;
+
+			batch->instances.clear();
+			for (size_t i = start; i < end; i++){
+				batch->instances.push_back({instancingCandidates[i].transform->modelMatrix, Vector4(1.0, 1.0, 1.0, 1.0), Rect(0.0, 0.0, 1.0, 1.0)});
+			}
+
+			first.key = getMeshDrawKey(*first.mesh, *first.transform, camera);
+			first.batch = batch;
+			opaqueMeshes.push_back(first);
+		}else{
+			for (size_t i = start; i < end; i++){
+				instancingCandidates[i].key = getMeshDrawKey(*instancingCandidates[i].mesh, *instancingCandidates[i].transform, camera);
+				opaqueMeshes.push_back(instancingCandidates[i]);
+			}
+		}
+
+		start = end;
+	}
+}
+
+bool RenderSystem::loadAutoInstancing(AutoInstancingBatch& batch, MeshDrawData& source, size_t numInstances, bool renderToTexture){
+	MeshComponent& mesh = *source.mesh;
+
+	std::map<std::string, Buffer*> buffers;
+	std::map<std::string, BufferRender*> bufferNameToRender;
+	std::map<std::string, unsigned int> bufferStride;
+
+	if (mesh.buffer.getSize() > 0){
+		buffers["vertices"] = &mesh.buffer;
+	}
+	if (mesh.indices.getSize() > 0){
+		buffers["indices"] = &mesh.indices;
+	}
+	for (int i = 0; i < mesh.numExternalBuffers; i++){
+		buffers[mesh.eBuffers[i].getName()] = &mesh.eBuffers[i];
+	}
+	for (auto const& buf : buffers){
+		bufferNameToRender[buf.first] = buf.second->getRender();
+		bufferStride[buf.first] = buf.second->getStride();
+	}
+
+	batch.source = source.entity;
+
+	batch.maxInstances = 16;
+	while (batch.maxInstances < numInstances){
+		batch.maxInstances *= 2;
+	}
+
+	batch.buffer.clearAll();
+	batch.buffer.addAttribute(AttributeType::INSTANCEMATRIXCOL1, 4, 0, true);
+	batch.buffer.addAttribute(AttributeType::INSTANCEMATRIXCOL2, 4, 4 * sizeof(float), true);
+	batch.buffer.addAttribute(AttributeType::INSTANCEMATRIXCOL3, 4, 8 * sizeof(float), true);
+	batch.buffer.addAttribute(AttributeType::INSTANCEMATRIXCOL4, 4, 12 * sizeof(float), true);
+	batch.buffer.addAttribute(AttributeType::INSTANCECOLOR, 4, 16 * sizeof(float), true);
+	batch.buffer.addAttribute(AttributeType::INSTANCETEXTURERECT, 4, 20 * sizeof(float), true);
+	batch.buffer.setStride(24 * sizeof(float));
+	batch.buffer.setRenderAttributes(true);
+	batch.buffer.setInstanceBuffer(true);
+	batch.buffer.setUsage(BufferUsage::STREAM);
+
+	batch.buffer.getRender()->createBuffer(batch.maxInstances * batch.buffer.getStride(), nullptr, batch.buffer.getType(), batch.buffer.getUsage());
+
+	batch.numSubmeshes = mesh.numSubmeshes;
+
+	for (int i = 0; i < mesh.numSubmeshes; i++){
+		AutoInstancingSubmesh& submesh = batch.submeshes[i];
+		ObjectRender& render = submesh.render;
+
+		render.beginLoad(mesh.submeshes[i].primitiveType);
+
+		// same mesh shader with instancing
+		submesh.shaderProperties = mesh.submeshes[i].shaderProperties | SHD_INSTANCING;
+		submesh.shader = ShaderPool::get(ShaderType::MESH, submesh.shaderProperties);
+		if (!submesh.shader->isCreated())
+			return false;
+		render.addShader(submesh.shader.get());
+		ShaderData& shaderData = submesh.shader.get()->shaderData;
+
+		submesh.slotVSParams = shaderData.getUniformBlockIndex(UniformBlockType::PBR_VS_PARAMS, ShaderStageType::VERTEX);
+		submesh.slotFSParams = shaderData.getUniformBlockIndex(UniformBlockType::PBR_FS_PARAMS, ShaderStageType::FRAGMENT);
+		if (hasFog){
+			submesh.slotFSFog = shaderData.getUniformBlockIndex(UniformBlockType::FS_FOG, ShaderStageType::FRAGMENT);
+		}
+		if (hasLights){
+			submesh.slotFSLighting = shaderData.getUniformBlockIndex(UniformBlockType::FS_LIGHTING, ShaderStageType::FRAGMENT);
+			if (hasShadows && mesh.receiveShadows){
+				submesh.slotVSShadows = shaderData.getUniformBlockIndex(UniformBlockType::VS_SHADOWS, ShaderStageType::VERTEX);
+				submesh.slotFSShadows = shaderData.getUniformBlockIndex(UniformBlockType::FS_SHADOWS, ShaderStageType::FRAGMENT);
+			}
+		}
+
+		loadPBRTextures(mesh.submeshes[i].material, shaderData, render, mesh.receiveShadows);
+
+		for (auto const& buf : buffers){
+			if (buf.second->isRenderAttributes()) {
+				if (buf.second->getType() == BufferType::INDEX_BUFFER){
+					Attribute indexattr = buf.second->getAttributes()[AttributeType::INDEX];
+					render.addIndex(buf.second->getRender(), indexattr.getDataType(), indexattr.getOffset());
+				}else{
+					for (auto const &attr : buf.second->getAttributes()) {
+						render.addAttribute(shaderData.getAttrIndex(attr.first), buf.second->getRender(), attr.second.getElements(), attr.second.getDataType(), buf.second->getStride(), attr.second.getOffset(), attr.second.getNormalized(), attr.second.getPerInstance());
+					}
+				}
+			}
+		}
+
+		for (auto const& attr : mesh.submeshes[i].attributes){
+			if (bufferNameToRender.count(attr.second.getBuffer())){
+				if (attr.first == AttributeType::INDEX){
+					render.addIndex(bufferNameToRender[attr.second.getBuffer()], attr.second.getDataType(), attr.second.getOffset());
+				}else{
+					render.addAttribute(shaderData.getAttrIndex(attr.first), bufferNameToRender[attr.second.getBuffer()], attr.second.getElements(), attr.second.getDataType(), bufferStride[attr.second.getBuffer()], attr.second.getOffset(), attr.second.getNormalized(), attr.second.getPerInstance());
+				}
+			}
+		}
+
+		for (auto const &attr : batch.buffer.getAttributes()) {
+			render.addAttribute(shaderData.getAttrIndex(attr.first), batch.buffer.getRender(), attr.second.getElements(), attr.second.getDataType(), batch.buffer.getStride(), attr.second.getOffset(), attr.second.getNormalized(), attr.second.getPerInstance());
+		}
+
+		if (!render.endLoad((renderToTexture)?PIP_RTT:PIP_DEFAULT, mesh.submeshes[i].enableFaceCulling, mesh.cullingMode, mesh.windingOrder)){
+			return false;
+		}
+	}
+
+	batch.loaded = true;
+
+	return true;
+}
+
+bool RenderSystem::drawAutoInstancing(AutoInstancingBatch& batch, MeshComponent& mesh, CameraComponent& camera, bool renderToTexture){
+	if (!batch.loaded || batch.instances.empty())
+		return false;
+
+	batch.buffer.setData((unsigned char*)(&batch.instances.at(0)), sizeof(InstanceRenderData) * batch.instances.size());
+	batch.buffer.getRender()->updateBuffer(batch.buffer.getSize(), batch.buffer.getData());
+
+	// model and normal matrices are in instances: identity, identity and view projection
+	Matrix4 vsParams[3];
+	vsParams[2] = camera.viewProjectionMatrix;
+
+	for (int i = 0; i < batch.numSubmeshes; i++){
+		AutoInstancingSubmesh& submesh = batch.submeshes[i];
+		ObjectRender& render = submesh.render;
+
+		if (scene->isSceneAmbientLightEnabled()){
+			mesh.submeshes[i].material.ambientFactor = scene->getAmbientLightFactor();
+			mesh.submeshes[i].material.ambientLight = scene->getAmbientLightColor();
+		}
+
+		if (!render.beginDraw((renderToTexture)?PIP_RTT:PIP_DEFAULT)){
+			destroyAutoInstancing(batch);
+			return false;
+		}
+
+		if (hasFog){
+			render.applySharedUniformBlock(submesh.slotFSFog, ShaderStageType::FRAGMENT, sizeof(float) * 8, &fs_fog);
+		}
+
+		if (hasLights){
+			render.applySharedUniformBlock(submesh.slotFSLighting, ShaderStageType::FRAGMENT, sizeof(float) * (16 * MAX_LIGHTS + 4), &fs_lighting);
+			if (hasShadows && mesh.receiveShadows){
+				render.applySharedUniformBlock(submesh.slotVSShadows, ShaderStageType::VERTEX, sizeof(float) * (16 * MAX_SHADOWSMAP), &vs_shadows);
+				render.applySharedUniformBlock(submesh.slotFSShadows, ShaderStageType::FRAGMENT, sizeof(float) * (4 * (MAX_SHADOWSMAP + MAX_SHADOWSCUBEMAP)), &fs_shadows);
+			}
+			render.applyUniformBlock(submesh.slotFSParams, ShaderStageType::FRAGMENT, sizeof(float) * 16, &mesh.submeshes[i].material);
+		}else{
+			render.applyUniformBlock(submesh.slotFSParams, ShaderStageType::FRAGMENT, sizeof(float) * 4, &mesh.submeshes[i].material);
+		}
+
+		render.applyUniformBlock(submesh.slotVSParams, ShaderStageType::VERTEX, sizeof(float) * 48, vsParams);
+
+		render.draw(mesh.submeshes[i].vertexCount, batch.instances.size());
+	}
+
+	return true;
+}
+
+void RenderSystem::destroyAutoInstancing(AutoInstancingBatch& batch){
+	for (int i = 0; i < batch.numSubmeshes; i++){
+		AutoInstancingSubmesh& submesh = batch.submeshes[i];
+
+		submesh.render.destroy();
+
+		if (submesh.shader){
+			submesh.shader.reset();
+			ShaderPool::remove(ShaderType::MESH, submesh.shaderProperties);
+		}
+
+		submesh.slotVSParams = -1;
+		submesh.slotFSParams = -1;
+		submesh.slotFSLighting = -1;
+		submesh.slotFSFog = -1;
+		submesh.slotVSShadows = -1;
+		submesh.slotFSShadows = -1;
+	}
+
+	if (batch.maxInstances > 0){
+		batch.buffer.getRender()->destroyBuffer();
+	}
+
+	batch.source = NULL_ENTITY;
+	batch.numSubmeshes = 0;
+	batch.maxInstances = 0;
+	batch.loaded = false;
+}
+
+uint64_t RenderSystem::getTransparentDrawKey(Transform& transform){
+	// bits of a positive float keep its order as integer, inverted to sort back to front
+	float distance = std::max(0.0f, transform.distanceToCamera);
+	uint32_t distanceBits;
+	memcpy(&distanceBits, &distance, sizeof(distanceBits));
+
+	return (uint64_t)(~distanceBits);
+}
+
+bool RenderSystem::drawMeshDepth(Entity entity, MeshComponent& mesh, const float cameraFar, const Plane frustumPlanes[6], vs_depth_t vsDepthParams, InstancedMeshComponent* instmesh, TerrainComponent* terrain){
 	if (mesh.loaded && mesh.castShadows){
 
 		if (mesh.worldAABB != AABB::ZERO && !isInsideCamera(cameraFar, frustumPlanes, mesh.worldAABB)) {
 			return false;
 		}
 
+		SkinningComponent* skinning = scene->findComponent<SkinningComponent>(entity);
+		MorphTargetComponent* morphTarget = scene->findComponent<MorphTargetComponent>(entity);
+
 		for (int i = 0; i < mesh.numSubmeshes; i++){
 			ObjectRender& depthRender = mesh.submeshes[i].depthRender;
 
 			if (mesh.submeshes[i].needUpdateTexture && mesh.submeshes[i].hasDepthTexture){
 				ShaderData& depthShaderData = mesh.submeshes[i].depthShader.get()->shaderData;
 				loadDepthTexture(mesh.submeshes[i].material, depthShaderData, mesh.submeshes[i].depthRender);
+				mesh.shadowChangedFrame = frameCount;
 			}
 
 			if (!depthRender.beginDraw(PIP_DEPTH)){
@@ -1047,14 +1531,14 @@ bool RenderSystem::drawMeshDepth(MeshComponent& mesh, const float cameraFar, con
 			//model, mvp matrix
 			depthRender.applyUniformBlock(mesh.submeshes[i].slotVSDepthParams, ShaderStageType::VERTEX, sizeof(float) * 32, &vsDepthParams);
 
-			if (mesh.submeshes[i].hasSkinning){
-				depthRender.applyUniformBlock(mesh.submeshes[i].slotVSDepthSkinning, ShaderStageType::VERTEX, sizeof(float) * 16 * MAX_BONES + (sizeof(float) * 4), &mesh.bonesMatrix);
+			if (mesh.submeshes[i].hasSkinning && skinning){
+				depthRender.applySharedUniformBlock(mesh.submeshes[i].slotVSDepthSkinning, ShaderStageType::VERTEX, sizeof(float) * 16 * MAX_BONES + (sizeof(float) * 4), &skinning->bonesMatrix);
 			}
-			if (mesh.submeshes[i].hasMorphTarget){
+			if (mesh.submeshes[i].hasMorphTarget && morphTarget){
 				if (!mesh.submeshes[i].hasMorphNormal && !mesh.submeshes[i].hasMorphTangent){
-					depthRender.applyUniformBlock(mesh.submeshes[i].slotVSDepthMorphTarget, ShaderStageType::VERTEX, sizeof(float) * MAX_MORPHTARGETS, &mesh.morphWeights);
+					depthRender.applySharedUniformBlock(mesh.submeshes[i].slotVSDepthMorphTarget, ShaderStageType::VERTEX, sizeof(float) * MAX_MORPHTARGETS, &morphTarget->morphWeights);
 				}else{
-					depthRender.applyUniformBlock(mesh.submeshes[i].slotVSDepthMorphTarget, ShaderStageType::VERTEX, sizeof(float) * MAX_MORPHTARGETS / 2, &mesh.morphWeights);
+					depthRender.applySharedUniformBlock(mesh.submeshes[i].slotVSDepthMorphTarget, ShaderStageType::VERTEX, sizeof(float) * MAX_MORPHTARGETS / 2, &morphTarget->morphWeights);
 				}
 			}
 
@@ -1069,6 +1553,200 @@ bool RenderSystem::drawMeshDepth(MeshComponent& mesh, const float cameraFar, con
 	return true;
 }
 
+void RenderSystem::resetShadowsCache(LightComponent& light){
+	for (int c = 0; c < 6; c++){
+		light.cameras[c].drawnStaticVersion = 0;
+		light.cameras[c].drawnDynamicCasters = false;
+	}
+	light.nextShadowFace = 0;
+}
+
+void RenderSystem::loadShadowCopy(){
+	shadowCopyLoaded = true;
+
+	shadowCopyShader = ShaderPool::get(ShaderType::DEPTH, ShaderProperty::SHD_DEPTH_COPY);
+	if (!shadowCopyShader->isCreated()){
+		Log::warn("Shader depth_Dcp to copy shadow maps not found, static and dynamic casters are drawn together");
+		return;
+	}
+
+	// fullscreen triangle without buffers, texture is the static map of each draw
+	shadowCopyRender.beginLoad(PrimitiveType::TRIANGLES);
+	shadowCopyRender.addShader(shadowCopyShader.get());
+	slotShadowCopyTexture = shadowCopyShader.get()->shaderData.getTextureIndex(TextureShaderType::DEPTHTEXTURE, ShaderStageType::FRAGMENT);
+
+	hasShadowCopy = shadowCopyRender.endLoad(PIP_DEPTH, false, CullingMode::BACK, WindingOrder::CCW);
+}
+
+void RenderSystem::classifyShadowCasters(){
+	staticShadowCasters.clear();
+	dynamicShadowCasters.clear();
+
+	bool shadowsCache = scene->isShadowsCache();
+	uint64_t hash = hashValue(shadowsCache);
+
+	auto meshesView = scene->view<MeshComponent, Transform>();
+	meshesView.each([&](Entity entity, MeshComponent& mesh, Transform& transform){
+		if (!transform.visible || !mesh.loaded || !mesh.castShadows)
+			return;
+
+		ShadowCasterData caster = {&mesh, scene->findComponent<InstancedMeshComponent>(entity), scene->findComponent<TerrainComponent>(entity), &transform, entity};
+
+		// animated, instanced and terrain (LOD by camera) casters are drawn every time
+		bool isStatic = shadowsCache && !caster.instmesh && !caster.terrain && (frameCount - mesh.shadowChangedFrame) > SHADOWCASTER_STATIC_FRAMES;
+		for (int i = 0; i < mesh.numSubmeshes && isStatic; i++){
+			if (mesh.submeshes[i].hasSkinning || mesh.submeshes[i].hasMorphTarget){
+				isStatic = false;
+			}
+		}
+
+		if (isStatic){
+			staticShadowCasters.push_back(caster);
+			hash = hashCombine(hash, entity);
+		}else{
+			dynamicShadowCasters.push_back(caster);
+		}
+	});
+
+	hash = hashCombine(hash, staticShadowCasters.size());
+
+	// static casters were added, removed or changed
+	if (hash != staticShadowsHash){
+		staticShadowsHash = hash;
+		staticShadowsVersion++;
+	}
+}
+
+bool RenderSystem::hasShadowCastersInCamera(const std::vector<ShadowCasterData>& casters, LightCamera& camera){
+	for (const ShadowCasterData& caster : casters){
+		if (caster.mesh->worldAABB == AABB::ZERO || isInsideCamera(camera.nearFar.y, camera.frustumPlanes, caster.mesh->worldAABB)){
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void RenderSystem::drawShadowCasters(const std::vector<ShadowCasterData>& casters, LightCamera& camera){
+	for (const ShadowCasterData& caster : casters){
+		Transform& transform = *caster.transform;
+
+		vs_depth_t vsDepthParams;
+
+		if (transform.billboard && caster.mesh->enableShadowsBillboard){
+			Matrix4 modelViewMatrix = camera.lightViewMatrix * transform.modelMatrix;
+
+			modelViewMatrix.set(0, 0, transform.worldScale.x);
+			modelViewMatrix.set(0, 1, 0.0);
+			modelViewMatrix.set(0, 2, 0.0);
+
+			if (!transform.cylindricalBillboard) {
+				modelViewMatrix.set(1, 0, 0.0);
+				modelViewMatrix.set(1, 1, transform.worldScale.y);
+				modelViewMatrix.set(1, 2, 0.0);
+			}
+
+			modelViewMatrix.set(2, 0, 0.0);
+			modelViewMatrix.set(2, 1, 0.0);
+			modelViewMatrix.set(2, 2, transform.worldScale.z);
+
+			vsDepthParams = {modelViewMatrix, camera.lightProjectionMatrix};
+		}else{
+			vsDepthParams = {transform.modelMatrix, camera.lightViewProjectionMatrix};
+		}
+
+		drawMeshDepth(caster.entity, *caster.mesh, camera.nearFar.y, camera.frustumPlanes, vsDepthParams, caster.instmesh, caster.terrain);
+	}
+}
+
+void RenderSystem::drawShadowMap(LightComponent& light, size_t c){
+	LightCamera& camera = light.cameras[c];
+
+	bool staticChanged = (camera.drawnStaticVersion != staticShadowsVersion) || !(camera.drawnViewProjectionMatrix == camera.lightViewProjectionMatrix);
+	bool hasDynamic = hasShadowCastersInCamera(dynamicShadowCasters, camera);
+
+	// shadow map is the same of last draw
+	if (!staticChanged && !hasDynamic && !camera.drawnDynamicCasters){
+		return;
+	}
+
+	camera.render.setClearColor(Vector4(1.0, 1.0, 1.0, 1.0));
+
+	if (hasShadowCopy && !staticShadowCasters.empty()){
+		FramebufferRender& staticFramebuffer = light.staticFramebuffer[c];
+
+		if (!staticFramebuffer.isCreated()){
+			staticFramebuffer.createFramebuffer(
+					TextureType::TEXTURE_2D, light.mapResolution, light.mapResolution, 
+					TextureFilter::LINEAR, TextureFilter::LINEAR, TextureWrap::CLAMP_TO_BORDER, TextureWrap::CLAMP_TO_BORDER, true);
+			staticChanged = true;
+		}
+
+		if (staticChanged){
+			camera.render.startFrameBuffer(&staticFramebuffer);
+			drawShadowCasters(staticShadowCasters, camera);
+			camera.render.endFrameBuffer();
+		}
+
+		camera.render.startFrameBuffer(&light.framebuffer[c]);
+
+		// color and depth of static casters, dynamic casters are tested against them
+		shadowCopyRender.addTexture(slotShadowCopyTexture, ShaderStageType::FRAGMENT, &staticFramebuffer.getColorTexture());
+		if (shadowCopyRender.beginDraw(PIP_DEPTH)){
+			shadowCopyRender.draw(3, 1);
+		}
+
+		drawShadowCasters(dynamicShadowCasters, camera);
+		camera.render.endFrameBuffer();
+	}else{
+		camera.render.startFrameBuffer(&light.framebuffer[c]);
+		drawShadowCasters(staticShadowCasters, camera);
+		drawShadowCasters(dynamicShadowCasters, camera);
+		camera.render.endFrameBuffer();
+	}
+
+	camera.drawnStaticVersion = staticShadowsVersion;
+	camera.drawnViewProjectionMatrix = camera.lightViewProjectionMatrix;
+	camera.drawnDynamicCasters = hasDynamic;
+}
+
+void RenderSystem::drawShadowCubeMap(LightComponent& light){
+	// faces are not composed with a static map, changed faces are drawn in turns
+	size_t maxFaces = (scene->isShadowsCache()) ? MAX_SHADOWCUBEFACES_UPDATE : 6;
+	size_t drawnFaces = 0;
+
+	for (size_t i = 0; i < 6; i++){
+		size_t face = (light.nextShadowFace + i) % 6;
+		LightCamera& camera = light.cameras[face];
+
+		bool staticChanged = (camera.drawnStaticVersion != staticShadowsVersion) || !(camera.drawnViewProjectionMatrix == camera.lightViewProjectionMatrix);
+		bool hasDynamic = hasShadowCastersInCamera(dynamicShadowCasters, camera);
+
+		if (!staticChanged && !hasDynamic && !camera.drawnDynamicCasters){
+			continue;
+		}
+
+		// faces never drawn are not limited
+		if (camera.drawnStaticVersion != 0 && drawnFaces >= maxFaces){
+			continue;
+		}
+
+		camera.render.setClearColor(Vector4(1.0, 1.0, 1.0, 1.0));
+
+		camera.render.startFrameBuffer(&light.framebuffer[0], face);
+		drawShadowCasters(staticShadowCasters, camera);
+		drawShadowCasters(dynamicShadowCasters, camera);
+		camera.render.endFrameBuffer();
+
+		camera.drawnStaticVersion = staticShadowsVersion;
+		camera.drawnViewProjectionMatrix = camera.lightViewProjectionMatrix;
+		camera.drawnDynamicCasters = hasDynamic;
+
+		light.nextShadowFace = (face + 1) % 6;
+		drawnFaces++;
+	}
+}
+
 void RenderSystem::destroyMesh(Entity entity, MeshComponent& mesh){
 	InstancedMeshComponent* instmesh = scene->findComponent<InstancedMeshComponent>(entity);
 	TerrainComponent* terrain = scene->findComponent<TerrainComponent>(entity);
@@ -1076,6 +1754,18 @@ void RenderSystem::destroyMesh(Entity entity, MeshComponent& mesh){
 	if (!mesh.loaded)
 		return;
 
+	// batches are using buffers of this mesh
+	if (mesh.instancingKey != 0){
+		for (auto it = autoInstancingBatches.begin(); it != autoInstancingBatches.end();){
+			if (it->second.source == entity){
+				destroyAutoInstancing(it->second);
+				it = autoInstancingBatches.erase(it);
+			}else{
+				++it;
+			}
+		}
+	}
+
 	for (int i = 0; i < mesh.numSubmeshes; i++){
 
 		Submesh& submesh = mesh.submeshes[i];
@@ -1138,9 +1828,12 @@ void RenderSystem::destroyMesh(Entity entity, MeshComponent& mesh){
 	mesh.buffer.getRender()->destroyBuffer();
 	//mesh.indices.clearAll();
 	mesh.indices.getRender()->destroyBuffer();
-	for (int i = 0; i < mesh.numExternalBuffers; i++){
+	for (int i = 0; i < mesh.eBuffers.size(); i++){
 		//mesh.eBuffers[i].clearAll();
-		mesh.eBuffers[i].getRender()->destroyBuffer();
+		// also previous model buffers, external buffers can be changed before reload
+		if (!mesh.eBuffers[i].releaseSharedRender() && i < mesh.numExternalBuffers){
+			mesh.eBuffers[i].getRender()->destroyBuffer();
+		}
 	}
 
 	SystemRender::addQueueCommand(&changeDestroy, new check_load_t{scene, entity});
@@ -1157,6 +1850,12 @@ bool RenderSystem::loadUI(Entity entity, UIComponent& uirender, uint8_t pipeline
 
 	TextureRender* textureRender = uirender.texture.getRender();
 
+	if (Engine::isAutomaticTransparency() && !uirender.transparent){
+		if (isText || uirender.texture.isTransparent()){ // UI color is tested when drawing
+			uirender.transparent = true;
+		}
+	}
+
 	bool p_hasTexture = false;
 	bool p_vertexColorVec4 = true;
 	bool p_hasFontAtlasTexture = false;
@@ -1408,6 +2107,15 @@ bool RenderSystem::loadLines(Entity entity, LinesComponent& lines, uint8_t pipel
 
 	lines.buffer.setData((unsigned char*)(&lines.lines.at(0)), sizeof(LineData)*lines.lines.size());
 
+	if (Engine::isAutomaticTransparency() && !lines.transparent){
+		for (auto const& line : lines.lines){
+			if (line.colorA.w != 1.0 || line.colorB.w != 1.0){
+				lines.transparent = true;
+				break;
+			}
+		}
+	}
+
 	size_t bufferSize = lines.maxLines * lines.buffer.getStride();
 
 	if (bufferSize == 0)
@@ -1584,7 +2292,7 @@ bool RenderSystem::loadSky(Entity entity, SkyComponent& sky, uint8_t pipelines){
 
 	render->beginLoad(PrimitiveType::TRIANGLES);
 
-	sky.shader = ShaderPool::get(ShaderType::SKYBOX, "");
+	sky.shader = ShaderPool::get(ShaderType::SKYBOX, 0);
 	if (!sky.shader->isCreated())
 		return false;
 	render->addShader(sky.shader.get());
@@ -1652,7 +2360,7 @@ void RenderSystem::destroySky(Entity entity, SkyComponent& sky){
 
 	//Destroy shader
 	sky.shader.reset();
-	ShaderPool::remove(ShaderType::SKYBOX, "");
+	ShaderPool::remove(ShaderType::SKYBOX, 0);
 
 	//Destroy texture
 	sky.texture.destroy();
@@ -1674,7 +2382,10 @@ void RenderSystem::destroySky(Entity entity, SkyComponent& sky){
 void RenderSystem::destroyLight(LightComponent& light){
 	for (int i = 0; i < MAX_SHADOWCASCADES; i++) {
 		light.framebuffer[i].destroyFramebuffer();
+		light.staticFramebuffer[i].destroyFramebuffer();
 	}
+
+	resetShadowsCache(light);
 }
 
 void RenderSystem::destroyCamera(CameraComponent& camera, bool entityDestroyed){
@@ -1779,6 +2490,88 @@ void RenderSystem::updateTransform(Transform& transform){
 	}
 }
 
+void RenderSystem::updateTransforms(){
+	std::vector<Entity>& dirtyTransforms = scene->getDirtyTransforms();
+
+	auto transforms = scene->getComponentArray<Transform>();
+	const size_t none = ComponentArray<Transform>::NULL_INDEX;
+	size_t size = transforms->size();
+
+	dirtyTransformIndexes.clear();
+	for (Entity entity : dirtyTransforms){
+		size_t index = transforms->findIndex(entity);
+		if (index != none){
+			dirtyTransformIndexes.push_back(index);
+		}
+	}
+	dirtyTransforms.clear();
+
+	if (dirtyTransformIndexes.empty())
+		return;
+
+	// parents are always before children, so each subtree is a contiguous range after its root
+	std::sort(dirtyTransformIndexes.begin(), dirtyTransformIndexes.end());
+
+	for (auto& level : transformLevels){
+		level.clear();
+	}
+
+	size_t visitedEnd = 0;
+	for (size_t root : dirtyTransformIndexes){
+		if (root < visitedEnd)
+			continue; // inside an already visited subtree
+
+		subtreeDepths.clear();
+		subtreeDepths.push_back(0);
+
+		size_t i = root;
+		while (i < size){
+			Transform& transform = transforms->getComponentFromIndex(i);
+			size_t depth = 0;
+
+			if (i > root){
+				size_t parentIndex = transforms->findIndex(transform.parent);
+				if (parentIndex == none || parentIndex < root)
+					break; // end of subtree
+
+				Transform& transformParent = transforms->getComponentFromIndex(parentIndex);
+
+				if (transformParent.needUpdate){
+					transform.needUpdate = true;
+				}
+
+				if (transformParent.needUpdateChildVisibility){
+					transform.visible = transformParent.visible;
+					transform.needUpdateChildVisibility = true;
+				}
+
+				depth = subtreeDepths[parentIndex - root] + 1;
+				subtreeDepths.push_back(depth);
+			}
+
+			if (transform.needUpdate){
+				if (depth >= transformLevels.size()){
+					transformLevels.resize(depth + 1);
+				}
+				transformLevels[depth].push_back(i);
+			}
+
+			i++;
+		}
+
+		visitedEnd = i;
+	}
+
+	// matrices of the same level only depend on already updated parents
+	for (auto& level : transformLevels){
+		JobSystem::parallelFor(level.size(), 128, [&](size_t start, size_t end){
+			for (size_t l = start; l < end; l++){
+				updateTransform(transforms->getComponentFromIndex(level[l]));
+			}
+		});
+	}
+}
+
 void RenderSystem::updateCamera(CameraComponent& camera, Transform& transform){
 	//Update ProjectionMatrix
 	if (camera.type == CameraType::CAMERA_2D){
@@ -2533,26 +3326,7 @@ void RenderSystem::update(double dt){
 	auto transforms = scene->getComponentArray<Transform>();
 	auto cameras = scene->getComponentArray<CameraComponent>();
 
-	for (int i = 0; i < transforms->size(); i++){
-		Transform& transform = transforms->getComponentFromIndex(i);
-
-		if (transform.parent != NULL_ENTITY){
-			Transform& transformParent = scene->getComponent<Transform>(transform.parent);
-
-			if (transformParent.needUpdate){
-				transform.needUpdate = true;
-			}
-
-			if (transformParent.needUpdateChildVisibility){
-				transform.visible = transformParent.visible;
-				transform.needUpdateChildVisibility = true;
-			}
-		}
-
-		if (transform.needUpdate){
-			updateTransform(transform);
-		}
-	}
+	updateTransforms();
 
 	Entity mainCameraEntity = scene->getCamera();
 	uint8_t pipelines = 0;
@@ -2602,7 +3376,7 @@ void RenderSystem::update(double dt){
 		if (sky.loaded && sky.needReload){
 			destroySky(entity, sky);
 		}
-		if (!sky.loadCalled){
+		if (!sky.loadCalled && (!Engine::isAsyncLoading() || sky.texture.loadAsync())){
 			loadSky(entity, sky, pipelines);
 		}
 	}
@@ -2641,7 +3415,11 @@ void RenderSystem::update(double dt){
 				destroyMesh(entity, mesh);
 			}
 			if (!mesh.loadCalled){
-				loadMesh(entity, mesh, pipelines, instmesh, terrain);
+				// with async loading, mesh is created after its textures are decoded, closest to camera first
+				float priority = (transform.worldPosition - mainCameraTransform.worldPosition).length();
+				if (!Engine::isAsyncLoading() || loadMeshTexturesAsync(mesh, priority)){
+					loadMesh(entity, mesh, pipelines, instmesh, terrain);
+				}
 			}
 		}else if (signature.test(scene->getComponentType<UIComponent>())){
 			UIComponent& ui = scene->getComponent<UIComponent>(entity);
@@ -2653,7 +3431,7 @@ void RenderSystem::update(double dt){
 				if (ui.loaded && ui.needReload){
 					destroyUI(entity, ui);
 				}
-				if (!ui.loadCalled){
+				if (!ui.loadCalled && (!Engine::isAsyncLoading() || ui.texture.loadAsync())){
 					loadUI(entity, ui, pipelines, isText);
 				}
 			}
@@ -2662,7 +3440,7 @@ void RenderSystem::update(double dt){
 			if (points.loaded && points.needReload){
 				destroyPoints(entity, points);
 			}
-			if (!points.loadCalled){
+			if (!points.loadCalled && (!Engine::isAsyncLoading() || points.texture.loadAsync())){
 				loadPoints(entity, points, pipelines);
 			}
 		}else if (signature.test(scene->getComponentType<LinesComponent>())){
@@ -2709,6 +3487,7 @@ void RenderSystem::update(double dt){
 				MeshComponent& mesh = scene->getComponent<MeshComponent>(entity);
 
 				mesh.worldAABB = transform.localMatrix * mesh.aabb;
+				mesh.shadowChangedFrame = frameCount;
 			}
 
 			if (signature.test(scene->getComponentType<ModelComponent>())){
@@ -2722,12 +3501,10 @@ void RenderSystem::update(double dt){
 
 				if (bone.model != NULL_ENTITY){
 					ModelComponent& model = scene->getComponent<ModelComponent>(bone.model);
-					MeshComponent& mesh = scene->getComponent<MeshComponent>(bone.model);
-
-					Matrix4 skinning = model.inverseDerivedTransform * transform.modelMatrix * bone.offsetMatrix;
+					SkinningComponent* skinning = scene->findComponent<SkinningComponent>(bone.model);
 
-					if (bone.index >= 0 && bone.index < MAX_BONES)
-						mesh.bonesMatrix[bone.index] = skinning;
+					if (skinning && bone.index >= 0 && bone.index < MAX_BONES)
+						skinning->bonesMatrix[bone.index] = model.inverseDerivedTransform * transform.modelMatrix * bone.offsetMatrix;
 				}
 			}
 
@@ -2766,7 +3543,7 @@ void RenderSystem::update(double dt){
 }
 
 void RenderSystem::draw(){
-	std::priority_queue<TransparentMeshesData, std::vector<TransparentMeshesData>, MeshComparison> transparentMeshes;
+	frameCount++;
 
 	auto transforms = scene->getComponentArray<Transform>();
 	auto cameras = scene->getComponentArray<CameraComponent>();
@@ -2774,70 +3551,25 @@ void RenderSystem::draw(){
 	//---------Depth shader----------
 	if (hasShadows){
 		auto lights = scene->getComponentArray<LightComponent>();
-		auto meshes = scene->getComponentArray<MeshComponent>();
-		auto terrains = scene->getComponentArray<TerrainComponent>();
+
+		if (!shadowCopyLoaded && scene->isShadowsCache()){
+			loadShadowCopy();
+		}
+
+		classifyShadowCasters();
 		
 		for (int l = 0; l < lights->size(); l++){
 			LightComponent& light = lights->getComponentFromIndex(l);
 
 			if (light.intensity > 0 && light.shadows){
-				size_t cameras = 1;
 				if (light.type == LightType::POINT){
-					cameras = 6;
+					drawShadowCubeMap(light);
 				}else if (light.type == LightType::DIRECTIONAL){
-					cameras = light.numShadowCascades;
-				}
-
-				for (int c = 0; c < cameras; c++){
-					size_t face = 0;
-					size_t fb = c;
-					if (light.type == LightType::POINT){
-						face = c;
-						fb = 0;
-					}
-					light.cameras[c].render.setClearColor(Vector4(1.0, 1.0, 1.0, 1.0));
-
-					light.cameras[c].render.startFrameBuffer(&light.framebuffer[fb], face);
-					for (int i = 0; i < meshes->size(); i++){
-						MeshComponent& mesh = meshes->getComponentFromIndex(i);
-						Entity entity = meshes->getEntity(i);
-						Transform* transform = scene->findComponent<Transform>(entity);
-
-						if (transform){
-							if (transform->visible){
-								InstancedMeshComponent* instmesh = scene->findComponent<InstancedMeshComponent>(entity);
-								TerrainComponent* terrain = scene->findComponent<TerrainComponent>(entity);
-
-								vs_depth_t vsDepthParams;
-
-								if (transform->billboard && mesh.enableShadowsBillboard){
-									Matrix4 modelViewMatrix = light.cameras[c].lightViewMatrix * transform->modelMatrix;
-
-									modelViewMatrix.set(0, 0, transform->worldScale.x);
-									modelViewMatrix.set(0, 1, 0.0);
-									modelViewMatrix.set(0, 2, 0.0);
-
-									if (!transform->cylindricalBillboard) {
-										modelViewMatrix.set(1, 0, 0.0);
-										modelViewMatrix.set(1, 1, transform->worldScale.y);
-										modelViewMatrix.set(1, 2, 0.0);
-									}
-
-									modelViewMatrix.set(2, 0, 0.0);
-									modelViewMatrix.set(2, 1, 0.0);
-									modelViewMatrix.set(2, 2, transform->worldScale.z);
-
-									vsDepthParams = {modelViewMatrix, light.cameras[c].lightProjectionMatrix};
-								}else{
-									vsDepthParams = {transform->modelMatrix, light.cameras[c].lightViewProjectionMatrix};
-								}
-
-								drawMeshDepth(mesh, light.cameras[c].nearFar.y, light.cameras[c].frustumPlanes, vsDepthParams, instmesh, terrain);
-							}
-						}
+					for (int c = 0; c < light.numShadowCascades; c++){
+						drawShadowMap(light, c);
 					}
-
-					light.cameras[c].render.endFrameBuffer();
+				}else{
+					drawShadowMap(light, 0);
 				}
 			}
 		}
@@ -2871,6 +3603,13 @@ void RenderSystem::draw(){
 		//---------Draw opaque meshes and UI----------
 		bool hasActiveScissor = false;
 
+		// 2D order depends on hierarchy, other cameras sort opaque meshes by render state
+		bool sortOpaqueMeshes = camera.type != CameraType::CAMERA_2D;
+		// points, lines and UI are also sorted with transparent meshes, out of 2D
+		bool sortTransparentPrimitives = camera.transparentSort && camera.type != CameraType::CAMERA_2D;
+		opaqueMeshes.clear();
+		transparentDraws.clear();
+
 		//---------Draw sky----------
 		auto skys = scene->getComponentArray<SkyComponent>();
 		if (skys->size() > 0){
@@ -2953,21 +3692,27 @@ void RenderSystem::draw(){
 
 					if (!mesh.transparent || !camera.transparentSort){
 						//Draw opaque meshes if transparency is not necessary
-						drawMesh(mesh, transform, camera, cameraTransform, camera.renderToTexture, instmesh, terrain);
+						if (sortOpaqueMeshes && !hasActiveScissor && mesh.loaded && mesh.numSubmeshes > 0){
+							opaqueMeshes.push_back({getMeshDrawKey(mesh, transform, camera), &mesh, instmesh, terrain, &transform, entity, nullptr});
+						}else{
+							drawMesh(entity, mesh, transform, camera, cameraTransform, camera.renderToTexture, instmesh, terrain);
+						}
 					}else{
-						transparentMeshes.push({&mesh, instmesh, terrain, &transform, transform.distanceToCamera});
+						transparentDraws.push_back({getTransparentDrawKey(transform), &mesh, instmesh, terrain, nullptr, nullptr, nullptr, &transform, entity});
 					}
 				}
 
 			}else if (signature.test(scene->getComponentType<UIComponent>())){
 				UIComponent& ui = scene->getComponent<UIComponent>(entity);
 
-				bool isText = false;
-				if (signature.test(scene->getComponentType<TextComponent>())){
-					isText = true;
+				if (transform.visible){
+					if ((ui.transparent || ui.color.w != 1.0) && sortTransparentPrimitives && !hasActiveScissor){
+						transparentDraws.push_back({getTransparentDrawKey(transform), nullptr, nullptr, nullptr, nullptr, nullptr, &ui, &transform, entity});
+					}else{
+						drawOpaqueMeshes(camera, cameraEntity, cameraTransform);
+						drawUI(ui, transform, camera.renderToTexture);
+					}
 				}
-				if (transform.visible)
-					drawUI(ui, transform, camera.renderToTexture);
 
 			}else if (signature.test(scene->getComponentType<PointsComponent>())){
 				PointsComponent& points = scene->getComponent<PointsComponent>(entity);
@@ -2978,14 +3723,26 @@ void RenderSystem::draw(){
 					sortPoints(points, transform, camera, cameraTransform);
 				}
 
-				if (transform.visible)
-					drawPoints(points, transform, cameraTransform, camera.renderToTexture);
+				if (transform.visible){
+					if (points.transparent && sortTransparentPrimitives && !hasActiveScissor){
+						transparentDraws.push_back({getTransparentDrawKey(transform), nullptr, nullptr, nullptr, &points, nullptr, nullptr, &transform, entity});
+					}else{
+						drawOpaqueMeshes(camera, cameraEntity, cameraTransform);
+						drawPoints(points, transform, cameraTransform, camera.renderToTexture);
+					}
+				}
 
 			}else if (signature.test(scene->getComponentType<LinesComponent>())){
 				LinesComponent& lines = scene->getComponent<LinesComponent>(entity);
 
-				if (transform.visible)
-					drawLines(lines, transform, cameraTransform, camera.renderToTexture);
+				if (transform.visible){
+					if (lines.transparent && sortTransparentPrimitives && !hasActiveScissor){
+						transparentDraws.push_back({getTransparentDrawKey(transform), nullptr, nullptr, nullptr, nullptr, &lines, nullptr, &transform, entity});
+					}else{
+						drawOpaqueMeshes(camera, cameraEntity, cameraTransform);
+						drawLines(lines, transform, cameraTransform, camera.renderToTexture);
+					}
+				}
 
 			}
 
@@ -2999,20 +3756,38 @@ void RenderSystem::draw(){
 			}
 		}
 
-		//---------Draw transparent meshes----------
-		while (!transparentMeshes.empty()){
-			TransparentMeshesData meshData = transparentMeshes.top();
+		//---------Draw sorted opaque meshes----------
+		drawOpaqueMeshes(camera, cameraEntity, cameraTransform);
 
-			//Draw transparent meshes
-			drawMesh(*meshData.mesh, *meshData.transform, camera, cameraTransform, camera.renderToTexture, meshData.instmesh, meshData.terrain);
-
-			transparentMeshes.pop();
+		//---------Draw transparent meshes, points, lines and UI----------
+		radixSort(transparentDraws, transparentSortTemp);
+		for (TransparentDrawData& drawData : transparentDraws){
+			if (drawData.mesh){
+				drawMesh(drawData.entity, *drawData.mesh, *drawData.transform, camera, cameraTransform, camera.renderToTexture, drawData.instmesh, drawData.terrain);
+			}else if (drawData.points){
+				drawPoints(*drawData.points, *drawData.transform, cameraTransform, camera.renderToTexture);
+			}else if (drawData.lines){
+				drawLines(*drawData.lines, *drawData.transform, cameraTransform, camera.renderToTexture);
+			}else if (drawData.ui){
+				drawUI(*drawData.ui, *drawData.transform, camera.renderToTexture);
+			}
 		}
 
 		camera.render.endFrameBuffer();
 
 	}
 
+	//---------Unused instancing batches----------
+	// kept for some frames to not reload them when a mesh leaves the view for a moment
+	for (auto it = autoInstancingBatches.begin(); it != autoInstancingBatches.end();){
+		if (frameCount - it->second.lastFrame > 120){
+			destroyAutoInstancing(it->second);
+			it = autoInstancingBatches.erase(it);
+		}else{
+			++it;
+		}
+	}
+
 	//---------Missing some shaders----------
 	if (ShaderPool::getMissingShaders().size() > 0){
 		std::string misShaders;
@@ -27,7 +27,7 @@
 #include "Engine.h"
 #include <map>
 #include <memory>
-#include <queue>
+#include <unordered_map>
 
 namespace Supernova{
 	typedef struct fs_lighting_t {
@@ -63,18 +63,64 @@ namespace Supernova{
 
 	class RenderSystem : public SubSystem {
 	private:
-		struct TransparentMeshesData{
+		// transparent draw of one of mesh, points, lines or UI with key [inverted distance 32], back to front
+		struct TransparentDrawData{
+			uint64_t key;
 			MeshComponent* mesh;
 			InstancedMeshComponent* instmesh;
 			TerrainComponent* terrain;
+			PointsComponent* points;
+			LinesComponent* lines;
+			UIComponent* ui;
 			Transform* transform;
-			float distanceToCamera;
+			Entity entity;
 		};
 
-		struct MeshComparison{
-			bool const operator()(const TransparentMeshesData& lhs, const TransparentMeshesData& rhs) const{
-				return lhs.distanceToCamera < rhs.distanceToCamera;
-			}
+		struct AutoInstancingSubmesh{
+			ObjectRender render;
+			std::shared_ptr<ShaderRender> shader;
+			uint32_t shaderProperties = 0;
+
+			int slotVSParams = -1;
+			int slotFSParams = -1;
+			int slotFSLighting = -1;
+			int slotFSFog = -1;
+			int slotVSShadows = -1;
+			int slotFSShadows = -1;
+		};
+
+		// one instanced draw of meshes with same instancingKey and material, using source mesh buffers
+		struct AutoInstancingBatch{
+			Entity source = NULL_ENTITY;
+			ExternalBuffer buffer;
+			std::vector<InstanceRenderData> instances;
+			size_t maxInstances = 0;
+
+			AutoInstancingSubmesh submeshes[MAX_SUBMESHES];
+			unsigned int numSubmeshes = 0;
+
+			uint64_t lastFrame = 0;
+			bool loaded = false;
+		};
+
+		// opaque draw with key [shader 16 | pipeline 16 | texture 16 | depth 16]
+		struct MeshDrawData{
+			uint64_t key;
+			MeshComponent* mesh;
+			InstancedMeshComponent* instmesh;
+			TerrainComponent* terrain;
+			Transform* transform;
+			Entity entity;
+			AutoInstancingBatch* batch;
+		};
+
+		// mesh that casts shadows, classified once by frame for all light cameras
+		struct ShadowCasterData{
+			MeshComponent* mesh;
+			InstancedMeshComponent* instmesh;
+			TerrainComponent* terrain;
+			Transform* transform;
+			Entity entity;
 		};
 
 		Scene* scene;
@@ -100,9 +146,38 @@ namespace Supernova{
 		fs_shadows_t fs_shadows;
 		fs_fog_t fs_fog;
 
+
+		// shadow maps cache, static casters are drawn only when changed and copied to shadow maps
+		std::vector<ShadowCasterData> staticShadowCasters;
+		std::vector<ShadowCasterData> dynamicShadowCasters;
+		uint64_t staticShadowsHash;
+		uint64_t staticShadowsVersion;
+		ObjectRender shadowCopyRender;
+		std::shared_ptr<ShaderRender> shadowCopyShader;
+		std::pair<int, int> slotShadowCopyTexture;
+		bool shadowCopyLoaded;
+		bool hasShadowCopy;
+
+		// reused by draw every frame
+		std::vector<MeshDrawData> opaqueMeshes;
+		std::vector<MeshDrawData> sortTemp;
+		std::vector<MeshDrawData> instancingCandidates;
+		std::vector<TransparentDrawData> transparentDraws;
+		std::vector<TransparentDrawData> transparentSortTemp;
+
+		// by material and instancingKey of each camera
+		std::unordered_map<uint64_t, AutoInstancingBatch> autoInstancingBatches;
+		uint64_t frameCount;
+
+		// reused by updateTransforms every frame
+		std::vector<size_t> dirtyTransformIndexes;
+		std::vector<size_t> subtreeDepths;
+		std::vector<std::vector<size_t>> transformLevels;
+
 		static void changeLoaded(void* data);
 		static void changeDestroy(void* data);
 
+		void updateTransforms();
 		void updateMVP(size_t index, Transform& transform, CameraComponent& camera, Transform& cameraTransform);
 
 		void createFramebuffer(CameraComponent& camera);
@@ -114,6 +189,13 @@ namespace Supernova{
 		TextureShaderType getShadowMapByIndex(int index);
 		TextureShaderType getShadowMapCubeByIndex(int index);
 		void configureLightShadowNearFar(LightComponent& light, const CameraComponent& camera);
+		void resetShadowsCache(LightComponent& light);
+		void loadShadowCopy();
+		void classifyShadowCasters();
+		bool hasShadowCastersInCamera(const std::vector<ShadowCasterData>& casters, LightCamera& camera);
+		void drawShadowCasters(const std::vector<ShadowCasterData>& casters, LightCamera& camera);
+		void drawShadowMap(LightComponent& light, size_t c);
+		void drawShadowCubeMap(LightComponent& light);
 		Matrix4 getDirLightProjection(const Matrix4& viewMatrix, const Matrix4& sceneCameraInv);
 		bool checkPBRFrabebufferUpdate(Material& material);
 		void loadPBRTextures(Material& material, ShaderData& shaderData, ObjectRender& render, bool shadows);
@@ -126,12 +208,24 @@ namespace Supernova{
 		AABB getTerrainNodeAABB(Transform& transform, TerrainNode& terrainNode);
 		bool isTerrainNodeInSphere(Vector3 position, float radius, const AABB& box);
 
+		// automatic instancing
+		uint64_t getInstancingKey(MeshComponent& mesh);
+		uint64_t getInstancingBatchKey(MeshComponent& mesh, Entity cameraEntity);
+		bool isAutoInstancingCandidate(MeshDrawData& meshData);
+		void buildAutoInstancing(CameraComponent& camera, Entity cameraEntity);
+		bool loadAutoInstancing(AutoInstancingBatch& batch, MeshDrawData& source, size_t numInstances, bool renderToTexture);
+		bool drawAutoInstancing(AutoInstancingBatch& batch, MeshComponent& mesh, CameraComponent& camera, bool renderToTexture);
+		void destroyAutoInstancing(AutoInstancingBatch& batch);
+
 		float lerp(float a, float b, float fraction);
 
 	protected:
 
-		bool drawMesh(MeshComponent& mesh, Transform& transform, CameraComponent& camera, Transform& camTransform, bool renderToTexture, InstancedMeshComponent* instmesh, TerrainComponent* terrain);
-		bool drawMeshDepth(MeshComponent& mesh, const float cameraFar, const Plane frustumPlanes[6], vs_depth_t vsDepthParams, InstancedMeshComponent* instmesh, TerrainComponent* terrain);
+		uint64_t getMeshDrawKey(MeshComponent& mesh, Transform& transform, CameraComponent& camera);
+		void drawOpaqueMeshes(CameraComponent& camera, Entity cameraEntity, Transform& cameraTransform);
+		uint64_t getTransparentDrawKey(Transform& transform);
+		bool drawMesh(Entity entity, MeshComponent& mesh, Transform& transform, CameraComponent& camera, Transform& camTransform, bool renderToTexture, InstancedMeshComponent* instmesh, TerrainComponent* terrain);
+		bool drawMeshDepth(Entity entity, MeshComponent& mesh, const float cameraFar, const Plane frustumPlanes[6], vs_depth_t vsDepthParams, InstancedMeshComponent* instmesh, TerrainComponent* terrain);
 		void destroyMesh(Entity entity, MeshComponent& mesh);
 
 		bool drawUI(UIComponent& uirender, Transform& transform, bool renderToTexture);
@@ -164,6 +258,7 @@ namespace Supernova{
 		RenderSystem(Scene* scene);
 		virtual ~RenderSystem();
 
+		bool loadMeshTexturesAsync(MeshComponent& mesh, float priority);
 		bool loadMesh(Entity entity, MeshComponent& mesh, uint8_t pipelines, InstancedMeshComponent* instmesh, TerrainComponent* terrain);
 		bool loadPoints(Entity entity, PointsComponent& points, uint8_t pipelines);
 		bool loadLines(Entity entity, LinesComponent& lines, uint8_t pipelines);
@@ -574,6 +574,7 @@ void UISystem::updateTextEdit(Entity entity, TextEditComponent& textedit, ImageC
     if (texttransform.position != textPosition){
         texttransform.position = textPosition;
         texttransform.needUpdate = true;
+        scene->markTransformDirty(textedit.text);
     }
 
     // Cursor
@@ -598,6 +599,7 @@ void UISystem::updateTextEdit(Entity entity, TextEditComponent& textedit, ImageC
     cursorui.color = textedit.cursorColor;
     cursortransform.position = Vector3(cursorX, cursorY, 0.0);
     cursortransform.needUpdate = true;
+    scene->markTransformDirty(textedit.cursor);
 
     cursor.needUpdatePolygon = true;
 }
@@ -1156,6 +1158,8 @@ void UISystem::update(double dt){
                         parentcontainer->numBoxes = parentcontainer->numBoxes + 1;
                     }else{
                         transform.parent = NULL_ENTITY;
+                        transform.needUpdate = true;
+                        scene->markTransformDirty(entity);
                         Log::error("The UI container has exceeded the maximum allowed of %i children. Please, increase MAX_CONTAINER_BOXES value.", MAX_CONTAINER_BOXES);
                     }
                 }
@@ -1315,6 +1319,7 @@ void UISystem::update(double dt){
                     transform.position.x = posX;
                     transform.position.y = posY;
                     transform.needUpdate = true;
+                    scene->markTransformDirty(entity);
                 }
 
             }else{
@@ -1861,6 +1866,7 @@ bool UISystem::eventOnPointerMove(float x, float y){
             if (panel.headerPointerDown){
                 transform.position += Vector3(pointerDiff.x / transform.worldScale.x, pointerDiff.y / transform.worldScale.y, 0);
                 transform.needUpdate = true;
+                scene->markTransformDirty(lastUIFromPointer);
 
                 panel.onMove.call();
             }
@@ -1882,6 +1888,7 @@ bool UISystem::eventOnPointerMove(float x, float y){
                 }else if (panel.edgePointerDown == PanelEdge::LEFT_BOTTOM){
                     transform.position += Vector3(pointerDiff.x / transform.worldScale.x, 0, 0);
                     transform.needUpdate = true;
+                    scene->markTransformDirty(lastUIFromPointer);
                     layout.width -= (int)panelSizeAcc.x;
                     layout.height += (int)panelSizeAcc.y;
                     layout.needUpdateSizes = true;
@@ -1889,6 +1896,7 @@ bool UISystem::eventOnPointerMove(float x, float y){
                 }else if (panel.edgePointerDown == PanelEdge::LEFT){
                     transform.position += Vector3(pointerDiff.x / transform.worldScale.x, 0, 0);
                     transform.needUpdate = true;
+                    scene->markTransformDirty(lastUIFromPointer);
                     layout.width -= (int)panelSizeAcc.x;
                     layout.needUpdateSizes = true;
                     cursor = CursorType::RESIZE_EW;
@@ -7,6 +7,7 @@
 #include "Engine.h"
 #include "Log.h"
 #include "render/SystemRender.h"
+#include "util/AssetLoader.h"
 
 using namespace Supernova;
 
@@ -279,6 +280,59 @@ bool Texture::load(){
     return true;
 }
 
+bool Texture::loadAsync(float priority){
+    // texture ids being decoded, shared by all copies of same texture
+    static std::map<std::string, AssetTaskId> loadingTasks;
+
+    if (framebuffer || data || !needLoad || !loadFromPath || id.empty())
+        return true;
+
+    if (TexturePool::get(id))
+        return true;
+
+    data = TextureDataPool::get(id);
+    if (data)
+        return true;
+
+    auto it = loadingTasks.find(id);
+    if (it != loadingTasks.end()){
+        AssetLoader::setPriority(it->second, priority);
+        return false;
+    }
+
+    int numFaces = (type == TextureType::TEXTURE_CUBE) ? 6 : 1;
+    for (int f = 0; f < numFaces; f++){
+        if (paths[f].empty()){
+            return true; // error is reported by load()
+        }
+    }
+
+    std::shared_ptr<std::array<TextureData,6>> loadData = std::make_shared<std::array<TextureData,6>>();
+    std::array<std::string,6> loadPaths = {paths[0], paths[1], paths[2], paths[3], paths[4], paths[5]};
+    TextureStrategy strategy = Engine::getTextureStrategy();
+    std::string loadId = id;
+
+    loadingTasks[id] = AssetLoader::load([loadData, loadPaths, numFaces, strategy](){
+        bool success = true;
+        for (int f = 0; f < numFaces; f++){
+            success = loadData->at(f).loadTextureFromFile(loadPaths[f].c_str()) && success;
+
+            if (strategy == TextureStrategy::FIT){
+                loadData->at(f).fitPowerOfTwo();
+            }else if (strategy == TextureStrategy::RESIZE){
+                loadData->at(f).resizePowerOfTwo();
+            }
+        }
+        return success;
+    }, [loadData, loadId](bool success){
+        loadingTasks.erase(loadId);
+        // also failed textures, as load() does, to not try again
+        TextureDataPool::get(loadId, *loadData.get());
+    }, priority);
+
+    return false;
+}
+
 void Texture::destroy(){
     if (!id.empty()){
 
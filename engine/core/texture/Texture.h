@@ -60,6 +60,8 @@ namespace Supernova{
             virtual ~Texture();
 
             bool load();
+            // decodes files in AssetLoader threads, true when getRender() will not block
+            bool loadAsync(float priority = 0);
             void destroy();
 
             TextureRender* getRender();
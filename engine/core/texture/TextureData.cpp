@@ -19,6 +19,9 @@
 #include "Log.h"
 #include "Texture.h"
 #include "Engine.h"
+#include "util/Profiler.h"
+#include <algorithm>
+#include <string>
 
 using namespace Supernova;
 
@@ -30,6 +33,7 @@ TextureData::TextureData() {
     this->size = 0;
     this->color_format = ColorFormat::RGBA;
     this->channels = 0;
+    this->mipLevels = 1;
     this->data = NULL;
 
     this->transparent = false;
@@ -45,6 +49,7 @@ TextureData::TextureData(int width, int height, unsigned int size, ColorFormat c
     this->size = size;
     this->color_format = color_format;
     this->channels = channels;
+    this->mipLevels = 1;
     this->data = data;
 
     this->transparent = false;
@@ -71,6 +76,7 @@ bool TextureData::operator == ( const TextureData& v ) const{
         v.size == size &&
         v.color_format == color_format &&
         v.channels == channels &&
+        v.mipLevels == mipLevels &&
         v.data == data &&
         v.transparent == transparent &&
         v.dataOwned == dataOwned
@@ -86,13 +92,181 @@ bool TextureData::operator != ( const TextureData& v ) const{
         v.size != size ||
         v.color_format != color_format ||
         v.channels != channels ||
+        v.mipLevels != mipLevels ||
         v.data != data ||
         v.transparent != transparent ||
         v.dataOwned != dataOwned
     );
 }
 
+// KTX2 container: https://registry.khronos.org/KTX/specs/2.0/ktxspec.v2.html
+static const unsigned char ktx2Identifier[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+
+#define KTX2_HEADER_SIZE 80
+#define KTX2_LEVEL_INDEX_SIZE 24
+
+static uint32_t readKTX2Uint32(const unsigned char* buffer, size_t offset){
+    uint32_t value;
+    memcpy(&value, buffer + offset, sizeof(value));
+    return value;
+}
+
+static uint64_t readKTX2Uint64(const unsigned char* buffer, size_t offset){
+    uint64_t value;
+    memcpy(&value, buffer + offset, sizeof(value));
+    return value;
+}
+
+// sRGB variants use same format, colors are converted in shaders as with other image files
+static bool getKTX2ColorFormat(uint32_t vkFormat, ColorFormat& format, int& channels){
+    switch (vkFormat){
+        case 9: case 15: // R8_UNORM, R8_SRGB
+            format = ColorFormat::RED; channels = 1; return true;
+        case 37: case 43: // R8G8B8A8_UNORM, R8G8B8A8_SRGB
+            format = ColorFormat::RGBA; channels = 4; return true;
+        case 131: case 132: case 133: case 134: // BC1_RGB(A)_UNORM/SRGB_BLOCK
+            format = ColorFormat::BC1_RGBA; channels = 4; return true;
+        case 137: case 138: // BC3_UNORM/SRGB_BLOCK
+            format = ColorFormat::BC3_RGBA; channels = 4; return true;
+        case 139: // BC4_UNORM_BLOCK
+            format = ColorFormat::BC4_R; channels = 1; return true;
+        case 141: // BC5_UNORM_BLOCK
+            format = ColorFormat::BC5_RG; channels = 2; return true;
+        case 145: case 146: // BC7_UNORM/SRGB_BLOCK
+            format = ColorFormat::BC7_RGBA; channels = 4; return true;
+        case 147: case 148: // ETC2_R8G8B8_UNORM/SRGB_BLOCK
+            format = ColorFormat::ETC2_RGB8; channels = 3; return true;
+        case 151: case 152: // ETC2_R8G8B8A8_UNORM/SRGB_BLOCK
+            format = ColorFormat::ETC2_RGBA8; channels = 4; return true;
+        case 153: // EAC_R11_UNORM_BLOCK
+            format = ColorFormat::EAC_R11; channels = 1; return true;
+        case 155: // EAC_R11G11_UNORM_BLOCK
+            format = ColorFormat::EAC_RG11; channels = 2; return true;
+        case 157: case 158: // ASTC_4x4_UNORM/SRGB_BLOCK
+            format = ColorFormat::ASTC_4x4_RGBA; channels = 4; return true;
+    }
+
+    return false;
+}
+
+// value of KTXswizzle metadata, "rgb1" is written for opaque images by tools/supertexture.py
+static std::string getKTX2Swizzle(const unsigned char* buffer, size_t length, uint32_t kvdOffset, uint32_t kvdLength){
+    const char* key = "KTXswizzle";
+    size_t keySize = strlen(key) + 1;
+
+    size_t offset = kvdOffset;
+    size_t end = (size_t)kvdOffset + kvdLength;
+    while (offset + 4 <= end && end <= length){
+        uint32_t pairLength = readKTX2Uint32(buffer, offset);
+        size_t pair = offset + 4;
+        if (pair + pairLength > end)
+            break;
+
+        if (pairLength > keySize && memcmp(buffer + pair, key, keySize) == 0){
+            std::string value((const char*)buffer + pair + keySize, pairLength - keySize);
+            return value.c_str(); // without null terminator
+        }
+
+        offset = pair + ((pairLength + 3) & ~3u);
+    }
+
+    return "";
+}
+
+bool TextureData::loadKTX2(const unsigned char* buffer, size_t length, const char* filename){
+    if (length < KTX2_HEADER_SIZE){
+        Log::error("Invalid KTX2 file: %s", filename);
+        return false;
+    }
+
+    uint32_t vkFormat = readKTX2Uint32(buffer, 12);
+    uint32_t pixelWidth = readKTX2Uint32(buffer, 20);
+    uint32_t pixelHeight = readKTX2Uint32(buffer, 24);
+    uint32_t pixelDepth = readKTX2Uint32(buffer, 28);
+    uint32_t layerCount = readKTX2Uint32(buffer, 32);
+    uint32_t faceCount = readKTX2Uint32(buffer, 36);
+    uint32_t levelCount = readKTX2Uint32(buffer, 40);
+    uint32_t supercompressionScheme = readKTX2Uint32(buffer, 44);
+    uint32_t kvdOffset = readKTX2Uint32(buffer, 56);
+    uint32_t kvdLength = readKTX2Uint32(buffer, 60);
+
+    if (supercompressionScheme != 0 || vkFormat == 0){
+        Log::error("KTX2 file with Basis Universal or supercompression is not supported, use tools/supertexture.py to transcode it: %s", filename);
+        return false;
+    }
+
+    if (pixelDepth > 1 || layerCount > 1 || faceCount != 1 || pixelHeight == 0){
+        Log::error("Only 2D KTX2 textures are supported (one file for each cube face): %s", filename);
+        return false;
+    }
+
+    ColorFormat format;
+    int formatChannels;
+    if (!getKTX2ColorFormat(vkFormat, format, formatChannels)){
+        Log::error("KTX2 texture format %u is not supported: %s", vkFormat, filename);
+        return false;
+    }
+
+    // zero means mipmaps are generated by renders, only for uncompressed formats
+    levelCount = std::max(levelCount, 1u);
+    if (levelCount > MAX_TEXTURE_MIPMAPS){
+        levelCount = MAX_TEXTURE_MIPMAPS;
+    }
+
+    if (length < KTX2_HEADER_SIZE + (size_t)levelCount * KTX2_LEVEL_INDEX_SIZE){
+        Log::error("Invalid KTX2 file: %s", filename);
+        return false;
+    }
+
+    size_t totalSize = 0;
+    for (uint32_t l = 0; l < levelCount; l++){
+        int levelWidth = std::max((int)pixelWidth >> l, 1);
+        int levelHeight = std::max((int)pixelHeight >> l, 1);
+        uint64_t byteOffset = readKTX2Uint64(buffer, KTX2_HEADER_SIZE + l * KTX2_LEVEL_INDEX_SIZE);
+        uint64_t byteLength = readKTX2Uint64(buffer, KTX2_HEADER_SIZE + l * KTX2_LEVEL_INDEX_SIZE + 8);
+
+        if (byteLength != getLevelSize(format, levelWidth, levelHeight) || byteOffset + byteLength > length){
+            Log::error("Invalid KTX2 mipmap level %u: %s", l, filename);
+            return false;
+        }
+        totalSize += byteLength;
+    }
+
+    // file stores smallest level first, data keeps biggest first
+    unsigned char* levels = (unsigned char*)malloc(totalSize);
+    size_t offset = 0;
+    for (uint32_t l = 0; l < levelCount; l++){
+        uint64_t byteOffset = readKTX2Uint64(buffer, KTX2_HEADER_SIZE + l * KTX2_LEVEL_INDEX_SIZE);
+        uint64_t byteLength = readKTX2Uint64(buffer, KTX2_HEADER_SIZE + l * KTX2_LEVEL_INDEX_SIZE + 8);
+        memcpy(levels + offset, buffer + byteOffset, byteLength);
+        offset += byteLength;
+    }
+
+    width = pixelWidth;
+    height = pixelHeight;
+    originalWidth = width;
+    originalHeight = height;
+    color_format = format;
+    channels = formatChannels;
+    mipLevels = levelCount;
+    size = (unsigned int)totalSize;
+    data = levels;
+
+    if (Engine::isAutomaticTransparency()){
+        if (isCompressed()){
+            // blocks are not inspected, alpha of format is used unless it was marked as opaque
+            std::string swizzle = getKTX2Swizzle(buffer, length, kvdOffset, kvdLength);
+            transparent = (channels == 4) && !(swizzle.size() == 4 && swizzle[3] == '1');
+        }else{
+            transparent = hasAlpha();
+        }
+    }
+
+    return true;
+}
+
 bool TextureData::loadTextureFromFile(const char* filename) {
+    PROFILE_ZONE("TextureData::loadTextureFromFile");
     
     Data filedata;
     
@@ -110,6 +284,12 @@ bool TextureData::loadTextureFromFile(const char* filename) {
 
     if (dataOwned && data)
         releaseImageData();
+
+    if (filedata.length() >= sizeof(ktx2Identifier) && memcmp(filedata.getMemPtr(), ktx2Identifier, sizeof(ktx2Identifier)) == 0){
+        return loadKTX2(filedata.getMemPtr(), filedata.length(), filename);
+    }
+
+    mipLevels = 1;
     
     //----- Start std_image read texture
     stbi_info_from_memory((stbi_uc const *)filedata.getMemPtr(), filedata.length(), &width, &height, &channels);
@@ -155,6 +335,7 @@ void TextureData::copy ( const TextureData& v ){
     this->size = v.size;
     this->color_format = v.color_format;
     this->channels = v.channels;
+    this->mipLevels = v.mipLevels;
 
     this->dataOwned = v.dataOwned;
 
@@ -184,7 +365,7 @@ int TextureData::getNearestPowerOfTwo(int size){
 }
 
 bool TextureData::hasAlpha(){
-    if (channels == 4){
+    if (channels == 4 && !isCompressed()){
         for(int y = 0; y < height; y++){
             for(int x = 0; x < width; x++){
                 int pixel = (y * (width * channels)) + (x * channels);
@@ -197,6 +378,10 @@ bool TextureData::hasAlpha(){
 }
 
 void TextureData::crop(int xOffset, int yOffset, int newWidth, int newHeight){
+    if (isCompressed() || mipLevels > 1){
+        Log::error("Cannot crop compressed or mipmapped texture data");
+        return;
+    }
     
     int rowsize = width * channels;
     int newRowsize = newWidth * channels;
@@ -225,10 +410,18 @@ void TextureData::crop(int xOffset, int yOffset, int newWidth, int newHeight){
 }
 
 void TextureData::resizePowerOfTwo(){
+    // compressed and mipmapped textures are prepared offline
+    if (isCompressed() || mipLevels > 1)
+        return;
+
     resize(getNearestPowerOfTwo(width), getNearestPowerOfTwo(height));
 }
 
 void TextureData::resize(int newWidth, int newHeight){
+    if (isCompressed() || mipLevels > 1){
+        Log::error("Cannot resize compressed or mipmapped texture data");
+        return;
+    }
 
     if ((newWidth != width) || (newHeight != height)){
 
@@ -283,10 +476,17 @@ void TextureData::resize(int newWidth, int newHeight){
 }
 
 void TextureData::fitPowerOfTwo(){
+    if (isCompressed() || mipLevels > 1)
+        return;
+
     fitSize(0, 0, getNearestPowerOfTwo(width), getNearestPowerOfTwo(height));
 }
 
 void TextureData::fitSize(int xOffset, int yOffset, int newWidth, int newHeight){
+    if (isCompressed() || mipLevels > 1){
+        Log::error("Cannot change size of compressed or mipmapped texture data");
+        return;
+    }
     
     if ((newWidth != width) || (newHeight != height)){
 
@@ -315,6 +515,10 @@ void TextureData::fitSize(int xOffset, int yOffset, int newWidth, int newHeight)
 }
 
 void TextureData::flipVertical(){
+    if (isCompressed() || mipLevels > 1){
+        Log::error("Cannot flip compressed or mipmapped texture data");
+        return;
+    }
     
     int bufsize = width * channels;
     
@@ -376,6 +580,10 @@ int TextureData::getChannels(){
     return channels;
 }
 
+int TextureData::getMipLevels(){
+    return mipLevels;
+}
+
 void* TextureData::getData(){
     return data;
 }
@@ -384,6 +592,39 @@ bool TextureData::isTransparent(){
     return transparent;
 }
 
+bool TextureData::isCompressed(){
+    return isCompressedFormat(color_format);
+}
+
+bool TextureData::isCompressedFormat(ColorFormat format){
+    return (format != ColorFormat::RED && format != ColorFormat::RGBA);
+}
+
+unsigned int TextureData::getLevelSize(ColorFormat format, int width, int height){
+    unsigned int blocks = ((width + 3) / 4) * ((height + 3) / 4);
+
+    switch (format){
+        case ColorFormat::RED:
+            return width * height;
+        case ColorFormat::RGBA:
+            return width * height * 4;
+        case ColorFormat::BC1_RGBA:
+        case ColorFormat::BC4_R:
+        case ColorFormat::ETC2_RGB8:
+        case ColorFormat::EAC_R11:
+            return blocks * 8;
+        case ColorFormat::BC3_RGBA:
+        case ColorFormat::BC5_RG:
+        case ColorFormat::BC7_RGBA:
+        case ColorFormat::ETC2_RGBA8:
+        case ColorFormat::EAC_RG11:
+        case ColorFormat::ASTC_4x4_RGBA:
+            return blocks * 16;
+    }
+
+    return 0;
+}
+
 int TextureData::getNearestPowerOfTwo(){
     return getNearestPowerOfTwo(std::min(width, height));
 }
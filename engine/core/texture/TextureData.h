@@ -6,6 +6,9 @@
 #define texturedata_h
 
 #include "render/Render.h"
+#include <cstddef>
+
+#define MAX_TEXTURE_MIPMAPS 16
 
 namespace Supernova {
 
@@ -18,9 +21,10 @@ namespace Supernova {
         int originalWidth;
         int originalHeight;
 
-        unsigned int size; //in bytes
+        unsigned int size; //in bytes, of all mipmap levels
         ColorFormat color_format;
         int channels;
+        int mipLevels; // levels stored in data, from biggest to smallest
         void* data;
 
         bool transparent;
@@ -29,6 +33,8 @@ namespace Supernova {
         
         int getNearestPowerOfTwo(int size);
 
+        bool loadKTX2(const unsigned char* buffer, size_t length, const char* filename);
+
     public:
 
         TextureData();
@@ -66,12 +72,18 @@ namespace Supernova {
         unsigned int getSize();
         ColorFormat getColorFormat();
         int getChannels();
+        int getMipLevels();
         void* getData();
 
         bool isTransparent();
+        bool isCompressed();
 
         int getNearestPowerOfTwo();
 
+        static bool isCompressedFormat(ColorFormat format);
+        // in bytes, of one mipmap level
+        static unsigned int getLevelSize(ColorFormat format, int width, int height);
+
         // render callback clean function
         static void cleanupTexture(void* data);
     };
@@ -0,0 +1,236 @@
+//
+// (c) 2024 Eduardo Doria.
+//
+
+#include "AssetLoader.h"
+#include "Log.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <string>
+
+using namespace Supernova;
+
+std::vector<std::thread> AssetLoader::threads;
+std::atomic<bool> AssetLoader::running{false};
+std::mutex AssetLoader::mutex;
+std::condition_variable AssetLoader::condition;
+
+AssetTaskId AssetLoader::nextId = 1;
+std::vector<AssetLoader::Task> AssetLoader::pending;
+std::map<AssetTaskId, AssetLoader::Task> AssetLoader::loading;
+std::vector<AssetLoader::Task> AssetLoader::finished;
+
+bool AssetLoader::compareTaskPriority(const Task& a, const Task& b){
+    return a.priority < b.priority;
+}
+
+void AssetLoader::init(int numThreads){
+    if (running){
+        return;
+    }
+
+    #if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+    numThreads = 0;
+    #endif
+
+    // without threads, pending tasks are loaded one per frame by update()
+    if (numThreads <= 0){
+        return;
+    }
+
+    running = true;
+
+    for (int i = 0; i < numThreads; i++){
+        threads.emplace_back(workerMain, i);
+    }
+
+    Log::verbose("Asset loader started with %i threads", numThreads);
+}
+
+void AssetLoader::shutdown(){
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+        pending.clear();
+    }
+    condition.notify_all();
+
+    for (std::thread& thread : threads){
+        if (thread.joinable()){
+            thread.join();
+        }
+    }
+    threads.clear();
+
+    // completions are not called after shutdown
+    loading.clear();
+    finished.clear();
+}
+
+bool AssetLoader::isRunning(){
+    return running;
+}
+
+void AssetLoader::workerMain(int index){
+    Profiler::setThreadName("AssetLoader " + std::to_string(index));
+
+    while (true){
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, []{ return !running || !pending.empty(); });
+
+            if (!running){
+                return;
+            }
+
+            auto it = std::min_element(pending.begin(), pending.end(), compareTaskPriority);
+            task = std::move(*it);
+            pending.erase(it);
+
+            loading[task.id] = {task.id, task.priority, nullptr, nullptr, false, false};
+        }
+
+        bool success;
+        {
+            PROFILE_ZONE("AssetLoader::load");
+            success = task.work();
+        }
+        task.work = nullptr;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = loading.find(task.id);
+        if (it != loading.end()){
+            task.canceled = it->second.canceled;
+            task.success = success;
+            loading.erase(it);
+
+            if (!task.canceled){
+                finished.push_back(std::move(task));
+            }
+        }
+        condition.notify_all();
+    }
+}
+
+AssetTaskId AssetLoader::load(std::function<bool()> work, std::function<void(bool)> completion, float priority){
+    AssetTaskId id;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        id = nextId++;
+        pending.push_back({id, priority, std::move(work), std::move(completion), false, false});
+    }
+    condition.notify_one();
+
+    return id;
+}
+
+void AssetLoader::setPriority(AssetTaskId id, float priority){
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (Task& task : pending){
+        if (task.id == id){
+            task.priority = priority;
+            return;
+        }
+    }
+}
+
+void AssetLoader::cancel(AssetTaskId id){
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (auto it = pending.begin(); it != pending.end(); ++it){
+        if (it->id == id){
+            pending.erase(it);
+            return;
+        }
+    }
+
+    auto it = loading.find(id);
+    if (it != loading.end()){
+        it->second.canceled = true;
+        return;
+    }
+
+    for (Task& task : finished){
+        if (task.id == id){
+            task.canceled = true;
+            return;
+        }
+    }
+}
+
+bool AssetLoader::isLoading(AssetTaskId id){
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (loading.count(id))
+        return true;
+
+    for (const Task& task : pending){
+        if (task.id == id)
+            return true;
+    }
+    for (const Task& task : finished){
+        if (task.id == id && !task.canceled)
+            return true;
+    }
+
+    return false;
+}
+
+size_t AssetLoader::getNumTasks(){
+    std::lock_guard<std::mutex> lock(mutex);
+
+    return pending.size() + loading.size() + finished.size();
+}
+
+void AssetLoader::update(){
+    PROFILE_ZONE("AssetLoader::update");
+
+    // without loader threads, work of one pending task runs here each frame
+    if (!running){
+        Task task;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (pending.empty()){
+                return;
+            }
+            auto it = std::min_element(pending.begin(), pending.end(), compareTaskPriority);
+            task = std::move(*it);
+            pending.erase(it);
+        }
+
+        task.success = task.work();
+        if (task.completion){
+            task.completion(task.success);
+        }
+        return;
+    }
+
+    // one by one, completion can cancel or create other tasks
+    while (true){
+        Task task;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (finished.empty()){
+                return;
+            }
+            task = std::move(finished.front());
+            finished.erase(finished.begin());
+        }
+
+        if (task.completion && !task.canceled){
+            task.completion(task.success);
+        }
+    }
+}
+
+void AssetLoader::finish(){
+    while (getNumTasks() > 0){
+        if (running){
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, []{ return !finished.empty() || (pending.empty() && loading.empty()); });
+        }
+        update();
+    }
+}
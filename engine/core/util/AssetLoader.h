@@ -0,0 +1,79 @@
+//
+// (c) 2024 Eduardo Doria.
+//
+
+#ifndef ASSETLOADER_H
+#define ASSETLOADER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define ASSETLOADER_DEFAULT_THREADS 2
+
+namespace Supernova {
+
+    enum class AssetLoadState{
+        NONE,
+        LOADING,
+        LOADED,
+        FAILED
+    };
+
+    typedef uint64_t AssetTaskId;
+
+    // Background loading of asset files (decoding and parsing) in its own threads.
+    // Tasks are blocking IO, so they are kept out of JobSystem: main thread also runs jobs while waiting.
+    // Pending task with lowest priority value runs first, completion is called in main thread by update().
+    class AssetLoader{
+    private:
+        struct Task{
+            AssetTaskId id;
+            float priority;
+            std::function<bool()> work;
+            std::function<void(bool)> completion;
+            bool canceled;
+            bool success;
+        };
+
+        static std::vector<std::thread> threads;
+        static std::atomic<bool> running;
+        static std::mutex mutex;
+        static std::condition_variable condition;
+
+        static AssetTaskId nextId;
+        static std::vector<Task> pending;
+        static std::map<AssetTaskId, Task> loading;
+        static std::vector<Task> finished;
+
+        static bool compareTaskPriority(const Task& a, const Task& b);
+        static void workerMain(int index);
+
+    public:
+        static void init(int numThreads = ASSETLOADER_DEFAULT_THREADS);
+        static void shutdown();
+        static bool isRunning();
+
+        // work runs in a loader thread and returns success, completion receives it in main thread
+        static AssetTaskId load(std::function<bool()> work, std::function<void(bool)> completion, float priority = 0);
+        // lower values are loaded first, ex: distance to camera
+        static void setPriority(AssetTaskId id, float priority);
+        // completion is not called, work already running is finished and discarded
+        static void cancel(AssetTaskId id);
+        static bool isLoading(AssetTaskId id);
+        static size_t getNumTasks();
+
+        // runs completions of finished tasks, called by Engine every frame
+        static void update();
+        // blocks until all tasks are loaded and completed
+        static void finish();
+    };
+
+}
+
+#endif //ASSETLOADER_H
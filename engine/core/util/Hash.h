@@ -0,0 +1,34 @@
+//
+// (c) 2024 Eduardo Doria.
+//
+
+#ifndef HASH_H
+#define HASH_H
+
+#include <cstdint>
+#include <cstddef>
+
+namespace Supernova {
+
+    // 64 bit FNV-1a, not suited for security, only to identify data
+    inline uint64_t hashBytes(const void* data, size_t size, uint64_t hash = 14695981039346656037ULL){
+        const uint8_t* bytes = (const uint8_t*)data;
+        for (size_t i = 0; i < size; i++){
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    template<typename T>
+    inline uint64_t hashValue(const T& value, uint64_t hash = 14695981039346656037ULL){
+        return hashBytes(&value, sizeof(T), hash);
+    }
+
+    inline uint64_t hashCombine(uint64_t seed, uint64_t value){
+        return seed ^ (value + 0x9E3779B97F4A7C15ULL + (seed << 6) + (seed >> 2));
+    }
+
+}
+
+#endif //HASH_H
@@ -0,0 +1,220 @@
+//
+// (c) 2024 Eduardo Doria.
+//
+
+#include "JobSystem.h"
+#include "Log.h"
+#include "Profiler.h"
+#include <algorithm>
+
+using namespace Supernova;
+
+std::vector<std::thread> JobSystem::threads;
+std::vector<std::unique_ptr<JobSystem::JobQueue>> JobSystem::queues;
+std::atomic<bool> JobSystem::running{false};
+std::atomic<size_t> JobSystem::queuedJobs{0};
+std::mutex JobSystem::sleepMutex;
+std::condition_variable JobSystem::sleepCondition;
+thread_local int JobSystem::workerIndex = -1;
+
+void JobSystem::init(int numThreads){
+    if (running){
+        return;
+    }
+
+    if (numThreads < 0){
+        numThreads = (int)std::thread::hardware_concurrency() - 1;
+    }
+
+    #if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+    numThreads = 0;
+    #endif
+
+    if (numThreads <= 0){
+        return;
+    }
+
+    queues.clear();
+    for (int i = 0; i < numThreads + 1; i++){
+        queues.push_back(std::make_unique<JobQueue>());
+    }
+
+    running = true;
+
+    for (int i = 0; i < numThreads; i++){
+        threads.emplace_back(workerMain, i);
+    }
+
+    Log::verbose("Job system started with %i worker threads", numThreads);
+}
+
+void JobSystem::shutdown(){
+    if (!running){
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        running = false;
+    }
+    sleepCondition.notify_all();
+
+    for (std::thread& thread : threads){
+        if (thread.joinable()){
+            thread.join();
+        }
+    }
+    threads.clear();
+
+    // remaining jobs run on calling thread
+    Job job;
+    while (pop(job)){
+        run(job);
+    }
+
+    queues.clear();
+}
+
+bool JobSystem::isRunning(){
+    return running;
+}
+
+size_t JobSystem::getNumThreads(){
+    return threads.size();
+}
+
+bool JobSystem::isWorkerThread(){
+    return workerIndex >= 0;
+}
+
+void JobSystem::push(Job job){
+    size_t queue = (workerIndex >= 0) ? workerIndex : threads.size();
+    {
+        std::lock_guard<std::mutex> lock(queues[queue]->mutex);
+        queues[queue]->jobs.push_back(std::move(job));
+    }
+    queuedJobs++;
+
+    // lock avoids losing the notification while a worker is checking its wait condition
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    sleepCondition.notify_one();
+}
+
+bool JobSystem::pop(Job& job){
+    size_t numQueues = queues.size();
+    if (numQueues == 0){
+        return false;
+    }
+
+    size_t own = (workerIndex >= 0) ? workerIndex : threads.size();
+
+    // own queue is LIFO for cache locality
+    {
+        std::lock_guard<std::mutex> lock(queues[own]->mutex);
+        if (!queues[own]->jobs.empty()){
+            job = std::move(queues[own]->jobs.back());
+            queues[own]->jobs.pop_back();
+            queuedJobs--;
+            return true;
+        }
+    }
+
+    // steal oldest jobs from others
+    for (size_t i = 1; i < numQueues; i++){
+        JobQueue& queue = *queues[(own + i) % numQueues];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.jobs.empty()){
+            job = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+            queuedJobs--;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void JobSystem::run(Job& job){
+    job.function();
+
+    if (job.counter){
+        job.counter->pending.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+void JobSystem::workerMain(int index){
+    workerIndex = index;
+    Profiler::setThreadName("Worker " + std::to_string(index));
+
+    while (running){
+        Job job;
+        if (pop(job)){
+            run(job);
+        }else{
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            sleepCondition.wait(lock, []{ return queuedJobs.load() > 0 || !running; });
+        }
+    }
+}
+
+void JobSystem::execute(JobCounter& counter, std::function<void()> function){
+    if (!running){
+        function();
+        return;
+    }
+
+    counter.pending.fetch_add(1, std::memory_order_relaxed);
+    push({std::move(function), &counter});
+}
+
+void JobSystem::execute(std::function<void()> function){
+    if (!running){
+        function();
+        return;
+    }
+
+    push({std::move(function), nullptr});
+}
+
+void JobSystem::wait(JobCounter& counter){
+    while (!counter.isDone()){
+        Job job;
+        if (running && pop(job)){
+            run(job);
+        }else{
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::parallelFor(size_t count, size_t minBatchSize, const std::function<void(size_t, size_t)>& function){
+    if (count == 0){
+        return;
+    }
+
+    if (minBatchSize == 0){
+        minBatchSize = 1;
+    }
+
+    size_t maxBatches = (threads.size() + 1) * 4;
+    size_t numBatches = std::min(count / minBatchSize, maxBatches);
+
+    if (!running || numBatches <= 1){
+        function(0, count);
+        return;
+    }
+
+    size_t batchSize = (count + numBatches - 1) / numBatches;
+
+    JobCounter counter;
+    for (size_t start = batchSize; start < count; start += batchSize){
+        size_t end = std::min(start + batchSize, count);
+        execute(counter, [&function, start, end](){ function(start, end); });
+    }
+
+    function(0, std::min(batchSize, count));
+
+    wait(counter);
+}
@@ -0,0 +1,71 @@
+//
+// (c) 2024 Eduardo Doria.
+//
+
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+
+namespace Supernova {
+
+    struct JobCounter{
+        std::atomic<int> pending{0};
+
+        bool isDone() const { return pending.load(std::memory_order_acquire) == 0; }
+    };
+
+    // Engine wide work-stealing thread pool. Each worker has its own queue and steals
+    // from the others when empty. Threads waiting for a counter also run jobs.
+    class JobSystem {
+    private:
+        struct Job{
+            std::function<void()> function;
+            JobCounter* counter;
+        };
+
+        struct JobQueue{
+            std::mutex mutex;
+            std::deque<Job> jobs;
+        };
+
+        static std::vector<std::thread> threads;
+        static std::vector<std::unique_ptr<JobQueue>> queues; // one per worker + one for other threads
+        static std::atomic<bool> running;
+        static std::atomic<size_t> queuedJobs;
+        static std::mutex sleepMutex;
+        static std::condition_variable sleepCondition;
+        static thread_local int workerIndex;
+
+        static void push(Job job);
+        static bool pop(Job& job);
+        static void run(Job& job);
+        static void workerMain(int index);
+
+    public:
+        // numThreads < 0 uses hardware concurrency minus the calling thread
+        static void init(int numThreads = -1);
+        static void shutdown();
+
+        static bool isRunning();
+        static size_t getNumThreads();
+        static bool isWorkerThread();
+
+        static void execute(JobCounter& counter, std::function<void()> function);
+        static void execute(std::function<void()> function);
+        static void wait(JobCounter& counter);
+
+        // function(start, end) for ranges of [0, count), ranges have at least minBatchSize items
+        static void parallelFor(size_t count, size_t minBatchSize, const std::function<void(size_t, size_t)>& function);
+    };
+
+}
+
+#endif //JOBSYSTEM_H
@@ -0,0 +1,62 @@
+//
+// (c) 2024 Eduardo Doria.
+//
+
+#include "JoltJobSystem.h"
+#include "JobSystem.h"
+#include <thread>
+#include <chrono>
+
+using namespace Supernova;
+
+JoltJobSystem::JoltJobSystem(JPH::uint inMaxJobs, JPH::uint inMaxBarriers){
+    JobSystemWithBarrier::Init(inMaxBarriers);
+
+    jobs.Init(inMaxJobs, inMaxJobs);
+}
+
+int JoltJobSystem::GetMaxConcurrency() const{
+    return int(Supernova::JobSystem::getNumThreads()) + 1;
+}
+
+JPH::JobSystem::JobHandle JoltJobSystem::CreateJob(const char *inName, JPH::ColorArg inColor, const JobFunction &inJobFunction, JPH::uint32 inNumDependencies){
+    JPH::uint32 index;
+    for (;;){
+        index = jobs.ConstructObject(inName, inColor, this, inJobFunction, inNumDependencies);
+        if (index != AvailableJobs::cInvalidObjectIndex)
+            break;
+        JPH_ASSERT(false, "No jobs available!");
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    Job *job = &jobs.Get(index);
+
+    // handle keeps a reference, job can complete right after queued
+    JobHandle handle(job);
+
+    if (inNumDependencies == 0)
+        QueueJob(job);
+
+    return handle;
+}
+
+void JoltJobSystem::QueueJob(Job *inJob){
+    // without workers the barrier executes the jobs while waiting
+    if (!Supernova::JobSystem::isRunning())
+        return;
+
+    inJob->AddRef();
+    Supernova::JobSystem::execute([inJob](){
+        inJob->Execute();
+        inJob->Release();
+    });
+}
+
+void JoltJobSystem::QueueJobs(Job **inJobs, JPH::uint inNumJobs){
+    for (JPH::uint i = 0; i < inNumJobs; i++){
+        QueueJob(inJobs[i]);
+    }
+}
+
+void JoltJobSystem::FreeJob(Job *inJob){
+    jobs.DestructObject(inJob);
+}
@@ -0,0 +1,35 @@
+//
+// (c) 2024 Eduardo Doria.
+//
+
+#ifndef JOLTJOBSYSTEM_H
+#define JOLTJOBSYSTEM_H
+
+#include "Jolt/Jolt.h"
+#include "Jolt/Core/JobSystemWithBarrier.h"
+#include "Jolt/Core/FixedSizeFreeList.h"
+
+namespace Supernova {
+
+    // Jolt job system that runs physics jobs on the engine JobSystem workers
+    class JoltJobSystem final : public JPH::JobSystemWithBarrier {
+    private:
+        using AvailableJobs = JPH::FixedSizeFreeList<Job>;
+        AvailableJobs jobs;
+
+    protected:
+        virtual void QueueJob(Job *inJob) override;
+        virtual void QueueJobs(Job **inJobs, JPH::uint inNumJobs) override;
+        virtual void FreeJob(Job *inJob) override;
+
+    public:
+        JoltJobSystem(JPH::uint inMaxJobs, JPH::uint inMaxBarriers);
+        virtual ~JoltJobSystem() override = default;
+
+        virtual int GetMaxConcurrency() const override;
+        virtual JobHandle CreateJob(const char *inName, JPH::ColorArg inColor, const JobFunction &inJobFunction, JPH::uint32 inNumDependencies = 0) override;
+    };
+
+}
+
+#endif //JOLTJOBSYSTEM_H
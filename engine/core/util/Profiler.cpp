@@ -0,0 +1,264 @@
+//
+// (c) 2024 Eduardo Doria.
+//
+
+#include "Profiler.h"
+#include "Log.h"
+#include "io/File.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+#ifdef __GNUC__
+#include <cxxabi.h>
+#endif
+
+using namespace Supernova;
+
+std::atomic<bool> Profiler::enabled{false};
+std::atomic<bool> Profiler::capturing{false};
+
+std::mutex Profiler::buffersMutex;
+std::vector<std::unique_ptr<ProfilerThreadBuffer>> Profiler::buffers;
+thread_local ProfilerThreadBuffer* Profiler::threadBuffer = nullptr;
+thread_local std::string Profiler::threadName;
+
+uint64_t Profiler::frameStart = 0;
+std::map<const char*, ProfilerZoneStats> Profiler::currentFrame;
+std::map<std::string, ProfilerZoneStats> Profiler::lastFrame;
+uint64_t Profiler::lostEvents = 0;
+
+std::vector<Profiler::CaptureEvent> Profiler::captureEvents;
+
+static_assert((PROFILER_RING_SIZE & (PROFILER_RING_SIZE - 1)) == 0, "PROFILER_RING_SIZE must be power of two");
+
+ProfilerThreadBuffer* Profiler::getThreadBuffer(){
+    if (!threadBuffer){
+        std::lock_guard<std::mutex> lock(buffersMutex);
+
+        buffers.push_back(std::make_unique<ProfilerThreadBuffer>());
+        threadBuffer = buffers.back().get();
+        threadBuffer->id = (uint32_t)buffers.size();
+        threadBuffer->name = threadName.empty() ? "Thread " + std::to_string(threadBuffer->id) : threadName;
+    }
+
+    return threadBuffer;
+}
+
+void Profiler::setEnabled(bool enabled){
+#ifndef NO_PROFILER
+    Profiler::enabled = enabled;
+#else
+    if (enabled){
+        Log::warn("Profiler was removed from build (NO_PROFILER)");
+    }
+#endif
+}
+
+void Profiler::setThreadName(const std::string& name){
+    threadName = name;
+
+    // buffer is only created with first event
+    if (threadBuffer){
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        threadBuffer->name = name;
+    }
+}
+
+const char* Profiler::getName(const std::string& name){
+    // local statics: used by systems of global scenes before static initialization of this file
+    static std::mutex namesMutex;
+    static std::set<std::string> names;
+
+    std::lock_guard<std::mutex> lock(namesMutex);
+
+    return names.insert(name).first->c_str();
+}
+
+std::string Profiler::getTypeName(const char* typeName){
+    std::string name = typeName;
+
+#ifdef __GNUC__
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(typeName, nullptr, nullptr, &status);
+    if (status == 0 && demangled){
+        name = demangled;
+    }
+    free(demangled);
+#endif
+
+    size_t pos = name.rfind("::");
+    if (pos == std::string::npos){
+        pos = name.rfind(' '); // MSVC: "class Name"
+        if (pos != std::string::npos)
+            return name.substr(pos + 1);
+        return name;
+    }
+
+    return name.substr(pos + 2);
+}
+
+void Profiler::addEvent(const char* name, uint64_t start, uint64_t end){
+    ProfilerThreadBuffer* buffer = getThreadBuffer();
+
+    // only this thread writes head, main thread reads it in endFrame
+    uint64_t head = buffer->head.load(std::memory_order_relaxed);
+    buffer->events[head & (PROFILER_RING_SIZE - 1)] = {name, start, end};
+    buffer->head.store(head + 1, std::memory_order_release);
+}
+
+void Profiler::beginFrame(){
+    if (!isEnabled())
+        return;
+
+    frameStart = stm_now();
+}
+
+void Profiler::endFrame(){
+    if (!isEnabled())
+        return;
+
+    if (frameStart != 0){
+        addEvent("Frame", frameStart, stm_now());
+    }
+
+    currentFrame.clear();
+
+    std::lock_guard<std::mutex> lock(buffersMutex);
+
+    for (auto& buffer : buffers){
+        uint64_t head = buffer->head.load(std::memory_order_acquire);
+        uint64_t tail = buffer->tail;
+
+        // ring overrun: oldest events were overwritten
+        if (head - tail > PROFILER_RING_SIZE){
+            lostEvents += head - tail - PROFILER_RING_SIZE;
+            tail = head - PROFILER_RING_SIZE;
+        }
+
+        for (uint64_t i = tail; i < head; i++){
+            const ProfilerEvent& event = buffer->events[i & (PROFILER_RING_SIZE - 1)];
+
+            ProfilerZoneStats& stats = currentFrame[event.name];
+            stats.time += stm_ms(event.end - event.start);
+            stats.calls++;
+
+            if (capturing){
+                if (captureEvents.size() < PROFILER_MAX_CAPTURE_EVENTS){
+                    captureEvents.push_back({event, buffer->id});
+                }else{
+                    capturing = false;
+                    Log::warn("Profiler capture stopped, reached %i events", PROFILER_MAX_CAPTURE_EVENTS);
+                }
+            }
+        }
+
+        buffer->tail = head;
+    }
+
+    // same zone name can have different pointers in different translation units
+    lastFrame.clear();
+    for (auto const& pair : currentFrame){
+        ProfilerZoneStats& stats = lastFrame[pair.first];
+        stats.time += pair.second.time;
+        stats.calls += pair.second.calls;
+    }
+}
+
+std::map<std::string, double> Profiler::getFrameTimes(){
+    std::map<std::string, double> times;
+    for (auto const& pair : lastFrame){
+        times[pair.first] = pair.second.time;
+    }
+    return times;
+}
+
+std::map<std::string, int> Profiler::getFrameCallCounts(){
+    std::map<std::string, int> calls;
+    for (auto const& pair : lastFrame){
+        calls[pair.first] = pair.second.calls;
+    }
+    return calls;
+}
+
+double Profiler::getFrameTime(const std::string& name){
+    auto it = lastFrame.find(name);
+    if (it == lastFrame.end())
+        return 0;
+    return it->second.time;
+}
+
+int Profiler::getFrameCalls(const std::string& name){
+    auto it = lastFrame.find(name);
+    if (it == lastFrame.end())
+        return 0;
+    return it->second.calls;
+}
+
+uint64_t Profiler::getLostEvents(){
+    return lostEvents;
+}
+
+void Profiler::startCapture(){
+    captureEvents.clear();
+    capturing = true;
+}
+
+void Profiler::stopCapture(){
+    capturing = false;
+}
+
+bool Profiler::isCapturing(){
+    return capturing;
+}
+
+static void appendJSONString(std::string& out, const char* str){
+    out += '"';
+    for (const char* c = str; *c; c++){
+        if (*c == '"' || *c == '\\')
+            out += '\\';
+        out += *c;
+    }
+    out += '"';
+}
+
+bool Profiler::saveCapture(const std::string& filename){
+    std::vector<std::string> entries;
+
+    {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        for (auto& buffer : buffers){
+            std::string entry = "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + std::to_string(buffer->id) + ",\"args\":{\"name\":";
+            appendJSONString(entry, buffer->name.c_str());
+            entry += "}}";
+            entries.push_back(entry);
+        }
+    }
+
+    char times[96];
+    for (const CaptureEvent& capture : captureEvents){
+        std::string entry = "{\"name\":";
+        appendJSONString(entry, capture.event.name);
+        snprintf(times, sizeof(times), ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f", stm_us(capture.event.start), stm_us(capture.event.end - capture.event.start));
+        entry += times;
+        entry += ",\"pid\":1,\"tid\":" + std::to_string(capture.thread) + "}";
+        entries.push_back(entry);
+    }
+
+    std::string json = "{\"traceEvents\":[\n";
+    for (size_t i = 0; i < entries.size(); i++){
+        json += entries[i];
+        json += (i + 1 < entries.size()) ? ",\n" : "\n";
+    }
+    json += "]}\n";
+
+    File file;
+    if (file.open(filename.c_str(), true) != FileErrors::FILEDATA_OK){
+        Log::error("Cannot open profiler capture file: %s", filename.c_str());
+        return false;
+    }
+
+    file.write((unsigned char*)json.data(), (unsigned int)json.size());
+
+    return true;
+}
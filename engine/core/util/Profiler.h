@@ -0,0 +1,132 @@
+//
+// (c) 2024 Eduardo Doria.
+//
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "sokol_time.h"
+
+// power of two, events of each thread kept between two frames
+#define PROFILER_RING_SIZE 16384
+#define PROFILER_MAX_CAPTURE_EVENTS 1000000
+
+// Zones are removed from build with NO_PROFILER
+#ifndef NO_PROFILER
+#define PROFILER_CONCAT_IMPL(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_IMPL(a, b)
+// name must be a string with static lifetime (literal or from Profiler::getName)
+#define PROFILE_ZONE(name) Supernova::ProfilerZone PROFILER_CONCAT(profilerZone, __LINE__)(name)
+#else
+#define PROFILE_ZONE(name)
+#endif
+
+namespace Supernova {
+
+    struct ProfilerEvent{
+        const char* name;
+        uint64_t start;
+        uint64_t end;
+    };
+
+    // Single producer ring written only by owner thread and read by main thread at frame end
+    struct ProfilerThreadBuffer{
+        ProfilerEvent events[PROFILER_RING_SIZE];
+        std::atomic<uint64_t> head{0};
+        uint64_t tail = 0;
+        uint32_t id = 0;
+        std::string name;
+    };
+
+    struct ProfilerZoneStats{
+        double time = 0; // milliseconds
+        int calls = 0;
+    };
+
+    // CPU profiler of scoped zones (PROFILE_ZONE) from any thread.
+    // Disabled by default, collected in endFrame() and optionally captured to a Chrome trace file
+    // (chrome://tracing or https://ui.perfetto.dev).
+    class Profiler{
+    private:
+        static std::atomic<bool> enabled;
+        static std::atomic<bool> capturing;
+
+        static std::mutex buffersMutex;
+        static std::vector<std::unique_ptr<ProfilerThreadBuffer>> buffers;
+        static thread_local ProfilerThreadBuffer* threadBuffer;
+        static thread_local std::string threadName;
+
+        static uint64_t frameStart;
+        static std::map<const char*, ProfilerZoneStats> currentFrame;
+        static std::map<std::string, ProfilerZoneStats> lastFrame;
+        static uint64_t lostEvents;
+
+        struct CaptureEvent{
+            ProfilerEvent event;
+            uint32_t thread;
+        };
+        static std::vector<CaptureEvent> captureEvents;
+
+        static ProfilerThreadBuffer* getThreadBuffer();
+
+    public:
+        static void setEnabled(bool enabled);
+        static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+        static void setThreadName(const std::string& name);
+
+        // copy of name kept until program end, for zones with runtime names
+        static const char* getName(const std::string& name);
+        // readable class name from typeid name, without namespace
+        static std::string getTypeName(const char* typeName);
+
+        static void addEvent(const char* name, uint64_t start, uint64_t end);
+
+        // called by Engine around each frame, in main thread
+        static void beginFrame();
+        static void endFrame();
+
+        // zones of last finished frame
+        static std::map<std::string, double> getFrameTimes();
+        static std::map<std::string, int> getFrameCallCounts();
+        static double getFrameTime(const std::string& name);
+        static int getFrameCalls(const std::string& name);
+        // events overwritten before collected, when ring size is too small
+        static uint64_t getLostEvents();
+
+        static void startCapture();
+        static void stopCapture();
+        static bool isCapturing();
+        static bool saveCapture(const std::string& filename);
+    };
+
+    class ProfilerZone{
+    private:
+        const char* name;
+        uint64_t start;
+        bool active;
+
+    public:
+        ProfilerZone(const char* name): name(name), start(0), active(Profiler::isEnabled()){
+            if (active)
+                start = stm_now();
+        }
+
+        ~ProfilerZone(){
+            if (active)
+                Profiler::addEvent(name, start, stm_now());
+        }
+    };
+
+}
+
+#endif //PROFILER_H
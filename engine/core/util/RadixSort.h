@@ -0,0 +1,66 @@
+//
+// (c) 2024 Eduardo Doria.
+//
+
+#ifndef RADIXSORT_H
+#define RADIXSORT_H
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+
+namespace Supernova {
+
+    // Stable LSD radix sort of items by their uint64_t 'key' member, 8 bits per pass.
+    // Passes where all items have the same byte are skipped. 'temp' is scratch memory
+    // that can be kept between calls to avoid allocations.
+    template<typename T>
+    void radixSort(std::vector<T>& items, std::vector<T>& temp){
+        size_t count = items.size();
+        if (count < 2)
+            return;
+
+        temp.resize(count);
+
+        size_t histograms[8][256];
+        memset(histograms, 0, sizeof(histograms));
+
+        for (size_t i = 0; i < count; i++){
+            uint64_t key = items[i].key;
+            for (int b = 0; b < 8; b++){
+                histograms[b][(key >> (b * 8)) & 0xFF]++;
+            }
+        }
+
+        std::vector<T>* src = &items;
+        std::vector<T>* dst = &temp;
+
+        for (int b = 0; b < 8; b++){
+            size_t* histogram = histograms[b];
+
+            if (histogram[((*src)[0].key >> (b * 8)) & 0xFF] == count)
+                continue; // same byte in all keys
+
+            size_t offset = 0;
+            for (int i = 0; i < 256; i++){
+                size_t c = histogram[i];
+                histogram[i] = offset;
+                offset += c;
+            }
+
+            for (size_t i = 0; i < count; i++){
+                size_t index = histogram[((*src)[i].key >> (b * 8)) & 0xFF]++;
+                (*dst)[index] = (*src)[i];
+            }
+
+            std::swap(src, dst);
+        }
+
+        if (src != &items){
+            items.swap(temp);
+        }
+    }
+
+}
+
+#endif //RADIXSORT_H
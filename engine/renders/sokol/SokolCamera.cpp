@@ -6,6 +6,7 @@
 
 #include "System.h"
 #include "SokolCmdQueue.h"
+#include "SokolObject.h"
 
 #include "sokol_gfx.h"
 
@@ -38,6 +39,7 @@ void SokolCamera::startFrameBuffer(FramebufferRender* framebuffer, size_t face){
     pass.attachments = framebuffer->backend.get(face);
     //SokolCmdQueue::add_command_begin_pass(pass);
     sg_begin_pass(pass);
+    SokolObject::resetAppliedState();
 }
 
 void SokolCamera::startFrameBuffer(){
@@ -46,6 +48,7 @@ void SokolCamera::startFrameBuffer(){
     pass.swapchain = System::instance().getSokolSwapchain();
     //SokolCmdQueue::add_command_begin_pass(pass);
     sg_begin_pass(pass);
+    SokolObject::resetAppliedState();
 }
 
 void SokolCamera::applyViewport(Rect rect){
@@ -9,12 +9,13 @@
 #include <cassert>
 
 #include "SokolCmdQueue.h"
+#include "util/Profiler.h"
 
 using namespace Supernova;
 
 // ----------------------------------------------------------------------------------------------------
 
-std::vector<SokolRenderCommand> SokolCmdQueue::m_commands[2];
+SokolCommandBuffer SokolCmdQueue::m_commands[2];
 int32_t SokolCmdQueue::m_pending_commands_index = 0;
 int32_t SokolCmdQueue::m_commit_commands_index = 1;
 std::vector<SokolRenderCleanup> SokolCmdQueue::m_cleanups;
@@ -24,13 +25,15 @@ std::atomic<bool> SokolCmdQueue::m_flushing = false;
 std::atomic<bool> SokolCmdQueue::m_commited = false;
 std::mutex SokolCmdQueue::m_execute_mutex;
 int32_t SokolCmdQueue::m_frame_index = 0;
+size_t SokolCmdQueue::m_executed_commands = 0;
+size_t SokolCmdQueue::m_executed_bytes = 0;
 
 
 
 
 // ----------------------------------------------------------------------------------------------------
 
-constexpr int32_t INITIAL_NUMBER_OF_COMMANDS = 256;
+constexpr size_t INITIAL_COMMANDS_BUFFER_SIZE = 64 * 1024;
 constexpr int32_t INITIAL_NUMBER_OF_CLEANUPS = 64;
 
 // ----------------------------------------------------------------------------------------------------
@@ -40,7 +43,7 @@ void SokolCmdQueue::start(){
 	for (int32_t i = 0; i < 2; i ++)
 	{
 		// reserve commands
-		m_commands[i].reserve(INITIAL_NUMBER_OF_COMMANDS);
+		m_commands[i].reserve(INITIAL_COMMANDS_BUFFER_SIZE);
 	}
 
 	// reserve cleamups
@@ -61,9 +64,15 @@ void SokolCmdQueue::finish(){
 
 void SokolCmdQueue::execute_commands(bool resource_only)
 {
+	PROFILE_ZONE("SokolCmdQueue::execute_commands");
+
 	// increase frame index
 	m_frame_index ++;
 
+	// reset stats
+	m_executed_commands = 0;
+	m_executed_bytes = 0;
+
 	// not commited? exit
 	if (!m_commited)
 	{
@@ -81,6 +90,10 @@ void SokolCmdQueue::execute_commands(bool resource_only)
 		// lock execute mutex
 		std::scoped_lock<std::mutex> lock(m_execute_mutex);
 
+		// stats
+		m_executed_commands = m_commands[m_commit_commands_index].count();
+		m_executed_bytes = m_commands[m_commit_commands_index].size();
+
 		// loop through commands
 		for (const auto& command : m_commands[m_commit_commands_index])
 		{
@@ -94,77 +107,116 @@ void SokolCmdQueue::execute_commands(bool resource_only)
 			switch (command.type)
 			{
 			case SokolRenderCommand::TYPE::PUSH_DEBUG_GROUP:
-				sg_push_debug_group(command.push_debug_group.name);
+				sg_push_debug_group(command.get<SokolRenderCommand::PushDebugGroup>().name);
 				break;
 			case SokolRenderCommand::TYPE::POP_DEBUG_GROUP:
 				sg_pop_debug_group();
 				break;
 			case SokolRenderCommand::TYPE::MAKE_BUFFER:
-				sg_init_buffer(command.make_buffer.buffer, command.make_buffer.desc);
+			{
+				const auto& make_buffer = command.get<SokolRenderCommand::MakeBuffer>();
+				sg_init_buffer(make_buffer.buffer, make_buffer.desc);
 				break;
+			}
 			case SokolRenderCommand::TYPE::MAKE_IMAGE:
-				sg_init_image(command.make_image.image, command.make_image.desc);
+			{
+				const auto& make_image = command.get<SokolRenderCommand::MakeImage>();
+				sg_init_image(make_image.image, make_image.desc);
 				break;
+			}
 			case SokolRenderCommand::TYPE::MAKE_SAMPLER:
-				sg_init_sampler(command.make_sampler.sampler, command.make_sampler.desc);
+			{
+				const auto& make_sampler = command.get<SokolRenderCommand::MakeSampler>();
+				sg_init_sampler(make_sampler.sampler, make_sampler.desc);
 				break;
+			}
 			case SokolRenderCommand::TYPE::MAKE_SHADER:
-				sg_init_shader(command.make_shader.shader, command.make_shader.desc);
+			{
+				const auto& make_shader = command.get<SokolRenderCommand::MakeShader>();
+				sg_init_shader(make_shader.shader, make_shader.desc);
 				break;
+			}
 			case SokolRenderCommand::TYPE::MAKE_PIPELINE:
-				sg_init_pipeline(command.make_pipeline.pipeline, command.make_pipeline.desc);
+			{
+				const auto& make_pipeline = command.get<SokolRenderCommand::MakePipeline>();
+				sg_init_pipeline(make_pipeline.pipeline, make_pipeline.desc);
 				break;
+			}
 			case SokolRenderCommand::TYPE::MAKE_ATTACHMENTS:
-				sg_init_attachments(command.make_attachments.attachments, command.make_attachments.desc);
+			{
+				const auto& make_attachments = command.get<SokolRenderCommand::MakeAttachments>();
+				sg_init_attachments(make_attachments.attachments, make_attachments.desc);
 				break;
+			}
 			case SokolRenderCommand::TYPE::DESTROY_BUFFER:
-				sg_uninit_buffer(command.destroy_buffer.buffer);
+				sg_uninit_buffer(command.get<SokolRenderCommand::DestroyBuffer>().buffer);
 				break;
 			case SokolRenderCommand::TYPE::DESTROY_IMAGE:
-				sg_uninit_image(command.destroy_image.image);
+				sg_uninit_image(command.get<SokolRenderCommand::DestroyImage>().image);
 				break;
 			case SokolRenderCommand::TYPE::DESTROY_SAMPLER:
-				sg_uninit_sampler(command.destroy_sampler.sampler);
+				sg_uninit_sampler(command.get<SokolRenderCommand::DestroySampler>().sampler);
 				break;
 			case SokolRenderCommand::TYPE::DESTROY_SHADER:
-				sg_uninit_shader(command.destroy_shader.shader);
+				sg_uninit_shader(command.get<SokolRenderCommand::DestroyShader>().shader);
 				break;
 			case SokolRenderCommand::TYPE::DESTROY_PIPELINE:
-				sg_uninit_pipeline(command.destroy_pipeline.pipeline);
+				sg_uninit_pipeline(command.get<SokolRenderCommand::DestroyPipeline>().pipeline);
 				break;
 			case SokolRenderCommand::TYPE::DESTROY_ATTACHMENTS:
-				sg_uninit_attachments(command.destroy_attachments.attachments);
+				sg_uninit_attachments(command.get<SokolRenderCommand::DestroyAttachments>().attachments);
 				break;
 			case SokolRenderCommand::TYPE::UPDATE_BUFFER:
-				sg_update_buffer(command.update_buffer.buffer, command.update_buffer.data);
+			{
+				const auto& update_buffer = command.get<SokolRenderCommand::UpdateBuffer>();
+				sg_update_buffer(update_buffer.buffer, update_buffer.data);
 				break;
+			}
 			case SokolRenderCommand::TYPE::APPEND_BUFFER:
-				sg_append_buffer(command.append_buffer.buffer, command.append_buffer.data);
+			{
+				const auto& append_buffer = command.get<SokolRenderCommand::UpdateBuffer>();
+				sg_append_buffer(append_buffer.buffer, append_buffer.data);
 				break;
+			}
 			case SokolRenderCommand::TYPE::UPDATE_IMAGE:
-				sg_update_image(command.update_image.image, command.update_image.data);
+			{
+				const auto& update_image = command.get<SokolRenderCommand::UpdateImage>();
+				sg_update_image(update_image.image, update_image.data);
 				break;
+			}
 			case SokolRenderCommand::TYPE::BEGIN_PASS:
-				sg_begin_pass(command.begin_pass.pass);
+				sg_begin_pass(command.get<SokolRenderCommand::BeginPass>().pass);
 				break;
 			case SokolRenderCommand::TYPE::APPLY_VIEWPORT:
-				sg_apply_viewport(command.apply_viewport.x, command.apply_viewport.y, command.apply_viewport.width, command.apply_viewport.height, command.apply_viewport.origin_top_left);
+			{
+				const auto& apply_viewport = command.get<SokolRenderCommand::ApplyRect>();
+				sg_apply_viewport(apply_viewport.x, apply_viewport.y, apply_viewport.width, apply_viewport.height, apply_viewport.origin_top_left);
 				break;
+			}
 			case SokolRenderCommand::TYPE::APPLY_SCISSOR_RECT:
-				sg_apply_scissor_rect(command.apply_scissor_rect.x, command.apply_scissor_rect.y, command.apply_scissor_rect.width, command.apply_scissor_rect.height, command.apply_scissor_rect.origin_top_left);
+			{
+				const auto& apply_scissor_rect = command.get<SokolRenderCommand::ApplyRect>();
+				sg_apply_scissor_rect(apply_scissor_rect.x, apply_scissor_rect.y, apply_scissor_rect.width, apply_scissor_rect.height, apply_scissor_rect.origin_top_left);
 				break;
+			}
 			case SokolRenderCommand::TYPE::APPLY_PIPELINE:
-				sg_apply_pipeline(command.apply_pipeline.pipeline);
+				sg_apply_pipeline(command.get<SokolRenderCommand::ApplyPipeline>().pipeline);
 				break;
 			case SokolRenderCommand::TYPE::APPLY_BINDINGS:
-				sg_apply_bindings(command.apply_bindings.bindings);
+				sg_apply_bindings(command.get<SokolRenderCommand::ApplyBindings>().bindings);
 				break;
 			case SokolRenderCommand::TYPE::APPLY_UNIFORMS:
-				sg_apply_uniforms(command.apply_uniforms.stage, command.apply_uniforms.ub_index, { command.apply_uniforms.buf, command.apply_uniforms.data_size });
+			{
+				const auto& apply_uniforms = command.get<SokolRenderCommand::ApplyUniforms>();
+				sg_apply_uniforms(apply_uniforms.stage, apply_uniforms.ub_index, { apply_uniforms.data(), apply_uniforms.data_size });
 				break;
+			}
 			case SokolRenderCommand::TYPE::DRAW:
-				sg_draw(command.draw.base_element, command.draw.number_of_elements, command.draw.number_of_instances);
+			{
+				const auto& draw = command.get<SokolRenderCommand::Draw>();
+				sg_draw(draw.base_element, draw.number_of_elements, draw.number_of_instances);
 				break;
+			}
 			case SokolRenderCommand::TYPE::END_PASS:
 				sg_end_pass();
 				break;
@@ -172,8 +224,11 @@ void SokolCmdQueue::execute_commands(bool resource_only)
 				sg_commit();
 				break;
 			case SokolRenderCommand::TYPE::CUSTOM:
-				command.custom.custom_cb(command.custom.custom_data);
+			{
+				const auto& custom = command.get<SokolRenderCommand::Custom>();
+				custom.custom_cb(custom.custom_data);
 				break;
+			}
 			case SokolRenderCommand::TYPE::NOT_SET:
 				break;
 			}
@@ -216,41 +271,36 @@ void SokolCmdQueue::wait_for_flush()
 				// execute command
 				switch (command.type)
 				{
+				// resources are only created in execute_commands
 				case SokolRenderCommand::TYPE::MAKE_BUFFER:
-					//sg_init_buffer(command.make_buffer.buffer, command.make_buffer.desc);
 					break;
 				case SokolRenderCommand::TYPE::MAKE_IMAGE:
-					//sg_init_image(command.make_image.image, command.make_image.desc);
 					break;
 				case SokolRenderCommand::TYPE::MAKE_SAMPLER:
-					//sg_init_sampler(command.make_sampler.sampler, command.sampler.desc);
 					break;
 				case SokolRenderCommand::TYPE::MAKE_SHADER:
-					//sg_init_shader(command.make_shader.shader, command.make_shader.desc);
 					break;
 				case SokolRenderCommand::TYPE::MAKE_PIPELINE:
-					//sg_init_pipeline(command.make_pipeline.pipeline, command.make_pipeline.desc);
 					break;
 				case SokolRenderCommand::TYPE::MAKE_ATTACHMENTS:
-					//sg_init_attachments(command.make_attachments.attachments, command.make_attachments.desc);
 					break;
 				case SokolRenderCommand::TYPE::DESTROY_BUFFER:
-					sg_uninit_buffer(command.destroy_buffer.buffer);
+					sg_uninit_buffer(command.get<SokolRenderCommand::DestroyBuffer>().buffer);
 					break;
 				case SokolRenderCommand::TYPE::DESTROY_IMAGE:
-					sg_uninit_image(command.destroy_image.image);
+					sg_uninit_image(command.get<SokolRenderCommand::DestroyImage>().image);
 					break;
 				case SokolRenderCommand::TYPE::DESTROY_SAMPLER:
-					sg_uninit_sampler(command.destroy_sampler.sampler);
+					sg_uninit_sampler(command.get<SokolRenderCommand::DestroySampler>().sampler);
 					break;
 				case SokolRenderCommand::TYPE::DESTROY_SHADER:
-					sg_uninit_shader(command.destroy_shader.shader);
+					sg_uninit_shader(command.get<SokolRenderCommand::DestroyShader>().shader);
 					break;
 				case SokolRenderCommand::TYPE::DESTROY_PIPELINE:
-					sg_uninit_pipeline(command.destroy_pipeline.pipeline);
+					sg_uninit_pipeline(command.get<SokolRenderCommand::DestroyPipeline>().pipeline);
 					break;
 				case SokolRenderCommand::TYPE::DESTROY_ATTACHMENTS:
-					sg_uninit_attachments(command.destroy_attachments.attachments);
+					sg_uninit_attachments(command.get<SokolRenderCommand::DestroyAttachments>().attachments);
 					break;
 				default:
 					break;
@@ -271,10 +321,10 @@ void SokolCmdQueue::wait_for_flush()
 void SokolCmdQueue::add_command_push_debug_group(const char* name)
 {
 	// add command
-	SokolRenderCommand& command = m_commands[m_pending_commands_index].emplace_back(SokolRenderCommand::TYPE::PUSH_DEBUG_GROUP);
+	auto& command = m_commands[m_pending_commands_index].add<SokolRenderCommand::PushDebugGroup>(SokolRenderCommand::TYPE::PUSH_DEBUG_GROUP);
 
 	// copy args
-	command.push_debug_group.name = name;
+	command.name = name;
 }
 
 // ----------------------------------------------------------------------------------------------------
@@ -282,7 +332,7 @@ void SokolCmdQueue::add_command_push_debug_group(const char* name)
 void SokolCmdQueue::add_command_pop_debug_group()
 {
 	// add command
-	/*SokolRenderCommand& command = */m_commands[m_pending_commands_index].emplace_back(SokolRenderCommand::TYPE::POP_DEBUG_GROUP);
+	m_commands[m_pending_commands_index].add(SokolRenderCommand::TYPE::POP_DEBUG_GROUP);
 }
 
 // ----------------------------------------------------------------------------------------------------
@@ -290,16 +340,16 @@ void SokolCmdQueue::add_command_pop_debug_group()
 sg_buffer SokolCmdQueue::add_command_make_buffer(const sg_buffer_desc& desc)
 {
 	// add command
-	SokolRenderCommand& command = m_commands[m_pending_commands_index].emplace_back(SokolRenderCommand::TYPE::MAKE_BUFFER);
+	auto& command = m_commands[m_pending_commands_index].add<SokolRenderCommand::MakeBuffer>(SokolRenderCommand::TYPE::MAKE_BUFFER);
 
 	// copy args
-	command.make_buffer.desc = desc;
+	command.desc = desc;
 	
 	// alloc buffer
-	command.make_buffer.buffer = sg_alloc_buffer();
+	command.buffer = sg_alloc_buffer();
 	
 	// return buffer
-	return command.make_buffer.buffer;
+	return command.buffer;
 }
 
 // ----------------------------------------------------------------------------------------------------
@@ -307,16 +357,16 @@ sg_buffer SokolCmdQueue::add_command_make_buffer(const sg_buffer_desc& desc)
 sg_image SokolCmdQueue::add_command_make_image(const sg_image_desc& desc)
 {
 	// add command
-	SokolRenderCommand& command = m_commands[m_pending_commands_index].emplace_back(SokolRenderCommand::TYPE::MAKE_IMAGE);
+	auto& command = m_commands[m_pending_commands_index].add<SokolRenderCommand::MakeImage>(SokolRenderCommand::TYPE::MAKE_IMAGE);
 
 	// copy args
-	command.make_image.desc = desc;
+	command.desc = desc;
 
 	// alloc image
-	command.make_image.image = sg_alloc_image();
+	command.image = sg_alloc_image();
 	
 	// return image
-	return command.make_image.image;
+	return command.image;
 }
 
 // ----------------------------------------------------------------------------------------------------
@@ -324,16 +374,16 @@ sg_image SokolCmdQueue::add_command_make_image(const sg_image_desc& desc)
 sg_sampler SokolCmdQueue::add_command_make_sampler(const sg_sampler_desc& desc)
 {
 	// add command
-	SokolRenderCommand& command = m_commands[m_pending_commands_index].emplace_back(SokolRenderCommand::TYPE::MAKE_SAMPLER);
+	auto& command = m_commands[m_pending_commands_index].add<SokolRenderCommand::MakeSampler>(SokolRenderCommand::TYPE::MAKE_SAMPLER);
 
 	// copy args
-	command.make_sampler.desc = desc;
+	command.desc = desc;
 
 	// alloc sampler
-	command.make_sampler.sampler = sg_alloc_sampler();
+	command.sampler = sg_alloc_sampler();
 
 	// return sampler
-	return command.make_sampler.sampler;
+	return command.sampler;
 }
 
 // ----------------------------------------------------------------------------------------------------
@@ -341,16 +391,16 @@ sg_sampler SokolCmdQueue::add_command_make_sampler(const sg_sampler_desc& desc)
 sg_shader SokolCmdQueue::add_command_make_shader(const sg_shader_desc& desc)
 {
 	// add command
-	SokolRenderCommand& command = m_commands[m_pending_commands_index].emplace_back(SokolRenderCommand::TYPE::MAKE_SHADER);
+	auto& command = m_commands[m_pending_commands_index].add<SokolRenderCommand::MakeShader>(SokolRenderCommand::TYPE::MAKE_SHADER);
 
 	// copy args
-	command.make_shader.desc = desc;
+	command.desc = desc;
 
 	// alloc shader
-	command.make_shader.shader = sg_alloc_shader();
+	command.shader = sg_alloc_shader();
 	
 	// return shader
-	return command.make_shader.shader;
+	return command.shader;
 }
 
 // ----------------------------------------------------------------------------------------------------
@@ -358,16 +408,16 @@ sg_shader SokolCmdQueue::add_command_make_shader(const sg_shader_desc& desc)
 sg_pipeline SokolCmdQueue::add_command_make_pipeline(const sg_pipeline_desc& desc)
 {
 	// add command
-	SokolRenderCommand& command = m_commands[m_pending_commands_index].emplace_back(SokolRenderCommand::TYPE::MAKE_PIPELINE);
+	auto& command = m_commands[m_pending_commands_index].add<SokolRenderCommand::MakePipeline>(SokolRenderCommand::TYPE::MAKE_PIPELINE);
 
 	// copy args
-	command.make_pipeline.desc = desc;
+	command.desc = desc;
 
 	// alloc pipeline
-	command.make_pipeline.pipeline = sg_alloc_pipeline();
+	command.pipeline = sg_alloc_pipeline();
 	
 	// return pipeline
-	return command.make_pipeline.pipeline;
+	return command.pipeline;
 }
 
 // ----------------------------------------------------------------------------------------------------
@@ -375,16 +425,16 @@ sg_pipeline SokolCmdQueue::add_command_make_pipeline(const sg_pipeline_desc& des
 sg_attachments SokolCmdQueue::add_command_make_attachments(const sg_attachments_desc& desc)
 {
 	// add command
-	SokolRenderCommand& command = m_commands[m_pending_commands_index].emplace_back(SokolRenderCommand::TYPE::MAKE_ATTACHMENTS);
+	auto& command = m_commands[m_pending_commands_index].add<SokolRenderCommand::MakeAttachments>(SokolRenderCommand::TYPE::MAKE_ATTACHMENTS);
 
 	// copy args
-	command.make_attachments.desc = desc;
+	command.desc = desc;
 
 	// alloc attachments
-	command.make_attachments.attachments = sg_alloc_attachments();
+	command.attachments = sg_alloc_attachments();
 	
 	// return attachments
-	return command.make_attachments.attachments;
+	return command.attachments;
 }
 
 // ----------------------------------------------------------------------------------------------------
@@ -392,13 +442,13 @@ sg_attachments SokolCmdQueue::add_command_make_attachments(const sg_attachments_
 void SokolCmdQueue::add_command_destroy_buffer(sg_buffer buffer)
 {
 	// add command
-	SokolRenderCommand& command = m_commands[m_pending_commands_index].emplace_back(SokolRenderCommand::TYPE::DESTROY_BUFFER);
+	auto& command = m_commands[m_pending_commands_index].add<SokolRenderCommand::DestroyBuffer>(SokolRenderCommand::TYPE::DESTROY_BUFFER);
 
 	// copy args
-	command.destroy_buffer.buffer = buffer;
+	command.buffer = buffer;
 
 	// schedule cleanup
-	schedule_cleanup(dealloc_buffer_cb, (void*)(uintptr_t)command.destroy_buffer.buffer.id);
+	schedule_cleanup(dealloc_buffer_cb, (void*)(uintptr_t)command.buffer.id);
 }
 
 // ----------------------------------------------------------------------------------------------------
@@ -406,13 +456,13 @@ void SokolCmdQueue::add_command_destroy_buffer(sg_buffer buffer)
 void SokolCmdQueue::add_command_destroy_image(sg_image image)
 {
 	// add command
-	SokolRenderCommand& command = m_commands[m_pending_commands_index].emplace_back(SokolRenderCommand::TYPE::DESTROY_IMAGE);
+	auto& command = m_commands[m_pending_commands_index].add<SokolRenderCommand::DestroyImage>(SokolRenderCommand::TYPE::DESTROY_IMAGE);
 
 	// copy args
-	command.destroy_image.image = image;
+	command.image = image;
 
 	// schedule cleanup
-	schedule_cleanup(dealloc_image_cb, (void*)(uintptr_t)command.destroy_image.image.id);
+	schedule_cleanup(dealloc_image_cb, (void*)(uintptr_t)command.image.id);
 }
 
 // ----------------------------------------------------------------------------------------------------
@@ -420,13 +470,13 @@ void SokolCmdQueue::add_command_destroy_image(sg_image image)
 void SokolCmdQueue::add_command_destroy_sampler(sg_sampler sampler)
 {
 	// add command
-	SokolRenderCommand& command = m_commands[m_pending_commands_index].emplace_back(SokolRenderCommand::TYPE::DESTROY_SAMPLER);
+	auto& command = m_commands[m_pending_commands_index].add<SokolRenderCommand::DestroySampler>(SokolRenderCommand::TYPE::DESTROY_SAMPLER);
 
 	// copy args
-	command.destroy_sampler.sampler = sampler;
+	command.sampler = sampler;
 
 	// schedule cleanup
-	schedule_cleanup(dealloc_sampler_cb, (void*)(uintptr_t)command.destroy_sampler.sampler.id);
+	schedule_cleanup(dealloc_sampler_cb, (void*)(uintptr_t)command.sampler.id);
 }
 
 // ----------------------------------------------------------------------------------------------------
@@ -434,13 +484,13 @@ void SokolCmdQueue::add_command_destroy_sampler(sg_sampler sampler)
 void SokolCmdQueue::add_command_destroy_shader(sg_shader shader)
 {
 	// add command
-	SokolRenderCommand& command = m_commands[m_pending_commands_index].emplace_back(SokolRenderCommand::TYPE::DESTROY_SHADER);
+	auto& command = m_commands[m_pending_commands_index].add<SokolRenderCommand::DestroyShader>(SokolRenderCommand::TYPE::DESTROY_SHADER);
 
 	// copy args
-	command.destroy_shader.shader = shader;
+	command.shader = shader;
 
 	// schedule cleanup
-	schedule_cleanup(dealloc_shader_cb, (void*)(uintptr_t)command.destroy_shader.shader.id);
+	schedule_cleanup(dealloc_shader_cb, (void*)(uintptr_t)command.shader.id);
 }
 
 // ----------------------------------------------------------------------------------------------------
@@ -448,13 +498,13 @@ void SokolCmdQueue::add_command_destroy_shader(sg_shader shader)
 void SokolCmdQueue::add_command_destroy_pipeline(sg_pipeline pipeline)
 {
 	// add command
-	SokolRenderCommand& command = m_commands[m_pending_commands_index].emplace_back(SokolRenderCommand::TYPE::DESTROY_PIPELINE);
+	auto& command = m_commands[m_pending_commands_index].add<SokolRenderCommand::DestroyPipeline>(SokolRenderCommand::TYPE::DESTROY_PIPELINE);
 
 	// copy args
-	command.destroy_pipeline.pipeline = pipeline;
+	command.pipeline = pipeline;
 
 	// schedule cleanup
-	schedule_cleanup(dealloc_pipeline_cb, (void*)(uintptr_t)command.destroy_pipeline.pipeline.id);
+	schedule_cleanup(dealloc_pipeline_cb, (void*)(uintptr_t)command.pipeline.id);
 }
 
 // ----------------------------------------------------------------------------------------------------
@@ -462,13 +512,13 @@ void SokolCmdQueue::add_command_destroy_pipeline(sg_pipeline pipeline)
 void SokolCmdQueue::add_command_destroy_attachments(sg_attachments atts)
 {
 	// add command
-	SokolRenderCommand& command = m_commands[m_pending_commands_index].emplace_back(SokolRenderCommand::TYPE::DESTROY_ATTACHMENTS);
+	auto& command = m_commands[m_pending_commands_index].add<SokolRenderCommand::DestroyAttachments>(SokolRenderCommand::TYPE::DESTROY_ATTACHMENTS);
 
 	// copy args
-	command.destroy_attachments.attachments = atts;
+	command.attachments = atts;
 
 	// schedule cleanup
-	schedule_cleanup(dealloc_attachments_cb, (void*)(uintptr_t)command.destroy_attachments.attachments.id);
+	schedule_cleanup(dealloc_attachments_cb, (void*)(uintptr_t)command.attachments.id);
 }
 
 // ----------------------------------------------------------------------------------------------------
@@ -476,11 +526,11 @@ void SokolCmdQueue::add_command_destroy_attachments(sg_attachments atts)
 void SokolCmdQueue::add_command_update_buffer(sg_buffer buffer, const sg_range& data)
 {
 	// add command
-	SokolRenderCommand& command = m_commands[m_pending_commands_index].emplace_back(SokolRenderCommand::TYPE::UPDATE_BUFFER);
+	auto& command = m_commands[m_pending_commands_index].add<SokolRenderCommand::UpdateBuffer>(SokolRenderCommand::TYPE::UPDATE_BUFFER);
 
 	// copy args
-	command.update_buffer.buffer = buffer;
-	command.update_buffer.data = data;
+	command.buffer = buffer;
+	command.data = data;
 }
 
 // ----------------------------------------------------------------------------------------------------
@@ -488,11 +538,11 @@ void SokolCmdQueue::add_command_update_buffer(sg_buffer buffer, const sg_range&
 void SokolCmdQueue::add_command_append_buffer(sg_buffer buffer, const sg_range& data)
 {
 	// add command
-	SokolRenderCommand& command = m_commands[m_pending_commands_index].emplace_back(SokolRenderCommand::TYPE::APPEND_BUFFER);
+	auto& command = m_commands[m_pending_commands_index].add<SokolRenderCommand::UpdateBuffer>(SokolRenderCommand::TYPE::APPEND_BUFFER);
 
 	// copy args
-	command.append_buffer.buffer = buffer;
-	command.append_buffer.data = data;
+	command.buffer = buffer;
+	command.data = data;
 }
 
 // ----------------------------------------------------------------------------------------------------
@@ -500,11 +550,11 @@ void SokolCmdQueue::add_command_append_buffer(sg_buffer buffer, const sg_range&
 void SokolCmdQueue::add_command_update_image(sg_image image, const sg_image_data& data)
 {
 	// add command
-	SokolRenderCommand& command = m_commands[m_pending_commands_index].emplace_back(SokolRenderCommand::TYPE::UPDATE_IMAGE);
+	auto& command = m_commands[m_pending_commands_index].add<SokolRenderCommand::UpdateImage>(SokolRenderCommand::TYPE::UPDATE_IMAGE);
 
 	// copy args
-	command.update_image.image = image;
-	command.update_image.data = data;
+	command.image = image;
+	command.data = data;
 }
 
 // ----------------------------------------------------------------------------------------------------
@@ -512,10 +562,10 @@ void SokolCmdQueue::add_command_update_image(sg_image image, const sg_image_data
 void SokolCmdQueue::add_command_begin_pass(const sg_pass& pass)
 {
 	// add command
-	SokolRenderCommand& command = m_commands[m_pending_commands_index].emplace_back(SokolRenderCommand::TYPE::BEGIN_PASS);
+	auto& command = m_commands[m_pending_commands_index].add<SokolRenderCommand::BeginPass>(SokolRenderCommand::TYPE::BEGIN_PASS);
 
 	// copy args
-	command.begin_pass.pass = pass;
+	command.pass = pass;
 }
 
 // ----------------------------------------------------------------------------------------------------
@@ -523,14 +573,14 @@ void SokolCmdQueue::add_command_begin_pass(const sg_pass& pass)
 void SokolCmdQueue::add_command_apply_viewport(int x, int y, int width, int height, bool origin_top_left)
 {
 	// add command
-	SokolRenderCommand& command = m_commands[m_pending_commands_index].emplace_back(SokolRenderCommand::TYPE::APPLY_VIEWPORT);
+	auto& command = m_commands[m_pending_commands_index].add<SokolRenderCommand::ApplyRect>(SokolRenderCommand::TYPE::APPLY_VIEWPORT);
 
 	// copy args
-	command.apply_viewport.x = x;
-	command.apply_viewport.y = y;
-	command.apply_viewport.width = width;
-	command.apply_viewport.height = height;
-	command.apply_viewport.origin_top_left = origin_top_left;
+	command.x = x;
+	command.y = y;
+	command.width = width;
+	command.height = height;
+	command.origin_top_left = origin_top_left;
 }
 
 // ----------------------------------------------------------------------------------------------------
@@ -538,14 +588,14 @@ void SokolCmdQueue::add_command_apply_viewport(int x, int y, int width, int heig
 void SokolCmdQueue::add_command_apply_scissor_rect(int x, int y, int width, int height, bool origin_top_left)
 {
 	// add command
-	SokolRenderCommand& command = m_commands[m_pending_commands_index].emplace_back(SokolRenderCommand::TYPE::APPLY_SCISSOR_RECT);
+	auto& command = m_commands[m_pending_commands_index].add<SokolRenderCommand::ApplyRect>(SokolRenderCommand::TYPE::APPLY_SCISSOR_RECT);
 
 	// copy args
-	command.apply_scissor_rect.x = x;
-	command.apply_scissor_rect.y = y;
-	command.apply_scissor_rect.width = width;
-	command.apply_scissor_rect.height = height;
-	command.apply_scissor_rect.origin_top_left = origin_top_left;
+	command.x = x;
+	command.y = y;
+	command.width = width;
+	command.height = height;
+	command.origin_top_left = origin_top_left;
 }
 
 // ----------------------------------------------------------------------------------------------------
@@ -553,10 +603,10 @@ void SokolCmdQueue::add_command_apply_scissor_rect(int x, int y, int width, int
 void SokolCmdQueue::add_command_apply_pipeline(sg_pipeline pipeline)
 {
 	// add command
-	SokolRenderCommand& command = m_commands[m_pending_commands_index].emplace_back(SokolRenderCommand::TYPE::APPLY_PIPELINE);
+	auto& command = m_commands[m_pending_commands_index].add<SokolRenderCommand::ApplyPipeline>(SokolRenderCommand::TYPE::APPLY_PIPELINE);
 
 	// copy args
-	command.apply_pipeline.pipeline = pipeline;
+	command.pipeline = pipeline;
 }
 
 // ----------------------------------------------------------------------------------------------------
@@ -564,27 +614,24 @@ void SokolCmdQueue::add_command_apply_pipeline(sg_pipeline pipeline)
 void SokolCmdQueue::add_command_apply_bindings(const sg_bindings& bindings)
 {
 	// add command
-	SokolRenderCommand& command = m_commands[m_pending_commands_index].emplace_back(SokolRenderCommand::TYPE::APPLY_BINDINGS);
+	auto& command = m_commands[m_pending_commands_index].add<SokolRenderCommand::ApplyBindings>(SokolRenderCommand::TYPE::APPLY_BINDINGS);
 
 	// copy args
-	command.apply_bindings.bindings = bindings;
+	command.bindings = bindings;
 }
 
 // ----------------------------------------------------------------------------------------------------
 
 void SokolCmdQueue::add_command_apply_uniforms(sg_shader_stage stage, int ub_index, const sg_range& data)
 {
-	// data size too big?
-	assert((size_t)data.size <= sizeof(SokolRenderCommand::apply_uniforms.buf));
-
-	// add command
-	SokolRenderCommand& command = m_commands[m_pending_commands_index].emplace_back(SokolRenderCommand::TYPE::APPLY_UNIFORMS);
+	// add command, uniform data is copied inline with its real size
+	auto& command = m_commands[m_pending_commands_index].add<SokolRenderCommand::ApplyUniforms>(SokolRenderCommand::TYPE::APPLY_UNIFORMS, data.size);
 
 	// copy args
-	command.apply_uniforms.stage = stage;
-	command.apply_uniforms.ub_index = ub_index;
-	memcpy(command.apply_uniforms.buf, data.ptr, data.size);
-	command.apply_uniforms.data_size = data.size;
+	command.stage = stage;
+	command.ub_index = ub_index;
+	command.data_size = data.size;
+	memcpy(command.data(), data.ptr, data.size);
 }
 
 // ----------------------------------------------------------------------------------------------------
@@ -592,12 +639,12 @@ void SokolCmdQueue::add_command_apply_uniforms(sg_shader_stage stage, int ub_ind
 void SokolCmdQueue::add_command_draw(int base_element, int number_of_elements, int number_of_instances)
 {
 	// add command
-	SokolRenderCommand& command = m_commands[m_pending_commands_index].emplace_back(SokolRenderCommand::TYPE::DRAW);
+	auto& command = m_commands[m_pending_commands_index].add<SokolRenderCommand::Draw>(SokolRenderCommand::TYPE::DRAW);
 
 	// copy args
-	command.draw.base_element = base_element;
-	command.draw.number_of_elements = number_of_elements;
-	command.draw.number_of_instances = number_of_instances;
+	command.base_element = base_element;
+	command.number_of_elements = number_of_elements;
+	command.number_of_instances = number_of_instances;
 }
 
 // ----------------------------------------------------------------------------------------------------
@@ -605,7 +652,7 @@ void SokolCmdQueue::add_command_draw(int base_element, int number_of_elements, i
 void SokolCmdQueue::add_command_end_pass()
 {
 	// add command
-	/*SokolRenderCommand& command = */m_commands[m_pending_commands_index].emplace_back(SokolRenderCommand::TYPE::END_PASS);
+	m_commands[m_pending_commands_index].add(SokolRenderCommand::TYPE::END_PASS);
 }
 
 // ----------------------------------------------------------------------------------------------------
@@ -613,7 +660,7 @@ void SokolCmdQueue::add_command_end_pass()
 void SokolCmdQueue::add_command_commit()
 {
 	// add command
-	/*SokolRenderCommand& command = */m_commands[m_pending_commands_index].emplace_back(SokolRenderCommand::TYPE::COMMIT);
+	m_commands[m_pending_commands_index].add(SokolRenderCommand::TYPE::COMMIT);
 }
 
 // ----------------------------------------------------------------------------------------------------
@@ -621,11 +668,11 @@ void SokolCmdQueue::add_command_commit()
 void SokolCmdQueue::add_command_custom(void (*custom_cb)(void* custom_data), void* custom_data)
 {
 	// add command
-	SokolRenderCommand& command = m_commands[m_pending_commands_index].emplace_back(SokolRenderCommand::TYPE::CUSTOM);
+	auto& command = m_commands[m_pending_commands_index].add<SokolRenderCommand::Custom>(SokolRenderCommand::TYPE::CUSTOM);
 
 	// copy args
-	command.custom.custom_cb = custom_cb;
-	command.custom.custom_data = custom_data;
+	command.custom_cb = custom_cb;
+	command.custom_data = custom_data;
 }
 
 // ----------------------------------------------------------------------------------------------------
@@ -647,7 +694,7 @@ void SokolCmdQueue::commit_commands()
 	m_render_semaphore.acquire();
 	
 	// clear commands
-	m_commands[m_commit_commands_index].resize(0);
+	m_commands[m_commit_commands_index].clear();
 	
 	// swap commands indexes
 	std::swap(m_pending_commands_index, m_commit_commands_index);
@@ -667,7 +714,7 @@ void SokolCmdQueue::flush_commands()
 	m_render_semaphore.acquire();
 	
 	// clear commands
-	m_commands[m_commit_commands_index].resize(0);
+	m_commands[m_commit_commands_index].clear();
 	
 	// swap commands indexes
 	std::swap(m_pending_commands_index, m_commit_commands_index);
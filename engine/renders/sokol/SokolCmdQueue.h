@@ -12,6 +12,9 @@
 #include <mutex>
 #include <atomic>
 #include <memory>
+#include <new>
+#include <cstddef>
+#include <cstdint>
 
 #include "sokol_gfx.h"
 
@@ -63,156 +66,208 @@ namespace Supernova {
 			};
 		};
 		
-		SokolRenderCommand() {}
-		SokolRenderCommand(TYPE::ENUM _type) : type(_type) {}
+		// payloads, stored right after the command header
+		struct PushDebugGroup
+		{
+			const char* name;
+		};
 
-		TYPE::ENUM type = TYPE::NOT_SET;
+		struct MakeBuffer
+		{
+			sg_buffer_desc desc;
+			sg_buffer buffer;
+		};
 
-		union
+		struct MakeImage
 		{
-			struct
-			{
-				const char* name;
-			} push_debug_group;
+			sg_image_desc desc;
+			sg_image image;
+		};
 
-			struct
-			{
-				sg_buffer_desc desc;
-				sg_buffer buffer;
-			} make_buffer;
-			
-			struct
-			{
-				sg_image_desc desc;
-				sg_image image;
-			} make_image;
+		struct MakeSampler
+		{
+			sg_sampler_desc desc;
+			sg_sampler sampler;
+		};
 
-			struct
-			{
-				sg_sampler_desc desc;
-				sg_sampler sampler;
-			} make_sampler;
-			
-			struct
-			{
-				sg_shader_desc desc;
-				sg_shader shader;
-			} make_shader;
-			
-			struct
-			{
-				sg_pipeline_desc desc;
-				sg_pipeline pipeline;
-			} make_pipeline;
-			
-			struct
-			{
-				sg_attachments_desc desc;
-				sg_attachments attachments;
-			} make_attachments;
-			
-			struct
-			{
-				sg_buffer buffer;
-			} destroy_buffer;
-			
-			struct
-			{
-				sg_image image;
-			} destroy_image;
-			
-			struct
-			{
-				sg_sampler sampler;
-			} destroy_sampler;
-			
-			struct
-			{
-				sg_shader shader;
-			} destroy_shader;
-			
-			struct
-			{
-				sg_pipeline pipeline;
-			} destroy_pipeline;
-			
-			struct
-			{
-				sg_attachments attachments;
-			} destroy_attachments;
-			
-			struct
-			{
-				sg_buffer buffer;
-				sg_range data;
-			} update_buffer;
-			
-			struct
-			{
-				sg_buffer buffer;
-				sg_range data;
-			} append_buffer;
-			
-			struct
-			{
-				sg_image image;
-				sg_image_data data;
-			} update_image;
-			
-			struct
-			{
-				void (*custom_cb)(void* custom_data);
-				void* custom_data;
-			} custom;
+		struct MakeShader
+		{
+			sg_shader_desc desc;
+			sg_shader shader;
+		};
 
-			struct
-			{
-				sg_pass pass;
-			} begin_pass;
+		struct MakePipeline
+		{
+			sg_pipeline_desc desc;
+			sg_pipeline pipeline;
+		};
 
-			struct
-			{
-				int x;
-				int y;
-				int width;
-				int height;
-				bool origin_top_left;
-			} apply_viewport;
-			
-			struct
-			{
-				int x;
-				int y;
-				int width;
-				int height;
-				bool origin_top_left;
-			} apply_scissor_rect;
-			
-			struct
-			{
-				sg_pipeline pipeline;
-			} apply_pipeline;
-			
-			struct
-			{
-				sg_bindings bindings;
-			} apply_bindings;
-			
-			struct
-			{
-				sg_shader_stage stage;
-				int ub_index;
-				size_t data_size;
-				char buf[16384];
-			} apply_uniforms;
-			
-			struct
-			{
-				int base_element;
-				int number_of_elements;
-				int number_of_instances;
-			} draw;
+		struct MakeAttachments
+		{
+			sg_attachments_desc desc;
+			sg_attachments attachments;
+		};
+
+		struct DestroyBuffer
+		{
+			sg_buffer buffer;
+		};
+
+		struct DestroyImage
+		{
+			sg_image image;
+		};
+
+		struct DestroySampler
+		{
+			sg_sampler sampler;
+		};
+
+		struct DestroyShader
+		{
+			sg_shader shader;
+		};
+
+		struct DestroyPipeline
+		{
+			sg_pipeline pipeline;
+		};
+
+		struct DestroyAttachments
+		{
+			sg_attachments attachments;
+		};
+
+		struct UpdateBuffer
+		{
+			sg_buffer buffer;
+			sg_range data;
+		};
+
+		struct UpdateImage
+		{
+			sg_image image;
+			sg_image_data data;
+		};
+
+		struct Custom
+		{
+			void (*custom_cb)(void* custom_data);
+			void* custom_data;
+		};
+
+		struct BeginPass
+		{
+			sg_pass pass;
+		};
+
+		struct ApplyRect
+		{
+			int x;
+			int y;
+			int width;
+			int height;
+			bool origin_top_left;
+		};
+
+		struct ApplyPipeline
+		{
+			sg_pipeline pipeline;
+		};
+
+		struct ApplyBindings
+		{
+			sg_bindings bindings;
+		};
+
+		// followed by data_size bytes of uniform data
+		struct ApplyUniforms
+		{
+			sg_shader_stage stage;
+			int ub_index;
+			size_t data_size;
+
+			void* data() { return this + 1; }
+			const void* data() const { return this + 1; }
+		};
+
+		struct Draw
+		{
+			int base_element;
+			int number_of_elements;
+			int number_of_instances;
+		};
+
+		// header
+		TYPE::ENUM type = TYPE::NOT_SET;
+		uint32_t size = 0; // header + payload bytes, aligned
+
+		template<typename T>
+		T& get() { return *reinterpret_cast<T*>(reinterpret_cast<uint8_t*>(this) + header_size()); }
+
+		template<typename T>
+		const T& get() const { return *reinterpret_cast<const T*>(reinterpret_cast<const uint8_t*>(this) + header_size()); }
+
+		static constexpr size_t align(size_t size) { return (size + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1); }
+		static constexpr size_t header_size() { return align(sizeof(SokolRenderCommand)); }
+	};
+
+// ----------------------------------------------------------------------------------------------------
+
+	// Linear byte arena of variable size commands, reused every frame
+	class SokolCommandBuffer
+	{
+	public:
+		class const_iterator
+		{
+		public:
+			const_iterator(const uint8_t* ptr) : m_ptr(ptr) {}
+
+			const SokolRenderCommand& operator*() const { return *reinterpret_cast<const SokolRenderCommand*>(m_ptr); }
+			const_iterator& operator++() { m_ptr += reinterpret_cast<const SokolRenderCommand*>(m_ptr)->size; return *this; }
+			bool operator!=(const const_iterator& other) const { return m_ptr != other.m_ptr; }
+
+		private:
+			const uint8_t* m_ptr;
 		};
+
+		// reference is valid until next add
+		template<typename T>
+		T& add(SokolRenderCommand::TYPE::ENUM type, size_t extra_size = 0)
+		{
+			SokolRenderCommand& command = add_command(type, sizeof(T) + extra_size);
+			return *new (&command.get<T>()) T();
+		}
+
+		void add(SokolRenderCommand::TYPE::ENUM type) { add_command(type, 0); }
+
+		void reserve(size_t bytes) { m_data.reserve(bytes); }
+		void clear() { m_data.resize(0); m_count = 0; }
+		size_t size() const { return m_data.size(); }
+		size_t count() const { return m_count; }
+
+		const_iterator begin() const { return const_iterator(m_data.data()); }
+		const_iterator end() const { return const_iterator(m_data.data() + m_data.size()); }
+
+	private:
+		SokolRenderCommand& add_command(SokolRenderCommand::TYPE::ENUM type, size_t payload_size)
+		{
+			size_t offset = m_data.size();
+			size_t size = SokolRenderCommand::header_size() + SokolRenderCommand::align(payload_size);
+
+			m_data.resize(offset + size);
+
+			SokolRenderCommand& command = *new (m_data.data() + offset) SokolRenderCommand();
+			command.type = type;
+			command.size = (uint32_t)size;
+
+			m_count++;
+
+			return command;
+		}
+
+		std::vector<uint8_t> m_data;
+		size_t m_count = 0;
 	};
 
 // ----------------------------------------------------------------------------------------------------
@@ -278,6 +333,10 @@ namespace Supernova {
 		static void commit_commands();
 		static void flush_commands();
 		
+		// commands and bytes of last executed frame
+		static size_t get_executed_commands() { return m_executed_commands; }
+		static size_t get_executed_bytes() { return m_executed_bytes; }
+
 		static void lock_execute_mutex() { m_execute_mutex.lock(); }
 		static void unlock_execute_mutex() { m_execute_mutex.unlock(); }
 
@@ -293,7 +352,7 @@ namespace Supernova {
 		static void dealloc_pipeline_cb(void* cleanup_data) { sg_dealloc_pipeline({(uint32_t)(uintptr_t)cleanup_data}); }
 		static void dealloc_attachments_cb(void* cleanup_data) { sg_dealloc_attachments({(uint32_t)(uintptr_t)cleanup_data}); }
 
-		static std::vector<SokolRenderCommand> m_commands[2];
+		static SokolCommandBuffer m_commands[2];
 		static int32_t m_pending_commands_index;
 		static int32_t m_commit_commands_index;
 		static std::vector<SokolRenderCleanup> m_cleanups;
@@ -304,6 +363,8 @@ namespace Supernova {
 		static std::atomic<bool> m_commited;
 		static std::mutex m_execute_mutex;
 		static int32_t m_frame_index;
+		static size_t m_executed_commands;
+		static size_t m_executed_bytes;
 	};
 
 // ----------------------------------------------------------------------------------------------------
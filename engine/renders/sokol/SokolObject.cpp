@@ -9,16 +9,124 @@
 #include "Log.h"
 #include "SokolCmdQueue.h"
 #include "Engine.h"
+#include <cstring>
+#include <algorithm>
 
 using namespace Supernova;
 
+uint32_t SokolObject::appliedPipeline = SG_INVALID_ID;
+sg_bindings SokolObject::appliedBindings = {};
+bool SokolObject::hasAppliedBindings = false;
+const void* SokolObject::appliedUniforms[SG_NUM_SHADER_STAGES][SG_MAX_SHADERSTAGE_UBS] = {};
+
+std::mutex SokolObject::pipelinesMutex;
+
+std::map<uint32_t, SokolPipelineEntry>& SokolObject::getPipelines(){
+    //To prevent similar problem of static init fiasco but on deinitialization
+    //https://isocpp.org/wiki/faq/ctors#static-init-order-on-first-use
+    static std::map<uint32_t, SokolPipelineEntry>* map = new std::map<uint32_t, SokolPipelineEntry>();
+    return *map;
+}
+
+std::map<uint64_t, std::vector<uint32_t>>& SokolObject::getPipelineHashes(){
+    static std::map<uint64_t, std::vector<uint32_t>>* map = new std::map<uint64_t, std::vector<uint32_t>>();
+    return *map;
+}
+
+// FNV-1a over all bytes, descriptions are memset and only copied with memcpy so padding bytes are zero
+static uint64_t hashPipelineDesc(const sg_pipeline_desc& desc){
+    const unsigned char* bytes = (const unsigned char*)&desc;
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < sizeof(sg_pipeline_desc); i++){
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+sg_pipeline SokolObject::makePipeline(const sg_pipeline_desc& desc){
+    // label is only for debug, it is not part of pipeline state
+    sg_pipeline_desc key;
+    memcpy(&key, &desc, sizeof(sg_pipeline_desc));
+    key.label = nullptr;
+
+    uint64_t hash = hashPipelineDesc(key);
+
+    std::lock_guard<std::mutex> lock(pipelinesMutex);
+
+    auto& pipelines = getPipelines();
+    auto& hashes = getPipelineHashes();
+
+    auto it = hashes.find(hash);
+    if (it != hashes.end()){
+        for (uint32_t id : it->second){
+            SokolPipelineEntry& entry = pipelines[id];
+            if (memcmp(&entry.desc, &key, sizeof(sg_pipeline_desc)) == 0){
+                entry.refs++;
+                return {id};
+            }
+        }
+    }
+
+    sg_pipeline pipeline;
+    if (Engine::isAsyncThread()){
+        pipeline = SokolCmdQueue::add_command_make_pipeline(desc);
+    }else{
+        pipeline = sg_make_pipeline(desc);
+    }
+
+    if (pipeline.id != SG_INVALID_ID){
+        SokolPipelineEntry& entry = pipelines[pipeline.id];
+        memcpy(&entry.desc, &key, sizeof(sg_pipeline_desc));
+        entry.hash = hash;
+        entry.refs = 1;
+        hashes[hash].push_back(pipeline.id);
+    }
+
+    return pipeline;
+}
+
+void SokolObject::releasePipeline(sg_pipeline pipeline){
+    std::lock_guard<std::mutex> lock(pipelinesMutex);
+
+    auto& pipelines = getPipelines();
+
+    auto it = pipelines.find(pipeline.id);
+    if (it == pipelines.end()){
+        return;
+    }
+
+    if (--it->second.refs > 0){
+        return;
+    }
+
+    std::vector<uint32_t>& ids = getPipelineHashes()[it->second.hash];
+    ids.erase(std::remove(ids.begin(), ids.end(), pipeline.id), ids.end());
+    if (ids.empty()){
+        getPipelineHashes().erase(it->second.hash);
+    }
+    pipelines.erase(it);
+
+    if (sg_isvalid()){
+        if (Engine::isAsyncThread()){
+            SokolCmdQueue::add_command_destroy_pipeline(pipeline);
+        }else{
+            sg_destroy_pipeline(pipeline);
+        }
+    }
+}
+
+size_t SokolObject::getNumPipelines(){
+    std::lock_guard<std::mutex> lock(pipelinesMutex);
+
+    return getPipelines().size();
+}
 
 SokolObject::SokolObject(){
     pip.id = SG_INVALID_ID;
     depth_pip.id = SG_INVALID_ID;
     rtt_pip.id = SG_INVALID_ID;
     bind = {}; 
-    pipeline_desc = {};
+    memset(&pipeline_desc, 0, sizeof(sg_pipeline_desc));
     bindSlotIndex = 0;
 }
 
@@ -27,7 +135,7 @@ SokolObject::SokolObject(const SokolObject& rhs) {
     pip = rhs.pip;
     depth_pip = rhs.depth_pip;
     rtt_pip = rhs.rtt_pip;
-    pipeline_desc = rhs.pipeline_desc;
+    memcpy(&pipeline_desc, &rhs.pipeline_desc, sizeof(sg_pipeline_desc));
     bindSlotIndex = rhs.bindSlotIndex;
     bufferToBindSlot = rhs.bufferToBindSlot;
 }
@@ -37,7 +145,7 @@ SokolObject& SokolObject::operator=(const SokolObject& rhs) {
     pip = rhs.pip;
     depth_pip = rhs.depth_pip;
     rtt_pip = rhs.rtt_pip;
-    pipeline_desc = rhs.pipeline_desc;
+    memcpy(&pipeline_desc, &rhs.pipeline_desc, sizeof(sg_pipeline_desc));
     bindSlotIndex = rhs.bindSlotIndex;
     bufferToBindSlot = rhs.bufferToBindSlot;
     
@@ -116,7 +224,7 @@ void SokolObject::beginLoad(PrimitiveType primitiveType){
     pip = {0};
     depth_pip = {0};
     rtt_pip = {0};
-    pipeline_desc = {0};
+    memset(&pipeline_desc, 0, sizeof(sg_pipeline_desc));
 
     pipeline_desc.primitive_type = getPrimitiveType(primitiveType);
 
@@ -129,6 +237,10 @@ void SokolObject::addIndex(BufferRender* buffer, AttributeDataType dataType, siz
     bind.index_buffer = ibuf;
     bind.index_buffer_offset = offset;
 
+    addIndexType(dataType);
+}
+
+void SokolObject::addIndexType(AttributeDataType dataType){
     if (dataType == AttributeDataType::UNSIGNED_SHORT){
         pipeline_desc.index_type = SG_INDEXTYPE_UINT16;
     }else if (dataType == AttributeDataType::UNSIGNED_INT){
@@ -138,43 +250,56 @@ void SokolObject::addIndex(BufferRender* buffer, AttributeDataType dataType, siz
     }
 }
 
-void SokolObject::addAttribute(int slot, BufferRender* buffer, unsigned int elements, AttributeDataType dataType, unsigned int stride, size_t offset, bool normalized, bool perInstance){
-    if (slot != -1){
-        sg_buffer vbuf = buffer->backend.get();
+size_t SokolObject::addVertexLayout(int slot, uint32_t bufferKey, unsigned int elements, AttributeDataType dataType, unsigned int stride, size_t offset, bool normalized, bool perInstance){
+    // D3D11 cannot have offset (AlignedByteOffset) bigger than 2048
+    // https://github.com/floooh/sokol/issues/818
+    // Metal also cannot use large offsets
+    size_t bufferOffset = 0;
+    size_t attrOffset = 0;
+
+    if (Engine::isOpenGL()){
+        bufferOffset = 0;
+        attrOffset = offset;
+    }else{
+        bufferOffset = offset;
+        attrOffset = 0;
+    }
+    
+    if (bufferToBindSlot.count({bufferKey, bufferOffset}) == 0){
+        bind.vertex_buffer_offsets[bindSlotIndex] = bufferOffset;
+        bufferToBindSlot[{bufferKey, bufferOffset}] = bindSlotIndex;
 
-        // D3D11 cannot have offset (AlignedByteOffset) bigger than 2048
-        // https://github.com/floooh/sokol/issues/818
-        // Metal also cannot use large offsets
-        size_t bufferOffset = 0;
-        size_t attrOffset = 0;
+        pipeline_desc.layout.buffers[bindSlotIndex].stride = stride;
 
-        if (Engine::isOpenGL()){
-            bufferOffset = 0;
-            attrOffset = offset;
-        }else{
-            bufferOffset = offset;
-            attrOffset = 0;
+        if (perInstance){
+            pipeline_desc.layout.buffers[bindSlotIndex].step_func = SG_VERTEXSTEP_PER_INSTANCE;
         }
-        
-        if (bufferToBindSlot.count({vbuf.id, bufferOffset}) == 0){
-            bind.vertex_buffers[bindSlotIndex] = vbuf;
-            bind.vertex_buffer_offsets[bindSlotIndex] = bufferOffset;
-            bufferToBindSlot[{vbuf.id, bufferOffset}] = bindSlotIndex;
 
-            pipeline_desc.layout.buffers[bindSlotIndex].stride = stride;
+        bindSlotIndex++;
+    }
 
-            if (perInstance){
-                pipeline_desc.layout.buffers[bindSlotIndex].step_func = SG_VERTEXSTEP_PER_INSTANCE;
-            }
+    size_t indexBuf = bufferToBindSlot[{bufferKey, bufferOffset}];
 
-            bindSlotIndex++;
-        }
+    pipeline_desc.layout.attrs[slot].buffer_index = indexBuf;
+    pipeline_desc.layout.attrs[slot].offset = attrOffset;
+    pipeline_desc.layout.attrs[slot].format = getVertexFormat(elements, dataType, normalized);
 
-        size_t indexBuf = bufferToBindSlot[{vbuf.id, bufferOffset}];
+    return indexBuf;
+}
 
-        pipeline_desc.layout.attrs[slot].buffer_index = indexBuf;
-        pipeline_desc.layout.attrs[slot].offset = attrOffset;
-        pipeline_desc.layout.attrs[slot].format = getVertexFormat(elements, dataType, normalized);
+void SokolObject::addAttribute(int slot, BufferRender* buffer, unsigned int elements, AttributeDataType dataType, unsigned int stride, size_t offset, bool normalized, bool perInstance){
+    if (slot != -1){
+        sg_buffer vbuf = buffer->backend.get();
+
+        size_t indexBuf = addVertexLayout(slot, vbuf.id, elements, dataType, stride, offset, normalized, perInstance);
+        bind.vertex_buffers[indexBuf] = vbuf;
+    }
+}
+
+void SokolObject::addAttributeLayout(int slot, int bufferIndex, unsigned int elements, AttributeDataType dataType, unsigned int stride, size_t offset, bool normalized, bool perInstance){
+    if (slot != -1){
+        // any different key for each buffer gives same layout of real buffers
+        addVertexLayout(slot, (uint32_t)bufferIndex, elements, dataType, stride, offset, normalized, perInstance);
     }
 }
 
@@ -211,7 +336,8 @@ void SokolObject::addTexture(std::pair<int, int> slot, ShaderStageType stage, Te
 bool SokolObject::endLoad(uint8_t pipelines, bool enableFaceCulling, CullingMode cullingMode, WindingOrder windingOrder){
 
     if (pipelines & (int)PipelineType::PIP_DEPTH) {
-        sg_pipeline_desc pip_depth_desc = pipeline_desc;
+        sg_pipeline_desc pip_depth_desc;
+        memcpy(&pip_depth_desc, &pipeline_desc, sizeof(sg_pipeline_desc));
 
         if (enableFaceCulling){
             pip_depth_desc.cull_mode = getCullMode(cullingMode);
@@ -224,11 +350,7 @@ bool SokolObject::endLoad(uint8_t pipelines, bool enableFaceCulling, CullingMode
         pip_depth_desc.depth.write_enabled = true;
         pip_depth_desc.colors[0].pixel_format = SG_PIXELFORMAT_RGBA8;
 
-        if (Engine::isAsyncThread()){
-            depth_pip = SokolCmdQueue::add_command_make_pipeline(pip_depth_desc);
-        }else{
-            depth_pip = sg_make_pipeline(pip_depth_desc);
-        }
+        depth_pip = makePipeline(pip_depth_desc);
 
         if (depth_pip.id == SG_INVALID_ID){
             return false;
@@ -236,7 +358,8 @@ bool SokolObject::endLoad(uint8_t pipelines, bool enableFaceCulling, CullingMode
     }
 
     if (pipelines & (int)PipelineType::PIP_DEFAULT) {
-        sg_pipeline_desc pip_default_desc = pipeline_desc;
+        sg_pipeline_desc pip_default_desc;
+        memcpy(&pip_default_desc, &pipeline_desc, sizeof(sg_pipeline_desc));
 
         if (enableFaceCulling){
             pip_default_desc.cull_mode = getCullMode(cullingMode);
@@ -251,11 +374,7 @@ bool SokolObject::endLoad(uint8_t pipelines, bool enableFaceCulling, CullingMode
         pip_default_desc.colors[0].blend.src_factor_rgb = SG_BLENDFACTOR_SRC_ALPHA;
         pip_default_desc.colors[0].blend.dst_factor_rgb = SG_BLENDFACTOR_ONE_MINUS_SRC_ALPHA;
 
-        if (Engine::isAsyncThread()){
-            pip = SokolCmdQueue::add_command_make_pipeline(pip_default_desc);
-        }else{
-            pip = sg_make_pipeline(pip_default_desc);
-        }
+        pip = makePipeline(pip_default_desc);
 
         if (pip.id == SG_INVALID_ID){
             return false;
@@ -263,7 +382,8 @@ bool SokolObject::endLoad(uint8_t pipelines, bool enableFaceCulling, CullingMode
     }
 
     if (pipelines & (int)PipelineType::PIP_RTT){
-        sg_pipeline_desc pip_rtt_desc = pipeline_desc;
+        sg_pipeline_desc pip_rtt_desc;
+        memcpy(&pip_rtt_desc, &pipeline_desc, sizeof(sg_pipeline_desc));
 
         if (enableFaceCulling){
             pip_rtt_desc.cull_mode = getCullMode(cullingMode);
@@ -285,11 +405,7 @@ bool SokolObject::endLoad(uint8_t pipelines, bool enableFaceCulling, CullingMode
         pip_rtt_desc.depth.pixel_format = SG_PIXELFORMAT_DEPTH;
         pip_rtt_desc.colors[0].pixel_format = SG_PIXELFORMAT_RGBA8;
 
-        if (Engine::isAsyncThread()){
-            rtt_pip = SokolCmdQueue::add_command_make_pipeline(pip_rtt_desc);
-        }else{
-            rtt_pip = sg_make_pipeline(pip_rtt_desc);
-        }
+        rtt_pip = makePipeline(pip_rtt_desc);
 
         if (rtt_pip.id == SG_INVALID_ID){
             return false;
@@ -299,25 +415,51 @@ bool SokolObject::endLoad(uint8_t pipelines, bool enableFaceCulling, CullingMode
     return true;
 }
 
+void SokolObject::resetAppliedState(){
+    appliedPipeline = SG_INVALID_ID;
+    hasAppliedBindings = false;
+    resetAppliedUniforms();
+}
+
+void SokolObject::resetAppliedUniforms(){
+    memset(appliedUniforms, 0, sizeof(appliedUniforms));
+}
+
+uint64_t SokolObject::getStateKey(PipelineType pipType) const{
+    sg_pipeline pipeline = pip;
+    if (pipType == PipelineType::PIP_DEPTH){
+        pipeline = depth_pip;
+    }else if (pipType == PipelineType::PIP_RTT){
+        pipeline = rtt_pip;
+    }
+
+    // slot indexes (lower bits of sokol ids): shader (pool of 32), pipeline, first fragment texture
+    uint64_t shaderKey = pipeline_desc.shader.id & 0xFF;
+    uint64_t pipelineKey = pipeline.id & 0xFFFF;
+    uint64_t textureKey = bind.fs.images[0].id & 0xFFFF;
+
+    return (shaderKey << 32) | (pipelineKey << 16) | textureKey;
+}
+
 bool SokolObject::beginDraw(PipelineType pipType){
+    sg_pipeline pipeline = pip;
     if (pipType == PipelineType::PIP_DEPTH){
-        if (depth_pip.id == SG_INVALID_ID){
-            return false;
-        }
-        //SokolCmdQueue::add_command_apply_pipeline(depth_pip);
-        sg_apply_pipeline(depth_pip);
+        pipeline = depth_pip;
     }else if (pipType == PipelineType::PIP_RTT){
-        if (rtt_pip.id == SG_INVALID_ID){
-            return false;
-        }
-        //SokolCmdQueue::add_command_apply_pipeline(rtt_pip);
-        sg_apply_pipeline(rtt_pip);
-    }else{
-        if (pip.id == SG_INVALID_ID){
-            return false;
-        }
-        //SokolCmdQueue::add_command_apply_pipeline(pip);
-        sg_apply_pipeline(pip);
+        pipeline = rtt_pip;
+    }
+
+    if (pipeline.id == SG_INVALID_ID){
+        return false;
+    }
+
+    if (pipeline.id != appliedPipeline){
+        //SokolCmdQueue::add_command_apply_pipeline(pipeline);
+        sg_apply_pipeline(pipeline);
+
+        appliedPipeline = pipeline.id;
+        hasAppliedBindings = false; // bindings must be applied after a pipeline change
+        resetAppliedUniforms(); // uniform block slots are from new shader
     }
 
     return true;
@@ -333,45 +475,53 @@ void SokolObject::applyUniformBlock(int slot, ShaderStageType stage, unsigned in
         }
         //SokolCmdQueue::add_command_apply_uniforms(sg_stage, slot, {data, count});
         sg_apply_uniforms(sg_stage, slot, {data, count});
+
+        appliedUniforms[sg_stage][slot] = nullptr;
+    }
+}
+
+void SokolObject::applySharedUniformBlock(int slot, ShaderStageType stage, unsigned int count, void* data){
+    if (slot != -1){
+        sg_shader_stage sg_stage = (stage == ShaderStageType::VERTEX) ? SG_SHADERSTAGE_VS : SG_SHADERSTAGE_FS;
+
+        // sokol keeps applied uniforms until next pipeline
+        if (appliedUniforms[sg_stage][slot] == data){
+            return;
+        }
+
+        applyUniformBlock(slot, stage, count, data);
+
+        appliedUniforms[sg_stage][slot] = data;
     }
 }
 
 void SokolObject::draw(unsigned int vertexCount, unsigned int instanceCount){
-    //SokolCmdQueue::add_command_apply_bindings(bind);
-    sg_apply_bindings(bind);
+    if (!hasAppliedBindings || memcmp(&bind, &appliedBindings, sizeof(sg_bindings)) != 0){
+        //SokolCmdQueue::add_command_apply_bindings(bind);
+        sg_apply_bindings(bind);
+
+        appliedBindings = bind;
+        hasAppliedBindings = true;
+    }
     //SokolCmdQueue::add_command_draw(0, vertexCount, 1);
     sg_draw(0, vertexCount, instanceCount);
 }
 
 void SokolObject::destroy(){
-    if (sg_isvalid()){
-        if (pip.id != SG_INVALID_ID){
-            if (Engine::isAsyncThread()){
-                SokolCmdQueue::add_command_destroy_pipeline(pip);
-            }else{
-                sg_destroy_pipeline(pip);
-            }
-        }
-        if (depth_pip.id != SG_INVALID_ID){
-            if (Engine::isAsyncThread()){
-                SokolCmdQueue::add_command_destroy_pipeline(depth_pip);
-            }else{
-                sg_destroy_pipeline(depth_pip);
-            }
-        }
-        if (rtt_pip.id != SG_INVALID_ID){
-            if (Engine::isAsyncThread()){
-                SokolCmdQueue::add_command_destroy_pipeline(rtt_pip);
-            }else{
-                sg_destroy_pipeline(rtt_pip);
-            }
-        }
+    if (pip.id != SG_INVALID_ID){
+        releasePipeline(pip);
+    }
+    if (depth_pip.id != SG_INVALID_ID){
+        releasePipeline(depth_pip);
+    }
+    if (rtt_pip.id != SG_INVALID_ID){
+        releasePipeline(rtt_pip);
     }
 
     pip.id = SG_INVALID_ID;
     depth_pip.id = SG_INVALID_ID;
     rtt_pip.id = SG_INVALID_ID;
     bind = {}; 
-    pipeline_desc = {};
+    memset(&pipeline_desc, 0, sizeof(sg_pipeline_desc));
     bindSlotIndex = 0;
-}
+}
\ No newline at end of file
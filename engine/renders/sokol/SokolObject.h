@@ -14,6 +14,9 @@
 #include "sokol_gfx.h"
 
 #include <map>
+#include <vector>
+#include <mutex>
+#include <cstdint>
 
 
 namespace Supernova{
@@ -36,6 +39,12 @@ namespace Supernova{
         }
     };
 
+    struct SokolPipelineEntry{
+        sg_pipeline_desc desc;
+        uint64_t hash;
+        unsigned int refs;
+    };
+
     class SokolObject{
 
     private:
@@ -52,6 +61,23 @@ namespace Supernova{
 
         std::map< BufferInfo, size_t > bufferToBindSlot;
 
+        // last applied state in current pass, used to skip redundant sokol calls
+        static uint32_t appliedPipeline;
+        static sg_bindings appliedBindings;
+        static bool hasAppliedBindings;
+        static const void* appliedUniforms[SG_NUM_SHADER_STAGES][SG_MAX_SHADERSTAGE_UBS];
+
+        static void resetAppliedUniforms();
+
+        // pipelines are shared by all objects with same description
+        static std::mutex pipelinesMutex;
+        static std::map<uint32_t, SokolPipelineEntry>& getPipelines();
+        static std::map<uint64_t, std::vector<uint32_t>>& getPipelineHashes();
+
+        static sg_pipeline makePipeline(const sg_pipeline_desc& desc);
+        static void releasePipeline(sg_pipeline pipeline);
+
+        size_t addVertexLayout(int slot, uint32_t bufferKey, unsigned int elements, AttributeDataType dataType, unsigned int stride, size_t offset, bool normalized, bool perInstance);
 
         sg_vertex_format getVertexFormat(unsigned int elements, AttributeDataType dataType, bool normalized);
         sg_primitive_type getPrimitiveType(PrimitiveType primitiveType);
@@ -66,14 +92,22 @@ namespace Supernova{
 
         void beginLoad(PrimitiveType primitiveType);
         void addIndex(BufferRender* buffer, AttributeDataType dataType, size_t offset);
+        void addIndexType(AttributeDataType dataType);
         void addAttribute(int slot, BufferRender* buffer, unsigned int elements, AttributeDataType dataType, unsigned int stride, size_t offset, bool normalized, bool perInstance);
+        // only vertex layout, without buffer binding (used to create pipelines before objects)
+        void addAttributeLayout(int slot, int bufferIndex, unsigned int elements, AttributeDataType dataType, unsigned int stride, size_t offset, bool normalized, bool perInstance);
         void addStorageBuffer(int slot, ShaderStageType stage, BufferRender* buffer);
         void addShader(ShaderRender* shader);
         void addTexture(std::pair<int, int> slot, ShaderStageType stage, TextureRender* texture);
         bool endLoad(uint8_t pipelines, bool enableFaceCulling, CullingMode cullingMode, WindingOrder windingOrder);
 
+        static void resetAppliedState();
+        static size_t getNumPipelines();
+        uint64_t getStateKey(PipelineType pipType) const;
+
         bool beginDraw(PipelineType pipType);
         void applyUniformBlock(int slot, ShaderStageType stage, unsigned int count, void* data);
+        void applySharedUniformBlock(int slot, ShaderStageType stage, unsigned int count, void* data);
         void draw(unsigned int vertexCount, unsigned int instanceCount);
 
         void destroy();
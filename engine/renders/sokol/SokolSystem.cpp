@@ -24,6 +24,8 @@
 
 using namespace Supernova;
 
+uint32_t SokolSystem::errorCount = 0;
+
 void sokol_log(const char* tag,                // e.g. 'sg'
                     uint32_t log_level,             // 0=panic, 1=error, 2=warn, 3=info
                     uint32_t log_item_id,           // SG_LOGITEM_*
@@ -31,6 +33,20 @@ void sokol_log(const char* tag,                // e.g. 'sg'
                     uint32_t line_nr,               // line number in sokol_gfx.h
                     const char* filename_or_null,   // source filename, may be nullptr in release mode
                     void* user_data){
+    if (log_level <= 1){
+        SokolSystem::addError();
+    }
+
+    // messages are stripped in release builds, item id is in SG_LOGITEM list of sokol_gfx.h
+    if (!message_or_null){
+        if (log_level <= 1){
+            Log::error("sokol %s: item %u at line %u\n", tag, log_item_id, line_nr);
+        }else if (log_level == 2){
+            Log::warn("sokol %s: item %u at line %u\n", tag, log_item_id, line_nr);
+        }
+        return;
+    }
+
     if (log_level == 0){
         Log::print("(PANIC): %s\n", message_or_null);
     }else if (log_level == 1){
@@ -46,7 +62,7 @@ void sokol_log(const char* tag,                // e.g. 'sg'
 void SokolSystem::setup(){
     /* setup sokol_gfx */
     sg_desc desc = {0};
-    desc.buffer_pool_size = 1024; //default: 128
+    desc.buffer_pool_size = Engine::getMaxRenderBuffers(); //default: 128
     desc.pipeline_pool_size = 2048; //default: 64
     desc.environment = System::instance().getSokolEnvironment();
     desc.logger.func = sokol_log;
@@ -56,6 +72,14 @@ void SokolSystem::setup(){
     SokolCmdQueue::start();
 }
 
+void SokolSystem::addError(){
+    errorCount++;
+}
+
+uint32_t SokolSystem::getErrorCount(){
+    return errorCount;
+}
+
 void SokolSystem::commitQueue(){
     SokolCmdQueue::commit_commands();
 }
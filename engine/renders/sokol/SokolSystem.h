@@ -10,6 +10,10 @@
 namespace Supernova{
     class SokolSystem{
 
+    private:
+        // errors and panics reported by sokol logger
+        static uint32_t errorCount;
+
     public:
         static void setup();
         static void commitQueue();
@@ -19,6 +23,9 @@ namespace Supernova{
 
         static void scheduleCleanup(void (*cleanupFunc)(void* cleanupData), void* cleanupData, int32_t numFramesToDefer = 0);
         static void addQueueCommand(void (*custom_cb)(void* custom_data), void* custom_data);
+
+        static void addError();
+        static uint32_t getErrorCount();
     };
 }
 
@@ -8,6 +8,9 @@
 #include "SokolCmdQueue.h"
 #include "render/SystemRender.h"
 #include "Engine.h"
+#include "texture/TextureData.h"
+
+#include <algorithm>
 
 using namespace Supernova;
 
@@ -201,18 +204,39 @@ sg_image SokolTexture::generateMipmaps(const sg_image_desc* desc_){
     return img;
 }
 
+sg_pixel_format SokolTexture::getPixelFormat(ColorFormat colorFormat){
+    switch (colorFormat){
+        case ColorFormat::RED: return SG_PIXELFORMAT_R8;
+        case ColorFormat::RGBA: return SG_PIXELFORMAT_RGBA8;
+        case ColorFormat::BC1_RGBA: return SG_PIXELFORMAT_BC1_RGBA;
+        case ColorFormat::BC3_RGBA: return SG_PIXELFORMAT_BC3_RGBA;
+        case ColorFormat::BC4_R: return SG_PIXELFORMAT_BC4_R;
+        case ColorFormat::BC5_RG: return SG_PIXELFORMAT_BC5_RG;
+        case ColorFormat::BC7_RGBA: return SG_PIXELFORMAT_BC7_RGBA;
+        case ColorFormat::ETC2_RGB8: return SG_PIXELFORMAT_ETC2_RGB8;
+        case ColorFormat::ETC2_RGBA8: return SG_PIXELFORMAT_ETC2_RGBA8;
+        case ColorFormat::EAC_R11: return SG_PIXELFORMAT_EAC_R11;
+        case ColorFormat::EAC_RG11: return SG_PIXELFORMAT_EAC_RG11;
+        case ColorFormat::ASTC_4x4_RGBA: return SG_PIXELFORMAT_ASTC_4x4_RGBA;
+    }
+
+    return _SG_PIXELFORMAT_DEFAULT;
+}
+
+bool SokolTexture::isFormatSupported(ColorFormat colorFormat){
+    return sg_query_pixelformat(getPixelFormat(colorFormat)).sample;
+}
+
 bool SokolTexture::createTexture(
             std::string label, int width, int height, 
             ColorFormat colorFormat, TextureType type, int numFaces, void* data[6], size_t size[6], 
-            TextureFilter minFilter, TextureFilter magFilter, TextureWrap wrapU, TextureWrap wrapV){
+            TextureFilter minFilter, TextureFilter magFilter, TextureWrap wrapU, TextureWrap wrapV, int mipLevels){
 
-    sg_pixel_format pixelFormat;
-    if (colorFormat == ColorFormat::RGBA){
-        pixelFormat = SG_PIXELFORMAT_RGBA8;
-    }else if (colorFormat == ColorFormat::RED){
-        pixelFormat = SG_PIXELFORMAT_R8;
-    }else{
-        Log::error("Renders only support 8bpp and 32bpp textures");
+    sg_pixel_format pixelFormat = getPixelFormat(colorFormat);
+
+    if (TextureData::isCompressedFormat(colorFormat) && !isFormatSupported(colorFormat)){
+        Log::error("Compressed format of texture '%s' is not supported by graphic backend", label.c_str());
+        return false;
     }
 
     sg_image_desc image_desc = {0};
@@ -230,12 +254,38 @@ bool SokolTexture::createTexture(
     sampler_desc.wrap_u = getWrap(wrapU);
     sampler_desc.wrap_v = getWrap(wrapV);
 
-    for (int f = 0; f < numFaces; f++){
-        image_desc.data.subimage[f][0].ptr = data[f];
-        image_desc.data.subimage[f][0].size = size[f];
+    if (mipLevels > 1){
+        // levels from file are used even if filter was not set to mipmap
+        if (sampler_desc.mipmap_filter == _SG_FILTER_DEFAULT){
+            sampler_desc.mipmap_filter = SG_FILTER_LINEAR;
+        }
+
+        // levels are stored one after another in data
+        image_desc.num_mipmaps = std::min(mipLevels, (int)SG_MAX_MIPMAPS);
+        for (int f = 0; f < numFaces; f++){
+            size_t offset = 0;
+            for (int l = 0; l < image_desc.num_mipmaps; l++){
+                size_t levelSize = TextureData::getLevelSize(colorFormat, std::max(width >> l, 1), std::max(height >> l, 1));
+                image_desc.data.subimage[f][l].ptr = (unsigned char*)data[f] + offset;
+                image_desc.data.subimage[f][l].size = levelSize;
+                offset += levelSize;
+            }
+        }
+    }else{
+        for (int f = 0; f < numFaces; f++){
+            image_desc.data.subimage[f][0].ptr = data[f];
+            image_desc.data.subimage[f][0].size = size[f];
+        }
+    }
+
+    bool needMipmaps = (sampler_desc.mipmap_filter == SG_FILTER_LINEAR || sampler_desc.mipmap_filter == SG_FILTER_NEAREST);
+
+    // compressed blocks cannot be filtered in CPU, only levels from file are used
+    if (needMipmaps && mipLevels <= 1 && TextureData::isCompressedFormat(colorFormat)){
+        Log::warn("Mipmaps cannot be generated for compressed texture '%s', store them in file", label.c_str());
     }
 
-    if (sampler_desc.mipmap_filter == SG_FILTER_LINEAR || sampler_desc.mipmap_filter == SG_FILTER_NEAREST){
+    if (needMipmaps && mipLevels <= 1 && !TextureData::isCompressedFormat(colorFormat)){
         image = generateMipmaps(&image_desc);
     }else{
         if (Engine::isAsyncThread()){
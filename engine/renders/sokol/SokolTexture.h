@@ -19,6 +19,7 @@ namespace Supernova{
         sg_sampler sampler;
 
         sg_image_type getTextureType(TextureType textureType);
+        static sg_pixel_format getPixelFormat(ColorFormat colorFormat);
         sg_filter getFilter(TextureFilter textureFilter);
         sg_filter getFilterMipmap(TextureFilter textureFilter);
         sg_wrap getWrap(TextureWrap textureWrap);
@@ -35,7 +36,7 @@ namespace Supernova{
         bool createTexture(
                     std::string label, int width, int height, 
                     ColorFormat colorFormat, TextureType type, int numFaces, void* data[6], size_t size[6], 
-                    TextureFilter minFilter, TextureFilter magFilter, TextureWrap wrapU, TextureWrap wrapV);
+                    TextureFilter minFilter, TextureFilter magFilter, TextureWrap wrapU, TextureWrap wrapV, int mipLevels = 1);
 
         bool createFramebufferTexture(
                     TextureType type, bool depth, bool shadowMap, int width, int height, 
@@ -43,6 +44,8 @@ namespace Supernova{
 
         void destroyTexture();
 
+        static bool isFormatSupported(ColorFormat colorFormat);
+
         sg_image get();
         sg_sampler getSampler();
     };
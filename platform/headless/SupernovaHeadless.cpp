@@ -0,0 +1,93 @@
+//
+// (c) 2024 Eduardo Doria.
+//
+
+#include "SupernovaHeadless.h"
+
+#include "Engine.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#define DEFAULT_HEADLESS_FRAMES 600
+
+int SupernovaHeadless::screenWidth = DEFAULT_WINDOW_WIDTH;
+int SupernovaHeadless::screenHeight = DEFAULT_WINDOW_HEIGHT;
+
+
+SupernovaHeadless::SupernovaHeadless(){
+
+}
+
+int SupernovaHeadless::init(int argc, char **argv){
+    int frames = DEFAULT_HEADLESS_FRAMES;
+
+    for (int i = 1; i < argc - 1; i++){
+        if (strcmp(argv[i], "--frames") == 0){
+            frames = atoi(argv[i+1]);
+        }
+    }
+
+    Supernova::Engine::systemInit(argc, argv);
+
+    Supernova::Engine::systemViewLoaded();
+    Supernova::Engine::systemViewChanged();
+
+    // fixed timestep, same result on every run
+    double frameTime = 1.0 / 60.0;
+    for (int i = 0; i < frames; i++){
+        Supernova::Engine::systemDraw(frameTime);
+    }
+
+    Supernova::Engine::systemViewDestroyed();
+    Supernova::Engine::systemShutdown();
+
+    return 0;
+}
+
+void SupernovaHeadless::setScreenSize(int width, int height){
+    screenWidth = width;
+    screenHeight = height;
+}
+
+int SupernovaHeadless::getScreenWidth(){
+    return screenWidth;
+}
+
+int SupernovaHeadless::getScreenHeight(){
+    return screenHeight;
+}
+
+std::string SupernovaHeadless::getAssetPath(){
+    return "assets";
+}
+
+std::string SupernovaHeadless::getUserDataPath(){
+    return ".";
+}
+
+std::string SupernovaHeadless::getLuaPath(){
+    return "lua";
+}
+
+void SupernovaHeadless::platformLog(const int type, const char *fmt, va_list args){
+    // stdout is kept for program output (ex: benchmark results)
+    const char* priority = NULL;
+
+    if (type == S_LOG_VERBOSE){
+        priority = "VERBOSE";
+    }else if (type == S_LOG_DEBUG){
+        priority = "DEBUG";
+    }else if (type == S_LOG_WARN){
+        priority = "WARN";
+    }else if (type == S_LOG_ERROR){
+        priority = "ERROR";
+    }
+
+    if (priority)
+        fprintf(stderr, "(%s): ", priority);
+
+    vfprintf(stderr, fmt, args);
+    fprintf(stderr, "\n");
+}
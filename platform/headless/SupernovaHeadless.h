@@ -0,0 +1,38 @@
+//
+// (c) 2024 Eduardo Doria.
+//
+
+#ifndef SupernovaHeadless_h
+#define SupernovaHeadless_h
+
+#include "System.h"
+
+// Platform without window and GPU, used with sokol dummy backend (ex: CI and benchmarks)
+class SupernovaHeadless: public Supernova::System{
+
+private:
+
+    static int screenWidth;
+    static int screenHeight;
+
+public:
+
+    SupernovaHeadless();
+
+    static int init(int argc, char **argv);
+
+    static void setScreenSize(int width, int height);
+
+    virtual int getScreenWidth();
+    virtual int getScreenHeight();
+
+    virtual std::string getAssetPath();
+    virtual std::string getUserDataPath();
+    virtual std::string getLuaPath();
+
+    virtual void platformLog(const int type, const char *fmt, va_list args);
+    
+};
+
+
+#endif /* SupernovaHeadless_h */
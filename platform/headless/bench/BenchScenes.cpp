@@ -0,0 +1,251 @@
+//
+// (c) 2024 Eduardo Doria.
+//
+
+#include "BenchScenes.h"
+
+#include "Supernova.h"
+#include "Camera.h"
+#include "Light.h"
+#include "Points.h"
+#include "Shape.h"
+#include "Sprite.h"
+#include "Container.h"
+#include "Image.h"
+#include "Text.h"
+
+#include <vector>
+#include <memory>
+#include <cstring>
+
+using namespace Supernova;
+
+#define BENCH_SPRITES 10000
+#define BENCH_PBR_MESHES 5000
+#define BENCH_PHYSICS_BODIES 2000
+#define BENCH_PARTICLES 50000
+#define BENCH_UI_BRANCHES 8
+#define BENCH_UI_DEPTH 32
+// vertex and index buffers of every sprite and shape, default pool has only 1024
+#define BENCH_RENDER_BUFFERS 32768
+
+struct BenchSceneEntry{
+    const char* name;
+    void (*create)();
+};
+
+static Scene scene;
+static Camera camera(&scene);
+static std::vector<std::unique_ptr<EntityHandle>> objects;
+
+static const char* sceneName = "";
+static bool sceneLoaded = false;
+static uint64_t frame = 0;
+
+// deterministic pseudo random numbers, independent of standard library implementation
+static uint32_t randomState = 12345;
+
+static float randomFloat(float min, float max){
+    randomState = randomState * 1664525u + 1013904223u;
+    return min + (max - min) * ((randomState >> 8) / 16777216.0f);
+}
+
+template<typename T>
+static T* createObject(){
+    T* object = new T(&scene);
+    objects.push_back(std::unique_ptr<EntityHandle>(object));
+    return object;
+}
+
+static void createSprites(){
+    camera.setType(CameraType::CAMERA_2D);
+
+    std::vector<Sprite*> sprites;
+    for (int i = 0; i < BENCH_SPRITES; i++){
+        Sprite* sprite = createObject<Sprite>();
+        sprite->setSize(16, 16);
+        sprite->setPosition(randomFloat(0, 1000), randomFloat(0, 480));
+        sprite->setColor(randomFloat(0, 1), randomFloat(0, 1), randomFloat(0, 1));
+        sprites.push_back(sprite);
+    }
+
+    Engine::onUpdate.add("benchSprites", std::function<void()>([sprites](){
+        float angle = (float)(frame % 360);
+        for (size_t i = 0; i < sprites.size(); i++){
+            sprites[i]->setRotation(0, 0, angle + i);
+        }
+    }));
+}
+
+static void createPBRMeshes(){
+    camera.setType(CameraType::CAMERA_PERSPECTIVE);
+    camera.setPosition(0, 60, 160);
+    camera.setView(0, 0, 0);
+
+    Light* sun = createObject<Light>();
+    sun->setType(LightType::DIRECTIONAL);
+    sun->setDirection(-0.5, -1.0, -0.3);
+    sun->setShadows(true);
+
+    for (int i = 0; i < 4; i++){
+        Light* light = createObject<Light>();
+        light->setType(LightType::POINT);
+        light->setPosition(randomFloat(-80, 80), 10, randomFloat(-80, 80));
+        light->setColor(randomFloat(0.5, 1), randomFloat(0.5, 1), randomFloat(0.5, 1));
+        light->setRange(60);
+        light->setIntensity(4);
+    }
+
+    for (int i = 0; i < BENCH_PBR_MESHES; i++){
+        Shape* shape = createObject<Shape>();
+        if (i % 2 == 0){
+            shape->createSphere(1.0);
+        }else{
+            shape->createBox(2.0, 2.0, 2.0);
+        }
+        shape->setPosition(randomFloat(-100, 100), randomFloat(0, 20), randomFloat(-100, 100));
+        shape->setColor(randomFloat(0, 1), randomFloat(0, 1), randomFloat(0, 1));
+        shape->getMaterial().metallicFactor = randomFloat(0, 1);
+        shape->getMaterial().roughnessFactor = randomFloat(0, 1);
+    }
+
+    Engine::onUpdate.add("benchPBRMeshes", std::function<void()>([](){
+        camera.rotatePosition(0.2);
+    }));
+}
+
+static void createPhysicsBodies(){
+    camera.setType(CameraType::CAMERA_2D);
+
+    Sprite* ground = createObject<Sprite>();
+    ground->setSize(1000, 20);
+    ground->setPosition(0, 0);
+    Body2D groundBody = ground->getBody2D();
+    groundBody.createBoxShape(1000, 20);
+    groundBody.setType(BodyType::STATIC);
+
+    int columns = 50;
+    for (int i = 0; i < BENCH_PHYSICS_BODIES; i++){
+        Sprite* box = createObject<Sprite>();
+        box->setSize(10, 10);
+        box->setPosition(100 + (i % columns) * 16 + randomFloat(0, 4), 40 + (i / columns) * 14);
+        Body2D body = box->getBody2D();
+        body.createBoxShape(10, 10);
+        body.setType(BodyType::DYNAMIC);
+    }
+}
+
+static void createParticles(){
+    camera.setType(CameraType::CAMERA_2D);
+
+    Points* points = createObject<Points>();
+    points->setMaxPoints(BENCH_PARTICLES);
+
+    Particles* particles = createObject<Particles>();
+    particles->setTarget(points);
+    particles->setMaxParticles(BENCH_PARTICLES);
+    particles->setRate(BENCH_PARTICLES / 2);
+    particles->setMaxPerUpdate(BENCH_PARTICLES / 60);
+    particles->setLifeInitializer(2.0);
+    particles->setPositionInitializer(Vector3(400, 200, 0), Vector3(600, 280, 0));
+    particles->setVelocityInitializer(Vector3(-50, -50, 0), Vector3(50, 50, 0));
+    particles->setColorInitializer(Vector3(0.2, 0.2, 0.2), Vector3(1, 1, 1));
+    particles->setSizeInitializer(2, 8);
+    particles->setAlphaModifier(1.0, 2.0, 1.0, 0.0);
+    particles->start();
+}
+
+static void createUITree(){
+    camera.setType(CameraType::CAMERA_2D);
+
+    Container* root = createObject<Container>();
+    root->setType(ContainerType::HORIZONTAL);
+    root->setSize(1000, 480);
+
+    for (int b = 0; b < BENCH_UI_BRANCHES; b++){
+        Object* parent = root;
+        for (int d = 0; d < BENCH_UI_DEPTH; d++){
+            Container* container = createObject<Container>();
+            container->setType((d % 2 == 0) ? ContainerType::VERTICAL : ContainerType::HORIZONTAL);
+            parent->addChild(container);
+
+            Image* image = createObject<Image>();
+            image->setSize(8, 8);
+            image->setColor(randomFloat(0, 1), randomFloat(0, 1), randomFloat(0, 1), 1.0);
+            container->addChild(image);
+
+            Text* text = createObject<Text>();
+            text->setText("Item " + std::to_string(b) + "." + std::to_string(d));
+            text->setFontSize(10);
+            container->addChild(text);
+
+            parent = container;
+        }
+    }
+
+    // size change relayouts the whole tree every frame
+    Engine::onUpdate.add("benchUITree", std::function<void()>([root](){
+        root->setSize(1000 - (int)(frame % 2), 480);
+    }));
+}
+
+static const BenchSceneEntry benchScenes[] = {
+    {"sprites", createSprites},
+    {"pbr", createPBRMeshes},
+    {"physics", createPhysicsBodies},
+    {"particles", createParticles},
+    {"ui", createUITree}
+};
+
+const char* getBenchSceneName(){
+    return sceneName;
+}
+
+bool isBenchSceneLoaded(){
+    return sceneLoaded;
+}
+
+std::string getBenchSceneList(){
+    std::string list;
+    for (const auto& entry : benchScenes){
+        if (!list.empty())
+            list += ", ";
+        list += entry.name;
+    }
+    return list;
+}
+
+void init(){
+    const std::vector<std::string>& args = System::instance().args;
+
+    Engine::setMaxRenderBuffers(BENCH_RENDER_BUFFERS);
+
+    std::string name = "sprites";
+    for (size_t i = 1; i + 1 < args.size(); i++){
+        if (args[i] == "--scene"){
+            name = args[i+1];
+        }
+    }
+
+    for (const auto& entry : benchScenes){
+        if (name == entry.name){
+            sceneName = entry.name;
+            sceneLoaded = true;
+            entry.create();
+        }
+    }
+
+    if (!sceneLoaded){
+        Log::error("Unknown benchmark scene '%s', use one of: %s", name.c_str(), getBenchSceneList().c_str());
+        return;
+    }
+
+    Engine::onPostUpdate.add("benchFrame", std::function<void()>([](){
+        frame++;
+    }));
+
+    scene.setCamera(&camera);
+
+    Engine::setCanvasSize(1000, 480);
+    Engine::setScene(&scene);
+}
@@ -0,0 +1,17 @@
+//
+// (c) 2024 Eduardo Doria.
+//
+
+#ifndef BenchScenes_h
+#define BenchScenes_h
+
+#include <string>
+
+// Stress scenes of supernova-bench. One of them is created by init() using "--scene <name>" argument.
+// All content is generated from fixed seeds, so every run draws the same frames.
+
+const char* getBenchSceneName();
+bool isBenchSceneLoaded();
+std::string getBenchSceneList();
+
+#endif /* BenchScenes_h */
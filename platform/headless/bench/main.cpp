@@ -0,0 +1,256 @@
+//
+// (c) 2024 Eduardo Doria.
+//
+
+// supernova-bench: runs a stress scene for a fixed number of frames with a fixed timestep
+// on the headless platform and prints per frame averages as JSON to stdout.
+//
+// Usage: supernova-bench [--scene name] [--frames N] [--warmup N] [--auto-instancing] [--trace file.json]
+//
+//   --scene name         stress scene: sprites (default), pbr, physics, particles or ui
+//   --frames N           timed frames (default: 300)
+//   --warmup N           frames drawn before timing (default: 120)
+//   --auto-instancing    enables Engine automatic instancing
+//   --trace file.json    saves a Chrome trace of timed frames
+
+#include "Engine.h"
+#include "Scene.h"
+#include "BenchScenes.h"
+
+#include "util/Profiler.h"
+#include "sokol/SokolCmdQueue.h"
+#include "sokol/SokolSystem.h"
+#include "sokol_gfx.h"
+#include "sokol_time.h"
+
+#include <atomic>
+#include <new>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#ifdef __GNUC__
+#include <cxxabi.h>
+#endif
+
+using namespace Supernova;
+
+#define DEFAULT_BENCH_FRAMES 300
+#define DEFAULT_BENCH_WARMUP 120
+
+// global operator new is replaced in this executable to count every allocation of engine and libs
+static std::atomic<uint64_t> allocCount(0);
+static std::atomic<uint64_t> allocBytes(0);
+
+void* operator new(std::size_t size){
+    allocCount.fetch_add(1, std::memory_order_relaxed);
+    allocBytes.fetch_add(size, std::memory_order_relaxed);
+
+    if (void* ptr = std::malloc(size ? size : 1))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept{
+    std::free(ptr);
+}
+
+struct SystemTimes{
+    double update = 0;
+    double draw = 0;
+};
+
+struct Stat{
+    double total = 0;
+    double max = 0;
+
+    void add(double value){
+        total += value;
+        max = std::max(max, value);
+    }
+};
+
+static std::string getSystemName(const char* typeName){
+    std::string name = typeName;
+#ifdef __GNUC__
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(typeName, nullptr, nullptr, &status);
+    if (status == 0 && demangled){
+        name = demangled;
+        std::free(demangled);
+    }
+#endif
+    size_t pos = name.rfind("::");
+    if (pos != std::string::npos)
+        name = name.substr(pos + 2);
+    return name;
+}
+
+static void printUsage(){
+    fprintf(stderr, "Usage: supernova-bench [--scene name] [--frames N] [--warmup N] [--auto-instancing] [--trace file.json]\n");
+    fprintf(stderr, "Scenes: %s\n", getBenchSceneList().c_str());
+}
+
+static void printStat(const char* name, const Stat& stat, int frames, bool last = false){
+    printf("    \"%s\": {\"mean\": %.4f, \"max\": %.4f}%s\n", name, stat.total / frames, stat.max, last ? "" : ",");
+}
+
+int main(int argc, char* argv[]){
+    int frames = DEFAULT_BENCH_FRAMES;
+    int warmup = DEFAULT_BENCH_WARMUP;
+    std::string traceFile;
+
+    for (int i = 1; i < argc; i++){
+        if (strcmp(argv[i], "--scene") == 0 && i + 1 < argc){
+            i++; // read by init() of BenchScenes.cpp
+        }else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc){
+            frames = std::max(1, atoi(argv[++i]));
+        }else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc){
+            warmup = std::max(0, atoi(argv[++i]));
+        }else if (strcmp(argv[i], "--auto-instancing") == 0){
+            Engine::setAutomaticInstancing(true);
+        }else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc){
+            traceFile = argv[++i];
+        }else{
+            fprintf(stderr, "supernova-bench: unknown or incomplete argument '%s'\n", argv[i]);
+            printUsage();
+            return 1;
+        }
+    }
+
+    stm_setup();
+
+    uint64_t startAllocCount = allocCount;
+    uint64_t startTime = stm_now();
+
+    // init() of BenchScenes.cpp creates the scene
+    Engine::systemInit(argc, argv);
+
+    if (!isBenchSceneLoaded()){
+        Engine::systemShutdown();
+        return 1;
+    }
+
+    Engine::systemViewLoaded();
+    Engine::systemViewChanged();
+
+    sg_enable_frame_stats();
+
+    const double frameTime = 1.0 / 60.0;
+
+    for (int i = 0; i < warmup; i++){
+        Engine::systemDraw(frameTime);
+    }
+
+    double loadTime = stm_ms(stm_since(startTime));
+    uint64_t loadAllocs = allocCount - startAllocCount;
+
+    Scene* scene = Engine::getScene();
+    for (auto const& pair : scene->getSystems()){
+        pair.second->resetTimes();
+    }
+
+    Stat frameStat;
+    Stat allocCountStat, allocBytesStat;
+    Stat queueCommandsStat, queueBytesStat;
+    Stat passesStat, pipelinesStat, bindingsStat, uniformsStat, drawCallsStat, bufferUpdatesStat, uniformBytesStat, bufferBytesStat;
+    std::vector<SystemTimes> systemTimes(scene->getSystems().size());
+
+    // timed frames are captured to a Chrome trace file
+    if (!traceFile.empty()){
+        Profiler::setEnabled(true);
+        Profiler::startCapture();
+    }
+
+    for (int i = 0; i < frames; i++){
+        uint64_t frameAllocCount = allocCount;
+        uint64_t frameAllocBytes = allocBytes;
+
+        uint64_t frameStart = stm_now();
+        Engine::systemDraw(frameTime);
+        frameStat.add(stm_ms(stm_since(frameStart)));
+
+        allocCountStat.add((double)(allocCount - frameAllocCount));
+        allocBytesStat.add((double)(allocBytes - frameAllocBytes));
+
+        queueCommandsStat.add((double)SokolCmdQueue::get_executed_commands());
+        queueBytesStat.add((double)SokolCmdQueue::get_executed_bytes());
+
+        // stats of frame finished by last sg_commit
+        sg_frame_stats stats = sg_query_frame_stats();
+        passesStat.add(stats.num_passes);
+        pipelinesStat.add(stats.num_apply_pipeline);
+        bindingsStat.add(stats.num_apply_bindings);
+        uniformsStat.add(stats.num_apply_uniforms);
+        drawCallsStat.add(stats.num_draw);
+        bufferUpdatesStat.add(stats.num_update_buffer + stats.num_append_buffer);
+        uniformBytesStat.add(stats.size_apply_uniforms);
+        bufferBytesStat.add(stats.size_update_buffer + stats.size_append_buffer);
+
+        const auto& systems = scene->getSystems();
+        for (size_t s = 0; s < systems.size(); s++){
+            systemTimes[s].update += systems[s].second->getUpdateTime() * 1000.0;
+            systemTimes[s].draw += systems[s].second->getDrawTime() * 1000.0;
+            systems[s].second->resetTimes();
+        }
+    }
+
+    printf("{\n");
+    printf("  \"scene\": \"%s\",\n", getBenchSceneName());
+    printf("  \"frames\": %d,\n", frames);
+    printf("  \"warmup\": %d,\n", warmup);
+    printf("  \"fixed_timestep\": %.6f,\n", frameTime);
+    printf("  \"load_ms\": %.3f,\n", loadTime);
+    printf("  \"load_allocations\": %llu,\n", (unsigned long long)loadAllocs);
+    printf("  \"frame_ms\": {\"mean\": %.4f, \"max\": %.4f},\n", frameStat.total / frames, frameStat.max);
+    printf("  \"systems_ms\": {\n");
+    const auto& systems = scene->getSystems();
+    for (size_t s = 0; s < systems.size(); s++){
+        printf("    \"%s\": {\"update\": %.4f, \"draw\": %.4f}%s\n", getSystemName(systems[s].first).c_str(),
+            systemTimes[s].update / frames, systemTimes[s].draw / frames, (s + 1 < systems.size()) ? "," : "");
+    }
+    printf("  },\n");
+    printf("  \"allocations\": {\n");
+    printStat("count", allocCountStat, frames);
+    printStat("bytes", allocBytesStat, frames, true);
+    printf("  },\n");
+    printf("  \"command_queue\": {\n");
+    printStat("commands", queueCommandsStat, frames);
+    printStat("bytes", queueBytesStat, frames, true);
+    printf("  },\n");
+    printf("  \"render\": {\n");
+    printStat("passes", passesStat, frames);
+    printStat("apply_pipeline", pipelinesStat, frames);
+    printStat("apply_bindings", bindingsStat, frames);
+    printStat("apply_uniforms", uniformsStat, frames);
+    printStat("draw", drawCallsStat, frames);
+    printStat("buffer_updates", bufferUpdatesStat, frames);
+    printStat("uniform_bytes", uniformBytesStat, frames);
+    printStat("buffer_bytes", bufferBytesStat, frames, true);
+    printf("  }\n");
+    printf("}\n");
+
+    if (!traceFile.empty()){
+        Profiler::stopCapture();
+        Profiler::saveCapture(traceFile);
+    }
+
+    Engine::systemViewDestroyed();
+    Engine::systemShutdown();
+
+    // results are not valid if any render object failed (ex: exhausted sokol pool)
+    if (SokolSystem::getErrorCount() > 0){
+        fprintf(stderr, "supernova-bench: %u sokol errors\n", SokolSystem::getErrorCount());
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,9 @@
+//
+// (c) 2024 Eduardo Doria.
+//
+
+#include "SupernovaHeadless.h"
+
+int main(int argc, char* argv[]) {
+    return SupernovaHeadless::init(argc, argv);
+}
@@ -1,6 +1,27 @@
 #version 450
 
 out vec4 frag_color;
+
+#ifdef HAS_DEPTH_COPY
+
+uniform texture2D u_depthTexture;
+uniform sampler u_depth_smp;
+
+#include "includes/depth_util.glsl"
+
+void main() {
+    vec4 color = texelFetch(sampler2D(u_depthTexture, u_depth_smp), ivec2(gl_FragCoord.xy), 0);
+
+    // depth attachment is restored too, then casters drawn after are tested against cached ones
+    // encoded value is already window depth in all backends
+    float depth = min(decodeDepth(color), 1.0);
+
+    frag_color = color;
+    gl_FragDepth = depth;
+}
+
+#else
+
 in vec2 v_projZW;
 
 #if defined(HAS_TEXTURE)
@@ -26,4 +47,6 @@ void main() {
 
     // Higher precision equivalent of gl_FragCoord.z in some platforms. See Three.js depth_frag.glsl.js
 	frag_color = encodeDepth(0.5 * v_projZW[0] / v_projZW[1] + 0.5);
-}
\ No newline at end of file
+}
+
+#endif
\ No newline at end of file
@@ -2,6 +2,16 @@
 
 #define DEPTH_SHADER
 
+#ifdef HAS_DEPTH_COPY
+
+// Fullscreen triangle without vertex buffers, copies cached shadow map to current one
+void main() {
+    vec2 pos = vec2((gl_VertexIndex << 1) & 2, gl_VertexIndex & 2);
+    gl_Position = vec4(pos * 2.0 - 1.0, 0.0, 1.0);
+}
+
+#else
+
 uniform u_vs_depthParams {
     mat4 modelMatrix;
     mat4 lightVPMatrix;
@@ -62,4 +72,6 @@ void main() {
     #ifndef IS_GLSL
         gl_Position.y = -gl_Position.y;
     #endif
-}
\ No newline at end of file
+}
+
+#endif
\ No newline at end of file
@@ -136,14 +136,22 @@ void main() {
     #endif
 
     #ifdef HAS_NORMALS
+        vec3 normal = getNormal(boneTransform, pos);
+        #ifdef HAS_INSTANCING
+            // uniform scaled instances
+            normal = mat3(instanceMatrix) * normal;
+        #endif
     #ifdef HAS_TANGENTS
         vec3 tangent = getTangent(boneTransform);
-        vec3 normalW = normalize(vec3(pbrParams.normalMatrix * vec4(getNormal(boneTransform, pos), 0.0)));
+        #ifdef HAS_INSTANCING
+            tangent = mat3(instanceMatrix) * tangent;
+        #endif
+        vec3 normalW = normalize(vec3(pbrParams.normalMatrix * vec4(normal, 0.0)));
         vec3 tangentW = normalize(vec3(pbrParams.modelMatrix * vec4(tangent, 0.0)));
         vec3 bitangentW = cross(normalW, tangentW) * a_tangent.w;
         v_tbn = mat3(tangentW, bitangentW, normalW);
     #else // !HAS_TANGENTS
-        v_normal = normalize(vec3(pbrParams.normalMatrix * vec4(getNormal(boneTransform, pos), 0.0)));
+        v_normal = normalize(vec3(pbrParams.normalMatrix * vec4(normal, 0.0)));
     #endif
     #endif
 
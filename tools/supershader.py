@@ -10,7 +10,7 @@ import subprocess
 import click
 import platform
 import glob
-import base64
+import struct
 
 def get_define(property):
     if property == 'Ult':
@@ -55,6 +55,8 @@ def get_define(property):
         return 'HAS_TERRAIN'
     elif property == 'Ist':
         return 'HAS_INSTANCING'
+    elif property == 'Dcp':
+        return 'HAS_DEPTH_COPY'
     else:
         sys.exit('Not found value for property: '+property)
 
@@ -92,6 +94,7 @@ def get_default_shaders():
     s += "mesh_Uv1PucNorVc4;"
     s += "mesh_Uv1PucNorVc4Fog;"
     s += "mesh_Uv1PucNor;"
+    s += "mesh_Uv1PucNorIst;"
     s += "mesh_Uv1PucNorFog;"
     s += "mesh_Uv1PucNorVc4Txr;"
     s += "mesh_Uv1PucNorVc4TxrIst;"
@@ -103,6 +106,7 @@ def get_default_shaders():
     s += "mesh_Uv1PucShwPcfNorVc4FogIst;"
     s += "mesh_Uv1PucShwPcfNorVc4TxrIst;"
     s += "mesh_Uv1PucShwPcfNor;"
+    s += "mesh_Uv1PucShwPcfNorIst;"
     s += "mesh_Uv1PucShwPcfNorSki;"
     s += "mesh_Uv1PucShwPcfNorSkiIst;"
     s += "mesh_Uv1PucShwPcfNorFog;"
@@ -151,6 +155,7 @@ def get_default_shaders():
     s += "depth_MtaMnrIst;"
     s += "depth_MtaMnrMtgIst;"
     s += "depth_Ter;"
+    s += "depth_Dcp;"
     s += "sky;"
     s += "ui_Vc4;"
     s += "ui_TexVc4;"
@@ -188,83 +193,117 @@ def get_bin_exec():
     
     return outpath
 
+# same values of ShaderType and ShaderProperty in engine/core/render/Render.h
+SHADER_TYPES = {'points': 0, 'lines': 1, 'mesh': 2, 'sky': 3, 'depth': 4, 'ui': 5}
+SHADER_PROPERTIES = ['Ult', 'Tex', 'Ftx', 'Uv1', 'Uv2', 'Puc', 'Shw', 'Pcf', 'Nor', 'Nmp', 'Tan',
+                     'Vc3', 'Vc4', 'Txr', 'Fog', 'Ski', 'Mta', 'Mnr', 'Mtg', 'Ter', 'Ist', 'Dcp']
+
+ARCHIVE_MAGIC = b'SNSA'
+ARCHIVE_VERSION = 1
+ARCHIVE_HEADER_SIZE = 16
+ARCHIVE_SLOT_SIZE = 16
+
+def get_shader_key(shader):
+    splitShader = shader.split('_')
+    if splitShader[0] not in SHADER_TYPES:
+        sys.exit('Not found shader type: '+splitShader[0])
+    key = SHADER_TYPES[splitShader[0]] << 32
+
+    properties = ''
+    if len(splitShader) >= 2:
+        properties = splitShader[1]
+    while properties != '':
+        if properties[:3] not in SHADER_PROPERTIES:
+            sys.exit('Not found value for property: '+properties[:3])
+        key |= 1 << SHADER_PROPERTIES.index(properties[:3])
+        properties = properties[3:]
+
+    return key
+
+# same hash of engine/core/shader/ShaderArchive.cpp
+def get_archive_slot(key, table_size):
+    return (((key * 0x9E3779B97F4A7C15) & 0xFFFFFFFFFFFFFFFF) >> 32) & (table_size - 1)
+
+def create_archive(shaders):
+    table_size = 1
+    while table_size < len(shaders) * 2:
+        table_size *= 2
+
+    slots = [None] * table_size
+    data = bytearray()
+    offset = ARCHIVE_HEADER_SIZE + table_size * ARCHIVE_SLOT_SIZE
+
+    for shader in sorted(shaders):
+        key = get_shader_key(shader)
+        sbs = shaders[shader]
+
+        slot = get_archive_slot(key, table_size)
+        while slots[slot] is not None:
+            if slots[slot][0] == key:
+                sys.exit('Duplicated shader in archive: '+shader)
+            slot = (slot + 1) & (table_size - 1)
+        slots[slot] = (key, offset + len(data), len(sbs))
+
+        data += sbs
+        while len(data) % 8 != 0:
+            data += b'\0'
+
+    archive = bytearray(ARCHIVE_MAGIC)
+    archive += struct.pack('<III', ARCHIVE_VERSION, len(shaders), table_size)
+    for slot in slots:
+        if slot is None:
+            archive += struct.pack('<QII', 0, 0, 0)
+        else:
+            archive += struct.pack('<QII', *slot)
+    archive += data
+
+    return archive
+
+def write_archive_header(engine_root, lang, shaders):
+    headerpath = os.path.join(get_header_output(engine_root), lang+".h")
+
+    print("Creating:", headerpath);
+
+    archive = create_archive(shaders)
+
+    headerfile = open(headerpath, "w")
+    headerfile.write("#ifndef SHADER_"+lang+"_h")
+    headerfile.write("\n")
+    headerfile.write("#define SHADER_"+lang+"_h")
+    headerfile.write("\n\n")
+    headerfile.write("// Generated by tools/supershader.py, packed SBS shaders read by ShaderArchive")
+    headerfile.write("\n\n")
+    headerfile.write("alignas(8) static constexpr unsigned char shaders_"+lang+"[] = {")
+
+    lineSize = 40
+    for i in range(0, len(archive), lineSize):
+        headerfile.write("\n    ")
+        headerfile.write(",".join(str(b) for b in archive[i:i+lineSize]))
+        if i + lineSize < len(archive):
+            headerfile.write(",")
+
+    headerfile.write("\n")
+    headerfile.write("};")
+    headerfile.write("\n\n")
+    headerfile.write("#endif //SHADER_"+lang+"_h")
+    headerfile.write("\n")
+
+    headerfile.close()
+
 def create_c_header(engine_root):
     filesshaderlist =  {}
 
     for file in list(glob.glob(os.path.join("binshaders", '*.sbs'))):
         shadername = os.path.splitext(os.path.basename(file))[0]
 
-        shadersplit = shadername.split('_')
-        lang = shadersplit[len(shadersplit)-1]
-
-        filesshaderlist.setdefault(lang,[]).append(file)
+        shader, lang = shadername.rsplit('_', 1)
 
+        sbsfile = open(file, "rb")
+        filesshaderlist.setdefault(lang,{})[shader] = sbsfile.read()
+        sbsfile.close()
 
     for lang in filesshaderlist:
-        shaderslist = []
-
-        headerpath = os.path.join(get_header_output(engine_root), lang+".h")
-
-        print("Creating:", headerpath);
-
-        headerfile = open(headerpath, "w")
-        headerfile.write("#ifndef SHADER_"+lang+"_h")
-        headerfile.write("\n")
-        headerfile.write("#define SHADER_"+lang+"_h")
-        headerfile.write("\n\n")
-        headerfile.write("#include <string>")
-        headerfile.write("\n\n")
-
-        filesshaderlist[lang].sort()
-
-        for file in filesshaderlist[lang]:
-            sbsfile = open(file, "rb")
-            encodedShader = base64.b64encode(sbsfile.read()).decode("utf-8")
-
-            shadername = os.path.splitext(os.path.basename(file))[0]
-            shaderslist.append(shadername)
-
-            stringSize = 100
-            encodedShaderChunks = [encodedShader[i:i+stringSize] for i in range(0, len(encodedShader), stringSize)]
-
-            headerfile.write("static const std::string ")
-            headerfile.write(shadername)
-            headerfile.write(" = ")
-            for encodedShaderChunk in encodedShaderChunks:
-                headerfile.write("\n")
-                headerfile.write("    \"" + encodedShaderChunk + "\"")
-            headerfile.write(";")
-            headerfile.write("\n")
-
-
-        headerfile.write("\n")
-        first = True
-        headerfile.write("std::string getBase64Shader(std::string name) {")
-        for shadername in shaderslist:
-            headerfile.write("\n")
-            if first:
-                headerfile.write("    if (name == \"" + shadername + "\") {")
-            else:
-                headerfile.write("    } else if (name == \"" + shadername + "\") {")
-            headerfile.write("\n")
-            headerfile.write("        return "+shadername+";")
-            first = False
-
-        if not first:
-            headerfile.write("\n")
-            headerfile.write("    }")
-
-        headerfile.write("\n")
-        headerfile.write("    return \"\";")
-        headerfile.write("\n")
-        headerfile.write("}")
-        headerfile.write("\n")
-        headerfile.write("\n")
-
-        headerfile.write("#endif //SHADER_"+lang+"_h")
-        headerfile.write("\n")
-
-        headerfile.close()
+        write_archive_header(engine_root, lang, filesshaderlist[lang])
 
 @click.command()
 @click.option('--shaders', '-s', default=get_default_shaders(), help="Target shader type, seperated by ';'")
@@ -0,0 +1,133 @@
+#!/usr/bin/env python
+
+# /*
+# (c) 2024 Eduardo Doria.
+# */
+
+# Converts project images to KTX2 files with GPU compressed formats and full mipmap chains.
+# Uses "ktx" tool of KTX-Software (https://github.com/KhronosGroup/KTX-Software): images are
+# encoded to Basis Universal (UASTC) and then transcoded offline to target format, so engine
+# only loads ready blocks. Pillow is optional and used to read JPEG files and detect alpha.
+
+import os
+import sys
+import subprocess
+import tempfile
+import click
+
+# target name: (argument of "ktx transcode", has alpha)
+TARGETS = {
+    'bc1': ('bc1', True),
+    'bc3': ('bc3', True),
+    'bc4': ('bc4', False),
+    'bc5': ('bc5', False),
+    'bc7': ('bc7', True),
+    'etc2-rgb': ('etc-rgb', False),
+    'etc2-rgba': ('etc-rgba', True),
+    'eac-r11': ('eac-r11', False),
+    'eac-rg11': ('eac-rg11', False),
+    'astc': ('astc', True),
+    'rgba8': (None, True)
+}
+
+IMAGE_EXTENSIONS = ('.png', '.jpg', '.jpeg')
+
+def get_image_alpha(path):
+    try:
+        from PIL import Image
+    except ImportError:
+        return None
+
+    image = Image.open(path)
+    if image.mode not in ('RGBA', 'LA', 'PA') and not (image.mode == 'P' and 'transparency' in image.info):
+        return False
+
+    alpha = image.convert('RGBA').getchannel('A')
+    return alpha.getextrema()[0] < 255
+
+def get_png_input(path, tmpdir):
+    if path.lower().endswith('.png'):
+        return path
+
+    try:
+        from PIL import Image
+    except ImportError:
+        sys.exit('Pillow is needed to convert ' + path)
+
+    pngpath = os.path.join(tmpdir, os.path.splitext(os.path.basename(path))[0] + '.png')
+    Image.open(path).convert('RGBA').save(pngpath)
+    return pngpath
+
+def run(command, verbose):
+    if verbose:
+        print(' '.join(command))
+    result = subprocess.run(command, capture_output=True)
+
+    sys.stdout.buffer.write(result.stdout)
+    sys.stderr.buffer.write(result.stderr)
+    if result.returncode != 0:
+        sys.exit(result.returncode)
+
+def convert(ktx, input, output, target, linear, mipmaps, verbose):
+    transcodeTarget, targetAlpha = TARGETS[target]
+
+    with tempfile.TemporaryDirectory() as tmpdir:
+        pnginput = get_png_input(input, tmpdir)
+
+        format = 'R8G8B8A8_UNORM' if linear else 'R8G8B8A8_SRGB'
+        command = [ktx, 'create', '--format', format]
+        if mipmaps:
+            command += ['--generate-mipmap']
+
+        # engine considers texture opaque with this metadata
+        alpha = get_image_alpha(input)
+        if alpha is False or not targetAlpha:
+            command += ['--swizzle', 'rgb1']
+
+        if transcodeTarget is None:
+            run(command + [pnginput, output], verbose)
+            return
+
+        uastc = os.path.join(tmpdir, 'uastc.ktx2')
+        run(command + ['--encode', 'uastc', pnginput, uastc], verbose)
+        run([ktx, 'transcode', '--target', transcodeTarget, uastc, output], verbose)
+
+def get_images(input):
+    if os.path.isfile(input):
+        return [(input, os.path.basename(input))]
+
+    images = []
+    for root, dirs, files in os.walk(input):
+        for file in files:
+            if file.lower().endswith(IMAGE_EXTENSIONS):
+                path = os.path.join(root, file)
+                images.append((path, os.path.relpath(path, input)))
+    images.sort()
+    return images
+
+@click.command()
+@click.option('--input', '-i', required=True, type=click.Path(exists=True), help="Image file or assets directory")
+@click.option('--output', '-o', required=True, type=click.Path(), help="Output directory")
+@click.option('--target', '-t', default='bc7', type=click.Choice(list(TARGETS.keys())), help="Compressed format, use one supported by target devices (ex: bc7 for desktop, astc or etc2-rgba for mobile)")
+@click.option('--linear/--srgb', default=False, help="Color data is linear (ex: normal maps)")
+@click.option('--mipmaps/--no-mipmaps', default=True, help="Generate full mipmap chain")
+@click.option('--ktx', default='ktx', help="Path of ktx executable (KTX-Software 4.3 or newer)")
+@click.option('--verbose/--no-verbose', '-v', default=False, help="Output more information")
+def generate(input, output, target, linear, mipmaps, ktx, verbose):
+
+    images = get_images(input)
+    if not images:
+        sys.exit('No images found in: ' + input)
+
+    for path, relpath in images:
+        outpath = os.path.join(output, os.path.splitext(relpath)[0] + '.ktx2')
+        outdir = os.path.dirname(outpath)
+        if outdir and not os.path.exists(outdir):
+            os.makedirs(outdir)
+
+        print('Converting', relpath, 'to', target)
+        convert(ktx, path, outpath, target, linear, mipmaps, verbose)
+
+
+if __name__ == '__main__':
+    generate()